@@ -0,0 +1,100 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/stat.h>
+#include "commands/Dispatch.h"
+#include "utils/FileIO.h"
+#include "utils/DirIndex.h"
+
+// =============================================
+// BENCH
+// Utilidades comunes de los benchmarks: ejecutan los comandos con el
+// mismo processCommand del servidor (sin HTTP) y miden con steady_clock.
+// Las imágenes van en BENCH_DIR (por defecto /tmp/extreamfs-bench).
+// =============================================
+class BenchTimer {
+public:
+    BenchTimer() : t0(std::chrono::steady_clock::now()) {}
+
+    double ms() const {
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - t0).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point t0;
+};
+
+inline std::string benchDir() {
+    const char* env = std::getenv("BENCH_DIR");
+    std::string dir = (env && *env) ? env : "/tmp/extreamfs-bench";
+    mkdirRecursive(dir);
+    return dir;
+}
+
+// Ejecuta un comando y retorna su salida tal cual
+inline std::string runCommand(const std::string& line) {
+    static SessionContext ctx;
+    return processCommand(line, ctx);
+}
+
+// Ejecuta un comando; si falla se aborta el benchmark
+inline std::string run(const std::string& line) {
+    std::string out = runCommand(line);
+    if(out.rfind("OK", 0) != 0 && out.rfind("Particiones", 0) != 0) {
+        std::fprintf(stderr, "falló: %s\n  -> %s\n", line.c_str(), out.c_str());
+        std::exit(1);
+    }
+    return out;
+}
+
+// ID que asignó mount ("... montada con ID: 111A")
+inline std::string mountedId(const std::string& out) {
+    size_t pos = out.find("ID: ");
+    return (pos == std::string::npos) ? "" : out.substr(pos + 4, out.find_first_of(" \n", pos + 4) - pos - 4);
+}
+
+// Disco nuevo de 'diskMb' MB con una partición primaria de 'partMb' MB
+// montada y formateada con 'mkfsArgs' (p.ej. "-bs=4096"). Retorna el ID.
+inline std::string makePartition(const std::string& path, int diskMb, int partMb,
+                                 const std::string& mkfsArgs) {
+    run("mkdisk -size=" + std::to_string(diskMb) + " -unit=M -mode=sparse -path=" + path);
+    run("fdisk -size=" + std::to_string(partMb) + " -unit=M -name=P1 -path=" + path);
+    std::string id = mountedId(run("mount -name=P1 -path=" + path));
+    run("mkfs -type=fast -id=" + id + " " + mkfsArgs);
+    return id;
+}
+
+// Partición montada con ese ID (aborta si no existe)
+inline MountedPartition mountedPartition(const std::string& id) {
+    MountedPartition mp;
+    if(!MountedPartitions::findById(id, mp)) {
+        std::fprintf(stderr, "no existe la partición %s\n", id.c_str());
+        std::exit(1);
+    }
+    return mp;
+}
+
+// Inodo archivo vacío (dueño root). Requiere el candado exclusivo.
+inline int newFileInode(PartitionView& fs, BitmapAllocator& alloc) {
+    int n = alloc.allocInode();
+    if(n < 0) return -1;
+    Inode inode;
+    inode.i_uid  = 1;
+    inode.i_gid  = 1;
+    inode.i_type = '1';
+    fs.inodeMut(n) = inode;
+    return n;
+}
+
+// Bytes que ocupa de verdad un archivo (los huecos no cuentan)
+inline long long allocatedBytes(const std::string& path) {
+    struct stat st;
+    return (stat(path.c_str(), &st) == 0) ? (long long)st.st_blocks * 512 : -1;
+}
+
+#endif // BENCH_H
@@ -0,0 +1,121 @@
+// Escritura y lectura secuencial con FileIO para cada tamaño de bloque
+// (64, 512, 1024 y 4096): un archivo chico (256 KB, entra con bloques
+// de 64) y uno grande (por defecto 64 MB, no entra con bloques de 64).
+// Reporta el mejor de 'reps', los bloques de apuntadores del archivo y
+// en cuántas rachas contiguas quedó. Al final fsck debe ver cada
+// partición consistente.
+// Uso: blocksize_bench [MB=64] [reps=3]
+#include <vector>
+#include "Bench.h"
+
+struct Result {
+    double    writeMs  = 1e18;
+    double    readMs   = 1e18;
+    long long pointers = 0;
+    long long runs     = 0;
+};
+
+// Escribe, lee y libera el archivo 'reps' veces; la última vez lo deja
+// enlazado en la raíz para que fsck lo recorra
+static bool measure(const MountedPartition& mp, Disk& disk, const std::string& data,
+                    int reps, const std::string& name, Result& r) {
+    for(int rep = 0; rep < reps; rep++) {
+        int ino;
+        BenchTimer tw;
+        {
+            auto lock = DiskLocks::exclusive(mp.path);
+            PartitionView fs(disk, mp.start, mp.size);
+            fs.load();
+            if((long long)data.size() > FileIO::maxSize(fs)) return false;
+            BitmapAllocator alloc(fs, mp.path, mp.start);
+            std::string error;
+            ino = newFileInode(fs, alloc);
+            if(ino < 0 || !FileIO::write(fs, alloc, ino, data, error)) {
+                std::fprintf(stderr, "%s: %s\n", name.c_str(), error.c_str());
+                std::exit(1);
+            }
+            r.pointers = FileIO::pointersNeeded(fs, ((long long)data.size() + fs.blockSize() - 1) / fs.blockSize());
+        }
+        disk.sync();
+        r.writeMs = std::min(r.writeMs, tw.ms());
+
+        {
+            auto lock = DiskLocks::shared(mp.path);
+            PartitionView fs(disk, mp.start, mp.size);
+            fs.load();
+            Inode inode = fs.inode(ino);
+            std::string out;
+            BenchTimer tr;
+            if(!FileIO::read(fs, inode, out) || out != data) {
+                std::fprintf(stderr, "%s: el contenido leído no coincide\n", name.c_str());
+                std::exit(1);
+            }
+            r.readMs = std::min(r.readMs, tr.ms());
+            int prev = -2;
+            r.runs = 0;
+            InodeBlocks::forEach(fs, inode, [&](long long, int b) {
+                if(b != prev + 1) r.runs++;
+                prev = b;
+                return true;
+            });
+        }
+
+        auto lock = DiskLocks::exclusive(mp.path);
+        PartitionView fs(disk, mp.start, mp.size);
+        fs.load();
+        BitmapAllocator alloc(fs, mp.path, mp.start);
+        std::string error;
+        if(rep < reps - 1) {
+            FileIO::release(fs, alloc, fs.inodeMut(ino));
+            alloc.freeInode(ino);
+        } else if(!DirIndex::add(fs, alloc, 0, name, ino, error)) {
+            std::fprintf(stderr, "%s: %s\n", name.c_str(), error.c_str());
+            std::exit(1);
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int mb   = (argc > 1) ? std::atoi(argv[1]) : 64;
+    int reps = (argc > 2) ? std::atoi(argv[2]) : 3;
+
+    std::vector<std::pair<std::string, std::string>> files = {
+        {"chico", std::string(256 << 10, '\0')},
+        {"grande", std::string((size_t)mb << 20, '\0')},
+    };
+    for(auto& f : files)
+        for(size_t i = 0; i < f.second.size(); i++) f.second[i] = (char)('a' + i % 26);
+
+    std::printf("%-6s %-8s %10s %9s %10s %9s %10s %7s\n",
+                "bs", "archivo", "escritura", "MB/s", "lectura", "MB/s", "apunt.", "rachas");
+    for(int bs : {64, 512, 1024, 4096}) {
+        std::string path = benchDir() + "/blocksize_" + std::to_string(bs) + ".mia";
+        std::remove(path.c_str());
+        int partMb = 2 * mb + 16;
+        std::string id = makePartition(path, partMb + 1, partMb, "-bs=" + std::to_string(bs));
+        MountedPartition mp = mountedPartition(id);
+        std::shared_ptr<Disk> disk = DiskManager::get(mp.path);
+
+        for(const auto& f : files) {
+            Result r;
+            double size = f.second.size() / 1048576.0;
+            if(!measure(mp, *disk, f.second, reps, f.first, r)) {
+                std::printf("%-6d %-8s %s\n", bs, f.first.c_str(), "(excede el máximo de un archivo)");
+                continue;
+            }
+            std::printf("%-6d %-8s %8.1fms %9.0f %8.1fms %9.0f %10lld %7lld\n",
+                        bs, f.first.c_str(), r.writeMs, size / (r.writeMs / 1000),
+                        r.readMs, size / (r.readMs / 1000), r.pointers, r.runs);
+        }
+
+        std::string fsck = runCommand("fsck -id=" + id);
+        if(fsck.rfind("OK: Sistema de archivos consistente", 0) != 0) {
+            std::fprintf(stderr, "%s\n", fsck.c_str());
+            return 1;
+        }
+        runCommand("unmount -id=" + id);
+        DiskManager::drop(mp.path, false);
+    }
+    return 0;
+}
@@ -0,0 +1,127 @@
+// N archivos (por defecto 100k) en la raíz de una partición con bloques
+// de 512: con DirIndex::add/find (la carpeta se indexa sola al pasar de
+// DIRINDEX_MIN_BLOCKS) y sin índice (agregar en la primera casilla
+// libre recorriendo la carpeta, sin revisar repetidos; buscar con
+// DirIndex::find, que sin índice recorre la carpeta). Cada fase usa una
+// sola vista y las búsquedas van en otro orden que las altas (sin
+// índice solo 2000, cada una recorre media carpeta). Al final fsck debe
+// ver las dos particiones consistentes.
+// Uso: dirindex_bench [archivos=100000]
+#include <vector>
+#include <cstring>
+#include "Bench.h"
+
+// -----------------------------------------------
+// Alta sin índice
+// -----------------------------------------------
+namespace linear {
+
+bool add(PartitionView& fs, BitmapAllocator& alloc, int dir, const std::string& name, int child) {
+    Inode inode = fs.inode(dir);
+    long long last = -1;
+    int freeBlock = -1, freeSlot = -1;
+    InodeBlocks::forEach(fs, inode, [&](long long logical, int blockNo) {
+        last = logical;
+        const Content* entries = fs.folder(blockNo);
+        for(int k = 0; k < fs.folderEntries(); k++) {
+            if(entries[k].b_inodo != -1) continue;
+            freeBlock = blockNo;
+            freeSlot  = k;
+            return false;
+        }
+        return true;
+    });
+    if(freeBlock < 0) {
+        freeBlock = alloc.allocBlock();
+        if(freeBlock < 0) return false;
+        fs.clearFolder(freeBlock);
+        if(!FileIO::attach(fs, alloc, dir, last + 1, freeBlock)) return false;
+        freeSlot = 0;
+    }
+    Content& c = fs.folderMut(freeBlock)[freeSlot];
+    c = Content();
+    std::memcpy(c.b_name, name.data(), name.size());
+    c.b_inodo = child;
+    return true;
+}
+
+} // namespace linear
+
+// Búsquedas que se miden sin índice
+#define LINEAR_LOOKUPS 2000
+
+struct Result {
+    double addMs   = 0;
+    double findMs  = 0;
+    int    lookups = 0;
+    int    blocks  = 0;
+};
+
+static std::string fileName(int i) { return "f" + std::to_string(i); }
+
+static Result runFolder(const std::string& id, int files, bool indexed) {
+    MountedPartition mp = mountedPartition(id);
+    std::shared_ptr<Disk> disk = DiskManager::get(mp.path);
+    Result r;
+    {
+        auto lock = DiskLocks::exclusive(mp.path);
+        PartitionView fs(*disk, mp.start, mp.size);
+        fs.load();
+        BitmapAllocator alloc(fs, mp.path, mp.start);
+        std::string error;
+        BenchTimer t;
+        for(int i = 0; i < files; i++) {
+            int ino = newFileInode(fs, alloc);
+            bool ok = (ino >= 0) && (indexed ? DirIndex::add(fs, alloc, 0, fileName(i), ino, error)
+                                             : linear::add(fs, alloc, 0, fileName(i), ino));
+            if(!ok) {
+                std::fprintf(stderr, "alta %d: %s\n", i, error.c_str());
+                std::exit(1);
+            }
+        }
+        r.addMs = t.ms();
+        InodeBlocks::forEach(fs, fs.inode(0), [&](long long, int) { r.blocks++; return true; });
+    }
+    {
+        auto lock = DiskLocks::shared(mp.path);
+        PartitionView fs(*disk, mp.start, mp.size);
+        fs.load();
+        r.lookups = indexed ? files : std::min(files, LINEAR_LOOKUPS);
+        BenchTimer t;
+        for(int i = 0; i < r.lookups; i++) {
+            int name = (int)((i * 7919LL) % files);
+            if(DirIndex::find(fs, 0, fileName(name)) < 0) {
+                std::fprintf(stderr, "no se encontró %s\n", fileName(name).c_str());
+                std::exit(1);
+            }
+        }
+        r.findMs = t.ms();
+    }
+    disk->sync();
+    std::string fsck = runCommand("fsck -id=" + id);
+    if(fsck.rfind("OK: Sistema de archivos consistente", 0) != 0) {
+        std::fprintf(stderr, "%s\n", fsck.c_str());
+        std::exit(1);
+    }
+    return r;
+}
+
+int main(int argc, char** argv) {
+    int files = (argc > 1) ? std::atoi(argv[1]) : 100000;
+    // Un inodo por archivo (-ratio=1) y lugar para la carpeta y el índice
+    int partMb = std::max(8, (int)((long long)files * 640 / (1 << 20)) + 8);
+
+    std::printf("%d archivos en una carpeta (bloques de 512)\n", files);
+    for(bool indexed : {true, false}) {
+        std::string path = benchDir() + (indexed ? "/dirindex.mia" : "/dirlinear.mia");
+        std::remove(path.c_str());
+        std::string id = makePartition(path, partMb + 1, partMb, "-bs=512 -ratio=1");
+        Result r = runFolder(id, files, indexed);
+        std::printf("%-11s alta %9.1f ms (%6.2f us/archivo) | %6d búsquedas %9.1f ms (%6.2f us c/u) | %d bloques\n",
+                    indexed ? "con índice:" : "sin índice:", r.addMs, r.addMs * 1000 / files, r.lookups,
+                    r.findMs, r.findMs * 1000 / r.lookups, r.blocks);
+        runCommand("unmount -id=" + id);
+        DiskManager::drop(canonicalPath(path), false);
+    }
+    return 0;
+}
@@ -0,0 +1,45 @@
+// Segundos por GB de mkdisk en cada modo (zero, sparse, prealloc).
+// Uso: mkdisk_bench [MB=1024] [repeticiones=3]
+#include <vector>
+#include <fstream>
+#include "Bench.h"
+
+int main(int argc, char** argv) {
+    int mb   = (argc > 1) ? std::atoi(argv[1]) : 1024;
+    int reps = (argc > 2) ? std::atoi(argv[2]) : 3;
+    std::string path = benchDir() + "/mkdisk.mia";
+    double gb = mb / 1024.0;
+
+    std::printf("mkdisk de %d MB, mejor de %d\n", mb, reps);
+    std::printf("%-9s %10s %10s %14s\n", "modo", "ms", "s/GB", "ocupado (MB)");
+
+    std::vector<std::string> heads;
+    for(const char* mode : {"zero", "sparse", "prealloc"}) {
+        double best = 1e18;
+        for(int r = 0; r < reps; r++) {
+            std::remove(path.c_str());
+            BenchTimer t;
+            run("mkdisk -size=" + std::to_string(mb) + " -unit=M -mode=" + mode + " -path=" + path);
+            best = std::min(best, t.ms());
+        }
+        std::printf("%-9s %10.2f %10.4f %14.1f\n", mode, best, best / 1000.0 / gb,
+                    allocatedBytes(path) / (1024.0 * 1024.0));
+
+        // El MBR debe quedar en el mismo lugar: se comparan sus bytes sin
+        // la fecha ni la firma, que cambian en cada disco
+        std::ifstream in(path, std::ios::binary);
+        std::string head(sizeof(MBR), '\0');
+        in.read(&head[0], head.size());
+        MBR mbr;
+        diskDecode(head.data(), mbr);
+        mbr.mbr_fecha_creacion = 0;
+        mbr.mbr_dsk_signature  = 0;
+        char raw[sizeof(MBR)];
+        diskEncode(mbr, raw);
+        heads.emplace_back(raw, sizeof(raw));
+    }
+    bool same = heads[0] == heads[1] && heads[1] == heads[2];
+    std::printf("MBR idéntico en los tres modos: %s\n", same ? "sí" : "NO");
+    run("rmdisk -path=" + path);
+    return same ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+// Analiza N líneas de script (por defecto un millón) con el parser de
+// CommandParser.h y con el anterior (trim/toLower/parseParams sobre
+// std::string y comparación en cadena de if), copiado aquí tal cual
+// estaba para comparar.
+// Uso: parser_bench [lineas=1000000]
+#include <vector>
+#include <sstream>
+#include "Bench.h"
+
+// -----------------------------------------------
+// Parser anterior
+// -----------------------------------------------
+namespace legacy {
+
+std::vector<std::pair<std::string, std::string>> parseParams(const std::string& line) {
+    std::vector<std::pair<std::string, std::string>> params;
+    std::string current = line;
+    size_t i = 0;
+    while(i < current.size()) {
+        while(i < current.size() && current[i] == ' ') i++;
+        if(i >= current.size()) break;
+        if(current[i] == '-') {
+            i++;
+            std::string key, val;
+            while(i < current.size() && current[i] != '=' && current[i] != ' ') key += current[i++];
+            if(i < current.size() && current[i] == '=') {
+                i++;
+                if(i < current.size() && current[i] == '"') {
+                    i++;
+                    while(i < current.size() && current[i] != '"') val += current[i++];
+                    if(i < current.size()) i++;
+                } else {
+                    while(i < current.size() && current[i] != ' ') val += current[i++];
+                }
+            }
+            params.push_back({toLower(key), val});
+        } else {
+            i++;
+        }
+    }
+    return params;
+}
+
+// Lo que hacía cada execute(): toLower de la clave y comparación con literales
+long long consume(const std::vector<std::pair<std::string, std::string>>& params) {
+    long long sum = 0;
+    for(const auto& p : params) {
+        std::string key = toLower(p.first);
+        if(key == "size")      sum += std::stoi(p.second);
+        else if(key == "unit") sum += toLower(p.second)[0];
+        else if(key == "fit")  sum += toLower(p.second)[0];
+        else if(key == "path") sum += p.second.size();
+        else if(key == "name") sum += p.second.size();
+        else if(key == "id")   sum += p.second.size();
+    }
+    return sum;
+}
+
+long long processLine(const std::string& rawLine) {
+    std::string line = trim(rawLine);
+    if(line.empty() || line[0] == '#') return 0;
+    size_t spacePos = line.find(' ');
+    std::string cmd  = toLower((spacePos == std::string::npos) ? line : line.substr(0, spacePos));
+    std::string rest = (spacePos == std::string::npos) ? "" : line.substr(spacePos + 1);
+    auto params = parseParams(rest);
+    if(cmd == "mkdisk")  return 1 + consume(params);
+    if(cmd == "rmdisk")  return 2 + consume(params);
+    if(cmd == "fdisk")   return 3 + consume(params);
+    if(cmd == "mount")   return 4 + consume(params);
+    if(cmd == "mounted") return 5;
+    if(cmd == "mkfs")    return 6 + consume(params);
+    if(cmd == "login")   return 7 + consume(params);
+    if(cmd == "logout")  return 8;
+    return 0;
+}
+
+} // namespace legacy
+
+// -----------------------------------------------
+// Parser actual: vistas sobre el script y tabla de hash perfecto
+// -----------------------------------------------
+static long long consume(const CommandLine& cmd) {
+    long long sum = 0;
+    for(const Param& p : cmd) {
+        int  n = 0;
+        Unit unit;
+        Fit  fit;
+        if(p.is("size"))      { if(parseInt(p.value, n)) sum += n; }
+        else if(p.is("unit")) { if(parseEnum(p.value, UNIT_NAMES, unit)) sum += lowerAscii(p.value[0]); }
+        else if(p.is("fit"))  { if(parseEnum(p.value, FIT_NAMES, fit)) sum += lowerAscii(p.value[0]); }
+        else if(p.is("path")) sum += p.value.size();
+        else if(p.is("name")) sum += p.value.size();
+        else if(p.is("id"))   sum += p.value.size();
+    }
+    return sum;
+}
+
+static long long processLine(std::string_view rawLine) {
+    std::string_view line = trimView(rawLine);
+    if(line.empty() || line[0] == '#') return 0;
+    CommandLine cmd = CommandLine::parse(line);
+    switch(lookupCommand(cmd.name)) {
+        case CMD_MKDISK:  return 1 + consume(cmd);
+        case CMD_RMDISK:  return 2 + consume(cmd);
+        case CMD_FDISK:   return 3 + consume(cmd);
+        case CMD_MOUNT:   return 4 + consume(cmd);
+        case CMD_MOUNTED: return 5;
+        case CMD_MKFS:    return 6 + consume(cmd);
+        case CMD_LOGIN:   return 7 + consume(cmd);
+        case CMD_LOGOUT:  return 8;
+        default:          return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    long long lines = (argc > 1) ? std::atoll(argv[1]) : 1000000;
+
+    // Un script con la mezcla típica de comandos, en mayúsculas y minúsculas
+    const char* sample[] = {
+        "  MKDISK -Size=3000 -unit=K -fit=BF -path=\"/home/user/Discos/Disco 1.mia\"",
+        "fdisk -size=300 -path=/home/user/Discos/Disco1.mia -name=Particion1 -unit=K",
+        "mount -path=/home/user/Discos/Disco1.mia -name=Particion1",
+        "mkfs -id=111A -type=full",
+        "Login -user=root -pass=123 -id=111A",
+        "# comentario",
+        "logout",
+        "rmdisk -path=/home/user/Discos/Disco1.mia",
+    };
+    std::string script;
+    for(long long i = 0; i < lines; i++) {
+        script += sample[i % (sizeof(sample) / sizeof(sample[0]))];
+        script += '\n';
+    }
+
+    // Anterior: istringstream/getline como processScript
+    BenchTimer t0;
+    long long checkOld = 0;
+    {
+        std::istringstream ss(script);
+        std::string line;
+        while(std::getline(ss, line)) checkOld += legacy::processLine(line);
+    }
+    double msOld = t0.ms();
+
+    // Actual: vistas sobre el buffer del script
+    BenchTimer t1;
+    long long checkNew = 0;
+    std::string_view rest = script;
+    while(!rest.empty()) {
+        size_t nl = rest.find('\n');
+        checkNew += processLine(rest.substr(0, nl));
+        rest = (nl == std::string_view::npos) ? std::string_view() : rest.substr(nl + 1);
+    }
+    double msNew = t1.ms();
+
+    std::printf("%lld líneas\n", lines);
+    std::printf("  anterior: %8.1f ms (%6.1f ns/línea)\n", msOld, msOld * 1e6 / lines);
+    std::printf("  actual:   %8.1f ms (%6.1f ns/línea)  %.1fx\n", msNew, msNew * 1e6 / lines, msOld / msNew);
+    if(checkOld != checkNew) {
+        std::printf("los resultados no coinciden (%lld vs %lld)\n", checkOld, checkNew);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,18 @@
+#!/bin/sh
+# Compila y corre los benchmarks de backend/bench.
+#   ./run.sh                -> todos
+#   ./run.sh mkdisk parser  -> solo esos (nombre sin "_bench.cpp")
+# Los argumentos de cada uno se pueden pasar con, p.ej., MKDISK_ARGS="4096 1".
+# Las imágenes van en BENCH_DIR (por defecto /tmp/extreamfs-bench).
+set -e
+cd "$(dirname "$0")"
+BIN="${BENCH_DIR:-/tmp/extreamfs-bench}/bin"
+mkdir -p "$BIN"
+NAMES="$*"
+[ -z "$NAMES" ] && NAMES=$(ls *_bench.cpp | sed 's/_bench\.cpp$//')
+for name in $NAMES; do
+    echo "== $name"
+    g++ -std=c++17 -O2 -pthread -I../src -o "$BIN/${name}_bench" "${name}_bench.cpp"
+    ARGS=$(eval echo "\${$(echo "$name" | tr a-z A-Z)_ARGS:-}")
+    "$BIN/${name}_bench" $ARGS
+done
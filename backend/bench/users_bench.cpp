@@ -0,0 +1,144 @@
+// login contra un users.txt de U usuarios (por defecto 10k) escrito con
+// FileIO: N logins (por defecto 100k) con la tabla en UsersCache, y
+// algunos sin caché (leer + UsersTable::parse) y con la búsqueda
+// anterior (getline/splitCSV línea por línea), copiada aquí tal cual.
+// Uso: users_bench [usuarios=10000] [logins=100000]
+#include <vector>
+#include <sstream>
+#include "Bench.h"
+
+// -----------------------------------------------
+// Búsqueda anterior de login
+// -----------------------------------------------
+namespace legacy {
+
+std::vector<std::string> splitCSV(const std::string& line) {
+    std::vector<std::string> result;
+    std::stringstream ss(line);
+    std::string token;
+    while(std::getline(ss, token, ',')) result.push_back(token);
+    return result;
+}
+
+int getGID(const std::string& content, const std::string& groupName) {
+    std::istringstream ss(content);
+    std::string line;
+    while(std::getline(ss, line)) {
+        auto parts = splitCSV(line);
+        if(parts.size() >= 3 && trim(parts[1]) == "G" && trim(parts[2]) == groupName)
+            return std::stoi(trim(parts[0]));
+    }
+    return -1;
+}
+
+// UID del usuario o -1
+int login(const std::string& content, const std::string& user, const std::string& pass, int& gid) {
+    std::istringstream ss(content);
+    std::string line;
+    while(std::getline(ss, line)) {
+        if(line.empty()) continue;
+        std::vector<std::string> parts = splitCSV(line);
+        if(parts.size() < 5) continue;
+        if(trim(parts[1]) != "U") continue;
+        std::string statusStr = trim(parts[0]);
+        if(statusStr == "0") continue;
+        if(trim(parts[3]) == user && trim(parts[4]) == pass) {
+            gid = getGID(content, trim(parts[2]));
+            return std::stoi(statusStr);
+        }
+    }
+    return -1;
+}
+
+} // namespace legacy
+
+// -----------------------------------------------
+// users.txt
+// -----------------------------------------------
+static std::string usersContent(int users) {
+    std::string content = "1,G,root\n1,U,root,root,123\n";
+    for(int g = 0; g < 100; g++)
+        content += std::to_string(g + 2) + ",G,grupo" + std::to_string(g) + "\n";
+    for(int u = 0; u < users; u++)
+        content += std::to_string(u + 2) + ",U,grupo" + std::to_string(u % 100) +
+                   ",usuario" + std::to_string(u) + ",clave" + std::to_string(u) + "\n";
+    return content;
+}
+
+static std::string readUsers(const MountedPartition& mp, Disk& disk) {
+    auto lock = DiskLocks::shared(mp.path);
+    PartitionView fs(disk, mp.start, mp.size);
+    fs.load();
+    PathResolver resolver(fs, mp.path, mp.start);
+    std::string content;
+    FileIO::read(fs, fs.inode(resolver.resolve("/users.txt")), content);
+    return content;
+}
+
+int main(int argc, char** argv) {
+    int users  = (argc > 1) ? std::atoi(argv[1]) : 10000;
+    int logins = (argc > 2) ? std::atoi(argv[2]) : 100000;
+    int slow   = std::max(1, std::min(logins, 200));   // los lentos, menos veces
+
+    std::string path = benchDir() + "/users.mia";
+    std::remove(path.c_str());
+    std::string id = makePartition(path, 64, 60, "-bs=1024");
+    MountedPartition mp = mountedPartition(id);
+    std::shared_ptr<Disk> disk = DiskManager::get(mp.path);
+
+    std::string content = usersContent(users);
+    {
+        auto lock = DiskLocks::exclusive(mp.path);
+        PartitionView fs(*disk, mp.start, mp.size);
+        fs.load();
+        BitmapAllocator alloc(fs, mp.path, mp.start);
+        PathResolver resolver(fs, mp.path, mp.start);
+        std::string error;
+        if(!FileIO::write(fs, alloc, resolver.resolve("/users.txt"), content, error)) {
+            std::fprintf(stderr, "users.txt: %s\n", error.c_str());
+            return 1;
+        }
+    }
+    UsersCache::invalidate(mp.path);
+    std::printf("users.txt: %d usuarios, %zu KB\n", users, content.size() / 1024);
+
+    auto loginLine = [&](int i) {
+        int u = (int)((i * 7919LL) % users);
+        return "login -user=usuario" + std::to_string(u) + " -pass=clave" + std::to_string(u) + " -id=" + id;
+    };
+
+    // Con caché: solo el primer login lee users.txt
+    BenchTimer cached;
+    for(int i = 0; i < logins; i++) {
+        run(loginLine(i));
+        run("logout");
+    }
+    double cachedMs = cached.ms();
+
+    // Sin caché: cada login vuelve a leer e interpretar users.txt
+    BenchTimer uncached;
+    for(int i = 0; i < slow; i++) {
+        UsersCache::invalidate(mp.path);
+        run(loginLine(i));
+        run("logout");
+    }
+    double uncachedMs = uncached.ms();
+
+    // Anterior: leer users.txt y recorrerlo con getline/splitCSV
+    long long check = 0;
+    BenchTimer old;
+    for(int i = 0; i < slow; i++) {
+        int u = (int)((i * 7919LL) % users), gid = -1;
+        check += legacy::login(readUsers(mp, *disk), "usuario" + std::to_string(u),
+                               "clave" + std::to_string(u), gid) + gid;
+    }
+    double oldMs = old.ms();
+
+    std::printf("con caché:  %d logins en %.1f ms (%.2f us/login)\n", logins, cachedMs, cachedMs * 1000 / logins);
+    std::printf("sin caché:  %.3f ms/login (leer + UsersTable::parse)\n", uncachedMs / slow);
+    std::printf("anterior:   %.3f ms/login (leer + getline/splitCSV), checksum %lld\n", oldMs / slow, check);
+
+    runCommand("unmount -id=" + id);
+    DiskManager::drop(mp.path, false);
+    return 0;
+}
@@ -0,0 +1,779 @@
+#ifndef CONVERT_H
+#define CONVERT_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "../structs/Structs.h"
+#include "../utils/Utils.h"
+#include "../utils/CommandParser.h"
+#include "../utils/MountedPartitions.h"
+#include "../utils/DiskLocks.h"
+#include "../utils/DiskManager.h"
+#include "../utils/Bitmap.h"
+#include "../utils/PathResolver.h"
+#include "../utils/UsersTable.h"
+#include "../utils/EbrIndex.h"
+
+// Inodos que se convierten por lectura/escritura
+#define CONVERT_INODE_CHUNK 4096
+
+// -----------------------------------------------
+// Formato v1: los structs como los dejaba el compilador en x86-64
+// (relleno incluido, time_t de 8 bytes). El relleno se declara como
+// campos para que el formato quede explícito y verificado.
+// -----------------------------------------------
+struct V1Partition {
+    char    part_status;
+    char    part_type;
+    char    part_fit;
+    char    pad0[1];
+    int32_t part_start;
+    int32_t part_s;
+    char    part_name[16];
+    int32_t part_correlative;
+    char    part_id[4];
+};
+
+struct V1MBR {
+    int32_t     mbr_tamano;
+    char        pad0[4];
+    int64_t     mbr_fecha_creacion;
+    int32_t     mbr_dsk_signature;
+    char        dsk_fit;
+    char        pad1[3];
+    V1Partition mbr_partitions[4];
+};
+
+struct V1EBR {
+    char    part_mount;
+    char    part_fit;
+    char    pad0[2];
+    int32_t part_start;
+    int32_t part_s;
+    int32_t part_next;
+    char    part_name[16];
+};
+
+struct V1Inode {
+    int32_t i_uid;
+    int32_t i_gid;
+    int32_t i_s;
+    char    pad0[4];
+    int64_t i_atime;
+    int64_t i_ctime;
+    int64_t i_mtime;
+    int32_t i_block[15];
+    char    i_type;
+    char    i_perm[3];
+};
+
+struct V1SuperBloque {
+    int32_t s_filesystem_type;
+    int32_t s_inodes_count;
+    int32_t s_blocks_count;
+    int32_t s_free_blocks_count;
+    int32_t s_free_inodes_count;
+    char    pad0[4];
+    int64_t s_mtime;
+    int64_t s_umtime;
+    int32_t s_mnt_count;
+    int32_t s_magic;
+    int32_t s_inode_s;
+    int32_t s_block_s;
+    int32_t s_firts_ino;
+    int32_t s_first_blo;
+    int32_t s_bm_inode_start;
+    int32_t s_bm_block_start;
+    int32_t s_inode_start;
+    int32_t s_block_start;
+};
+
+template<> struct DiskLayout<V1Partition> {
+    static constexpr DiskField FIELDS[] = {
+        DISK_FIELD(V1Partition, part_status,       0),
+        DISK_FIELD(V1Partition, part_type,         1),
+        DISK_FIELD(V1Partition, part_fit,          2),
+        DISK_FIELD(V1Partition, pad0,              3),
+        DISK_FIELD(V1Partition, part_start,        4),
+        DISK_FIELD(V1Partition, part_s,            8),
+        DISK_FIELD(V1Partition, part_name,        12),
+        DISK_FIELD(V1Partition, part_correlative, 28),
+        DISK_FIELD(V1Partition, part_id,          32),
+    };
+};
+
+template<> struct DiskLayout<V1MBR> {
+    static constexpr DiskField FIELDS[] = {
+        DISK_FIELD(V1MBR, mbr_tamano,          0),
+        DISK_FIELD(V1MBR, pad0,                4),
+        DISK_FIELD(V1MBR, mbr_fecha_creacion,  8),
+        DISK_FIELD(V1MBR, mbr_dsk_signature,  16),
+        DISK_FIELD(V1MBR, dsk_fit,            20),
+        DISK_FIELD(V1MBR, pad1,               21),
+        DISK_FIELD(V1MBR, mbr_partitions,     24),
+    };
+};
+
+template<> struct DiskLayout<V1EBR> {
+    static constexpr DiskField FIELDS[] = {
+        DISK_FIELD(V1EBR, part_mount,  0),
+        DISK_FIELD(V1EBR, part_fit,    1),
+        DISK_FIELD(V1EBR, pad0,        2),
+        DISK_FIELD(V1EBR, part_start,  4),
+        DISK_FIELD(V1EBR, part_s,      8),
+        DISK_FIELD(V1EBR, part_next,  12),
+        DISK_FIELD(V1EBR, part_name,  16),
+    };
+};
+
+template<> struct DiskLayout<V1Inode> {
+    static constexpr DiskField FIELDS[] = {
+        DISK_FIELD(V1Inode, i_uid,     0),
+        DISK_FIELD(V1Inode, i_gid,     4),
+        DISK_FIELD(V1Inode, i_s,       8),
+        DISK_FIELD(V1Inode, pad0,     12),
+        DISK_FIELD(V1Inode, i_atime,  16),
+        DISK_FIELD(V1Inode, i_ctime,  24),
+        DISK_FIELD(V1Inode, i_mtime,  32),
+        DISK_FIELD(V1Inode, i_block,  40),
+        DISK_FIELD(V1Inode, i_type,  100),
+        DISK_FIELD(V1Inode, i_perm,  101),
+    };
+};
+
+template<> struct DiskLayout<V1SuperBloque> {
+    static constexpr DiskField FIELDS[] = {
+        DISK_FIELD(V1SuperBloque, s_filesystem_type,    0),
+        DISK_FIELD(V1SuperBloque, s_inodes_count,       4),
+        DISK_FIELD(V1SuperBloque, s_blocks_count,       8),
+        DISK_FIELD(V1SuperBloque, s_free_blocks_count, 12),
+        DISK_FIELD(V1SuperBloque, s_free_inodes_count, 16),
+        DISK_FIELD(V1SuperBloque, pad0,                20),
+        DISK_FIELD(V1SuperBloque, s_mtime,             24),
+        DISK_FIELD(V1SuperBloque, s_umtime,            32),
+        DISK_FIELD(V1SuperBloque, s_mnt_count,         40),
+        DISK_FIELD(V1SuperBloque, s_magic,             44),
+        DISK_FIELD(V1SuperBloque, s_inode_s,           48),
+        DISK_FIELD(V1SuperBloque, s_block_s,           52),
+        DISK_FIELD(V1SuperBloque, s_firts_ino,         56),
+        DISK_FIELD(V1SuperBloque, s_first_blo,         60),
+        DISK_FIELD(V1SuperBloque, s_bm_inode_start,    64),
+        DISK_FIELD(V1SuperBloque, s_bm_block_start,    68),
+        DISK_FIELD(V1SuperBloque, s_inode_start,       72),
+        DISK_FIELD(V1SuperBloque, s_block_start,       76),
+    };
+};
+
+
+static_assert(diskLayoutMatches<V1Partition>(36),   "V1Partition no coincide con el formato v1");
+static_assert(diskLayoutMatches<V1MBR>(168),        "V1MBR no coincide con el formato v1");
+static_assert(diskLayoutMatches<V1EBR>(32),         "V1EBR no coincide con el formato v1");
+static_assert(diskLayoutMatches<V1Inode>(104),      "V1Inode no coincide con el formato v1");
+static_assert(diskLayoutMatches<V1SuperBloque>(80), "V1SuperBloque no coincide con el formato v1");
+
+// -----------------------------------------------
+// Formato v2: como el actual pero con posiciones y tamaños de 32 bits.
+// Los inodos y los bloques no cambiaron.
+// -----------------------------------------------
+#pragma pack(push, 1)
+
+struct V2Partition {
+    char    part_status;
+    char    part_type;
+    char    part_fit;
+    int32_t part_start;
+    int32_t part_s;
+    char    part_name[16];
+    int32_t part_correlative;
+    char    part_id[4];
+};
+
+struct V2MBR {
+    char        mbr_magic[3];
+    uint8_t     mbr_version;
+    int32_t     mbr_tamano;
+    DiskTime    mbr_fecha_creacion;
+    int32_t     mbr_dsk_signature;
+    char        dsk_fit;
+    V2Partition mbr_partitions[4];
+};
+
+struct V2EBR {
+    char    part_mount;
+    char    part_fit;
+    int32_t part_start;
+    int32_t part_s;
+    int32_t part_next;
+    char    part_name[16];
+};
+
+#pragma pack(pop)
+
+struct V2SuperBloque {
+    int32_t  s_filesystem_type;
+    int32_t  s_inodes_count;
+    int32_t  s_blocks_count;
+    int32_t  s_free_blocks_count;
+    int32_t  s_free_inodes_count;
+    DiskTime s_mtime;
+    DiskTime s_umtime;
+    int32_t  s_mnt_count;
+    int32_t  s_magic;
+    int32_t  s_version;
+    int32_t  s_inode_s;
+    int32_t  s_block_s;
+    int32_t  s_firts_ino;
+    int32_t  s_first_blo;
+    int32_t  s_bm_inode_start;
+    int32_t  s_bm_block_start;
+    int32_t  s_inode_start;
+    int32_t  s_block_start;
+};
+
+template<> struct DiskLayout<V2Partition> {
+    static constexpr DiskField FIELDS[] = {
+        DISK_FIELD(V2Partition, part_status,       0),
+        DISK_FIELD(V2Partition, part_type,         1),
+        DISK_FIELD(V2Partition, part_fit,          2),
+        DISK_FIELD(V2Partition, part_start,        3),
+        DISK_FIELD(V2Partition, part_s,            7),
+        DISK_FIELD(V2Partition, part_name,        11),
+        DISK_FIELD(V2Partition, part_correlative, 27),
+        DISK_FIELD(V2Partition, part_id,          31),
+    };
+};
+
+template<> struct DiskLayout<V2MBR> {
+    static constexpr DiskField FIELDS[] = {
+        DISK_FIELD(V2MBR, mbr_magic,           0),
+        DISK_FIELD(V2MBR, mbr_version,         3),
+        DISK_FIELD(V2MBR, mbr_tamano,          4),
+        DISK_FIELD(V2MBR, mbr_fecha_creacion,  8),
+        DISK_FIELD(V2MBR, mbr_dsk_signature,  16),
+        DISK_FIELD(V2MBR, dsk_fit,            20),
+        DISK_FIELD(V2MBR, mbr_partitions,     21),
+    };
+};
+
+template<> struct DiskLayout<V2EBR> {
+    static constexpr DiskField FIELDS[] = {
+        DISK_FIELD(V2EBR, part_mount,  0),
+        DISK_FIELD(V2EBR, part_fit,    1),
+        DISK_FIELD(V2EBR, part_start,  2),
+        DISK_FIELD(V2EBR, part_s,      6),
+        DISK_FIELD(V2EBR, part_next,  10),
+        DISK_FIELD(V2EBR, part_name,  14),
+    };
+};
+
+template<> struct DiskLayout<V2SuperBloque> {
+    static constexpr DiskField FIELDS[] = {
+        DISK_FIELD(V2SuperBloque, s_filesystem_type,    0),
+        DISK_FIELD(V2SuperBloque, s_inodes_count,       4),
+        DISK_FIELD(V2SuperBloque, s_blocks_count,       8),
+        DISK_FIELD(V2SuperBloque, s_free_blocks_count, 12),
+        DISK_FIELD(V2SuperBloque, s_free_inodes_count, 16),
+        DISK_FIELD(V2SuperBloque, s_mtime,             20),
+        DISK_FIELD(V2SuperBloque, s_umtime,            28),
+        DISK_FIELD(V2SuperBloque, s_mnt_count,         36),
+        DISK_FIELD(V2SuperBloque, s_magic,             40),
+        DISK_FIELD(V2SuperBloque, s_version,           44),
+        DISK_FIELD(V2SuperBloque, s_inode_s,           48),
+        DISK_FIELD(V2SuperBloque, s_block_s,           52),
+        DISK_FIELD(V2SuperBloque, s_firts_ino,         56),
+        DISK_FIELD(V2SuperBloque, s_first_blo,         60),
+        DISK_FIELD(V2SuperBloque, s_bm_inode_start,    64),
+        DISK_FIELD(V2SuperBloque, s_bm_block_start,    68),
+        DISK_FIELD(V2SuperBloque, s_inode_start,       72),
+        DISK_FIELD(V2SuperBloque, s_block_start,       76),
+    };
+};
+
+static_assert(diskLayoutMatches<V2Partition>(35),   "V2Partition no coincide con el formato v2");
+static_assert(diskLayoutMatches<V2MBR>(161),        "V2MBR no coincide con el formato v2");
+static_assert(diskLayoutMatches<V2EBR>(30),         "V2EBR no coincide con el formato v2");
+static_assert(diskLayoutMatches<V2SuperBloque>(80), "V2SuperBloque no coincide con el formato v2");
+
+// -----------------------------------------------
+// Structs de cada versión de origen. Los campos se llaman igual en
+// todas, así la conversión se escribe una sola vez.
+// -----------------------------------------------
+struct FormatV1 {
+    static constexpr int version = 1;
+    using MBR   = V1MBR;
+    using EBR   = V1EBR;
+    using SB    = V1SuperBloque;
+    using Inode = V1Inode;
+    static bool hasFs(const SB& sb) { return sb.s_magic == 0xEF53 && sb.s_inode_s == (int)sizeof(Inode); }
+};
+
+struct FormatV2 {
+    static constexpr int version = 2;
+    using MBR   = V2MBR;
+    using EBR   = V2EBR;
+    using SB    = V2SuperBloque;
+    using Inode = ::Inode;
+    static bool hasFs(const SB& sb) {
+        return sb.s_magic == 0xEF53 && sb.s_version == version && sb.s_inode_s == (int)sizeof(Inode);
+    }
+};
+
+// =============================================
+// CONVERT - Pasa un disco del formato v1 o v2 al actual
+// convert -path=/a.mia
+//
+// Arma el disco nuevo en una copia (que conserva los huecos del
+// archivo) y la renombra sobre el original solo si todo salió bien,
+// así que un error o una caída a medias deja el disco anterior intacto.
+//
+// El MBR, los EBR y los superbloques del formato actual son más
+// grandes que los anteriores, así que no caben donde estaban: cada uno
+// se escribe en su posición nueva y los datos que hay entre ellos se
+// copian corridos lo que crecieron las estructuras anteriores (ver
+// Remap). Todas las posiciones guardadas (particiones, EBR y
+// superbloques) se traducen igual; los números de inodo y de bloque no
+// cambian. En v1 además la tabla de inodos pasa de 104 a 100 bytes por
+// inodo, en orden ascendente: lo escrito nunca alcanza a lo que falta
+// leer.
+//
+// No se permite con particiones del disco montadas.
+// =============================================
+class Convert {
+public:
+    static std::string execute(const CommandLine& cmd) {
+        std::string path = "";
+
+        for(const Param& p : cmd) {
+            if(p.is("path")) path = p.value;
+            else return unknownParam(p);
+        }
+
+        if(path.empty()) return "Error: -path es obligatorio";
+
+        // Candados, discos abiertos y cachés van por la ruta canónica
+        path = canonicalPath(path);
+
+        auto diskLock = DiskLocks::exclusive(path);
+        struct stat st;
+        if(stat(path.c_str(), &st) != 0) return "Error: El disco no existe: " + path;
+
+        for(const MountedPartition& mp : MountedPartitions::snapshot())
+            if(mp.path == path)
+                return "Error: Desmonte las particiones del disco antes de convertirlo (" + mp.id + ")";
+
+        // Lo pendiente (caché o un journal que quedó de una caída) va al
+        // archivo antes de copiarlo: abrir el disco aplica el journal y
+        // sacarlo del registro hace el checkpoint. Un journal con las
+        // posiciones anteriores no debe aplicarse sobre el disco nuevo.
+        if(!DiskManager::get(path)) return "Error: No se pudo abrir el disco: " + path;
+        DiskManager::drop(path, false);
+
+        auto t0 = std::chrono::steady_clock::now();
+        std::string tmp = path + ".convert";
+        Stats stats;
+        std::string error = convert(path, tmp, (long long)st.st_size, stats);
+        if(error.empty() && rename(tmp.c_str(), path.c_str()) != 0)
+            error = "No se pudo reemplazar " + path + ": " + strerror(errno);
+        if(!error.empty()) {
+            unlink(tmp.c_str());
+            return "Error: " + error;
+        }
+        syncParentDir(path);
+
+        BitmapCache::invalidate(path);
+        DentryCache::invalidate(path);
+        UsersCache::invalidate(path);
+        EbrIndex::invalidate(path);
+
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        char timing[64];
+        std::snprintf(timing, sizeof(timing), "%.3f s", secs);
+        return "OK: Disco convertido del formato v" + std::to_string(stats.from) +
+               " al v" + std::to_string(DISK_FORMAT_VERSION) + ": " + path +
+               " | Lógicas: " + std::to_string(stats.logicals) +
+               " | Sistemas EXT2: " + std::to_string(stats.filesystems) +
+               " | Inodos: " + std::to_string(stats.inodes) +
+               " | Bytes ahorrados en tablas: " + std::to_string(stats.saved) +
+               " | Bytes agregados al disco: " + std::to_string(stats.grown) +
+               " | Tiempo: " + timing;
+    }
+
+private:
+    struct Stats {
+        int       from        = 0;
+        int       logicals    = 0;
+        int       filesystems = 0;
+        long long inodes      = 0;
+        long long saved       = 0;
+        long long grown       = 0;
+    };
+
+    // -----------------------------------------------
+    // Traducción de posiciones del disco anterior al nuevo. Cada
+    // estructura anterior (MBR, EBR o superbloque) ocupa 'oldSize'
+    // bytes en 'pos' y la nueva 'newSize': todo lo que está después se
+    // corre lo que crecieron las estructuras anteriores a esa posición.
+    // -----------------------------------------------
+    class Remap {
+    public:
+        void add(long long pos, long long oldSize, long long newSize) {
+            pieces.push_back({pos, oldSize, newSize});
+        }
+
+        // Ordena y verifica que las estructuras no se pisen y quepan
+        // en el disco de 'size' bytes
+        bool finish(long long size) {
+            std::sort(pieces.begin(), pieces.end(),
+                      [](const Piece& a, const Piece& b) { return a.pos < b.pos; });
+            growth.assign(1, 0);
+            for(size_t i = 0; i < pieces.size(); i++) {
+                long long end = pieces[i].pos + pieces[i].oldSize;
+                long long limit = (i + 1 < pieces.size()) ? pieces[i + 1].pos : size;
+                if(end > limit) return false;
+                growth.push_back(growth.back() + pieces[i].newSize - pieces[i].oldSize);
+            }
+            return true;
+        }
+
+        // Posición nueva de 'x' (crecimiento de las estructuras antes de x)
+        long long at(long long x) const {
+            auto it = std::lower_bound(pieces.begin(), pieces.end(), x,
+                                       [](const Piece& p, long long v) { return p.pos < v; });
+            return x + growth[it - pieces.begin()];
+        }
+
+        // fn(inicio, fin) de cada tramo de datos entre estructuras
+        template<typename Fn>
+        bool forEachGap(long long size, Fn&& fn) const {
+            for(size_t i = 0; i < pieces.size(); i++) {
+                long long from = pieces[i].pos + pieces[i].oldSize;
+                long long to   = (i + 1 < pieces.size()) ? pieces[i + 1].pos : size;
+                if(from < to && !fn(from, to)) return false;
+            }
+            return true;
+        }
+
+    private:
+        struct Piece { long long pos, oldSize, newSize; };
+        std::vector<Piece>     pieces;
+        std::vector<long long> growth; // growth[i]: crecimiento de las primeras i
+    };
+
+    static std::string convert(const std::string& path, const std::string& tmp,
+                               long long size, Stats& stats) {
+        int src = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if(src < 0) return "No se pudo abrir el disco: " + path;
+
+        char magic[4];
+        if(!readAll(src, magic, sizeof(magic), 0)) {
+            close(src);
+            return path + " no tiene un MBR válido";
+        }
+        int version = (std::memcmp(magic, MBR_MAGIC, 3) != 0) ? 1 : (unsigned char)magic[3];
+        if(version != 1 && version != 2) {
+            close(src);
+            if(version == DISK_FORMAT_VERSION) return path + " ya usa el formato v" + std::to_string(version);
+            return path + " usa el formato v" + std::to_string(version) + ", que no se puede convertir";
+        }
+
+        int dst = open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if(dst < 0) { close(src); return "No se pudo crear " + tmp; }
+
+        stats.from = version;
+        std::string error = (version == 1) ? convertFrom<FormatV1>(src, dst, size, stats)
+                                           : convertFrom<FormatV2>(src, dst, size, stats);
+        close(src);
+        if(error.empty() && fsync(dst) != 0) error = "fsync falló sobre " + tmp;
+        if(close(dst) != 0 && error.empty()) error = "No se pudo cerrar " + tmp;
+        return error;
+    }
+
+    // Lee las estructuras del disco anterior, calcula sus posiciones
+    // nuevas, copia los datos corridos y escribe las estructuras nuevas
+    template<typename F>
+    static std::string convertFrom(int src, int dst, long long size, Stats& stats) {
+        typename F::MBR old;
+        if(!readStruct(src, 0, old) || old.mbr_tamano != size)
+            return "No es un disco v" + std::to_string(F::version) +
+                   " válido (el tamaño del MBR no coincide con el archivo)";
+
+        std::vector<std::pair<long long, typename F::EBR>> ebrs;
+        std::vector<Fs<F>>                                 filesystems;
+        Remap remap;
+        remap.add(0, sizeof(typename F::MBR), sizeof(MBR));
+
+        for(const auto& part : old.mbr_partitions) {
+            if(part.part_start == -1) continue;
+            long long start = part.part_start, end = start + (long long)part.part_s;
+            if(start < (long long)sizeof(typename F::MBR) || part.part_s < 0 || end > size)
+                return "La partición " + std::string(part.part_name, strnlen(part.part_name, 16)) +
+                       " se sale del disco";
+            std::string error = (part.part_type == 'E')
+                ? readLogicals<F>(src, start, end, ebrs, filesystems, stats)
+                : readFs<F>(src, start, end, filesystems);
+            if(!error.empty()) return error;
+        }
+
+        for(const auto& e : ebrs)       remap.add(e.first, sizeof(typename F::EBR), sizeof(EBR));
+        for(const auto& fs : filesystems) remap.add(fs.start, sizeof(typename F::SB), sizeof(SuperBloque));
+        if(!remap.finish(size)) return "Hay estructuras superpuestas en el disco";
+
+        long long newSize = remap.at(size);
+        if(ftruncate(dst, newSize) != 0) return "No se pudo crear la copia del disco";
+        bool copied = remap.forEachGap(size, [&](long long from, long long to) {
+            return copySparse(src, dst, from, to, remap.at(from) - from);
+        });
+        if(!copied) return "No se pudo copiar el disco";
+
+        // MBR
+        MBR mbr;
+        mbr.mbr_tamano         = newSize;
+        mbr.mbr_fecha_creacion = (time_t)old.mbr_fecha_creacion;
+        mbr.mbr_dsk_signature  = old.mbr_dsk_signature;
+        mbr.dsk_fit            = old.dsk_fit;
+        for(int i = 0; i < 4; i++) {
+            const auto& from = old.mbr_partitions[i];
+            Partition&  to   = mbr.mbr_partitions[i];
+            to.part_status      = from.part_status;
+            to.part_type        = from.part_type;
+            to.part_fit         = from.part_fit;
+            to.part_correlative = from.part_correlative;
+            std::memcpy(to.part_name, from.part_name, sizeof(to.part_name));
+            std::memcpy(to.part_id,   from.part_id,   sizeof(to.part_id));
+            if(from.part_start != -1) {
+                to.part_start = remap.at(from.part_start);
+                to.part_s     = remap.at(from.part_start + (long long)from.part_s) - to.part_start;
+            }
+        }
+        if(!writeStruct(dst, 0, mbr)) return "No se pudo escribir el MBR";
+
+        // EBRs
+        for(const auto& e : ebrs) {
+            const typename F::EBR& from = e.second;
+            EBR ebr;
+            ebr.part_mount = from.part_mount;
+            ebr.part_fit   = from.part_fit;
+            ebr.part_start = (from.part_start == -1) ? -1 : remap.at(from.part_start);
+            ebr.part_s     = (from.part_s == -1) ? -1
+                             : remap.at(from.part_start + (long long)from.part_s) - ebr.part_start;
+            ebr.part_next  = (from.part_next == -1) ? -1 : remap.at(from.part_next);
+            std::memcpy(ebr.part_name, from.part_name, sizeof(ebr.part_name));
+            if(!writeStruct(dst, remap.at(e.first), ebr))
+                return "No se pudo escribir el EBR en " + std::to_string(e.first);
+        }
+
+        // Sistemas de archivos
+        for(const Fs<F>& fs : filesystems) {
+            std::string error = rewriteFs<F>(dst, remap, fs, stats);
+            if(!error.empty()) return error;
+        }
+
+        stats.grown = newSize - size;
+        return "";
+    }
+
+    // EXT2 de una partición del disco anterior
+    template<typename F>
+    struct Fs {
+        long long      start, end;
+        typename F::SB sb;
+    };
+
+    // Recorre la lista de EBRs como EbrChain::load
+    template<typename F>
+    static std::string readLogicals(int fd, long long extStart, long long extEnd,
+                                    std::vector<std::pair<long long, typename F::EBR>>& ebrs,
+                                    std::vector<Fs<F>>& filesystems, Stats& stats) {
+        long long pos = extStart;
+        while(pos >= extStart && pos + (long long)sizeof(typename F::EBR) <= extEnd) {
+            typename F::EBR ebr;
+            if(!readStruct(fd, pos, ebr)) return "No se pudo leer el EBR en " + std::to_string(pos);
+            ebrs.push_back({pos, ebr});
+
+            if(ebr.part_s != -1) {
+                long long start = ebr.part_start, end = start + (long long)ebr.part_s;
+                if(start < pos + (long long)sizeof(typename F::EBR) || ebr.part_s < 0 || end > extEnd)
+                    return "La lógica del EBR en " + std::to_string(pos) + " se sale de la extendida";
+                std::string error = readFs<F>(fd, start, end, filesystems);
+                if(!error.empty()) return error;
+                stats.logicals++;
+            }
+            if(ebr.part_next <= pos) break;
+            pos = ebr.part_next;
+        }
+        return "";
+    }
+
+    // Si [start, end) tiene un EXT2 del formato anterior lo agrega
+    template<typename F>
+    static std::string readFs(int fd, long long start, long long end, std::vector<Fs<F>>& filesystems) {
+        Fs<F> fs{start, end, {}};
+        if(end - start < (long long)sizeof(typename F::SB) || !readStruct(fd, start, fs.sb) ||
+           !F::hasFs(fs.sb))
+            return "";
+
+        long long tableEnd = fs.sb.s_inode_start + (long long)fs.sb.s_inodes_count * fs.sb.s_inode_s;
+        if(fs.sb.s_inodes_count < 0 || fs.sb.s_inode_start < start + (long long)sizeof(typename F::SB) ||
+           tableEnd > end)
+            return "La tabla de inodos del EXT2 en " + std::to_string(start) + " se sale de la partición";
+        filesystems.push_back(fs);
+        return "";
+    }
+
+    // Superbloque nuevo y, si cambió el tamaño del inodo, la tabla de
+    // inodos (que ya está copiada en su posición nueva)
+    template<typename F>
+    static std::string rewriteFs(int fd, const Remap& remap, const Fs<F>& fs, Stats& stats) {
+        const typename F::SB& old = fs.sb;
+        long long count      = old.s_inodes_count;
+        long long tableStart = remap.at(old.s_inode_start);
+        long long saved      = 0;
+
+        if constexpr(sizeof(typename F::Inode) != sizeof(Inode)) {
+            std::vector<char> in(CONVERT_INODE_CHUNK * sizeof(typename F::Inode));
+            std::vector<char> out(CONVERT_INODE_CHUNK * sizeof(Inode));
+            for(long long first = 0; first < count; first += CONVERT_INODE_CHUNK) {
+                size_t n = (size_t)std::min<long long>(CONVERT_INODE_CHUNK, count - first);
+                if(!readAll(fd, in.data(), n * sizeof(typename F::Inode),
+                            tableStart + first * (long long)sizeof(typename F::Inode)))
+                    return "No se pudo leer la tabla de inodos en " + std::to_string(fs.start);
+                for(size_t i = 0; i < n; i++) {
+                    typename F::Inode from;
+                    diskDecode(in.data() + i * sizeof(typename F::Inode), from);
+                    Inode to;
+                    to.i_uid   = from.i_uid;
+                    to.i_gid   = from.i_gid;
+                    to.i_s     = from.i_s;
+                    to.i_atime = (time_t)from.i_atime;
+                    to.i_ctime = (time_t)from.i_ctime;
+                    to.i_mtime = (time_t)from.i_mtime;
+                    std::memcpy(to.i_block, from.i_block, sizeof(to.i_block));
+                    to.i_type  = from.i_type;
+                    std::memcpy(to.i_perm, from.i_perm, sizeof(to.i_perm));
+                    diskEncode(to, out.data() + i * sizeof(Inode));
+                }
+                if(!writeAll(fd, out.data(), n * sizeof(Inode), tableStart + first * (long long)sizeof(Inode)))
+                    return "No se pudo escribir la tabla de inodos en " + std::to_string(fs.start);
+            }
+
+            // Lo que sobra al final de la tabla queda en cero
+            saved = count * (long long)(sizeof(typename F::Inode) - sizeof(Inode));
+            std::vector<char> zeros((size_t)std::min<long long>(saved, DISK_ZERO_CHUNK), 0);
+            for(long long done = 0; done < saved; ) {
+                size_t len = (size_t)std::min<long long>(saved - done, zeros.size());
+                if(!writeAll(fd, zeros.data(), len, tableStart + count * (long long)sizeof(Inode) + done))
+                    return "No se pudo limpiar la tabla de inodos en " + std::to_string(fs.start);
+                done += len;
+            }
+        }
+
+        SuperBloque sb;
+        sb.s_filesystem_type   = old.s_filesystem_type;
+        sb.s_inodes_count      = old.s_inodes_count;
+        sb.s_blocks_count      = old.s_blocks_count;
+        sb.s_free_blocks_count = old.s_free_blocks_count;
+        sb.s_free_inodes_count = old.s_free_inodes_count;
+        sb.s_mtime             = (time_t)old.s_mtime;
+        sb.s_umtime            = (time_t)old.s_umtime;
+        sb.s_mnt_count         = old.s_mnt_count;
+        sb.s_magic             = old.s_magic;
+        sb.s_inode_s           = sizeof(Inode);
+        sb.s_block_s           = old.s_block_s;
+        sb.s_first_blo         = (old.s_first_blo < 0) ? -1 : remap.at(old.s_first_blo);
+        sb.s_bm_inode_start    = remap.at(old.s_bm_inode_start);
+        sb.s_bm_block_start    = remap.at(old.s_bm_block_start);
+        sb.s_inode_start       = tableStart;
+        sb.s_block_start       = remap.at(old.s_block_start);
+        // s_firts_ino es la posición del primer inodo libre: cambia con el tamaño
+        sb.s_firts_ino = (old.s_firts_ino < 0) ? -1
+                         : (old.s_firts_ino < old.s_inode_start) ? remap.at(old.s_firts_ino)
+                         : tableStart + (long long)(old.s_firts_ino - old.s_inode_start) /
+                                        (long long)sizeof(typename F::Inode) * (long long)sizeof(Inode);
+        if(!writeStruct(fd, remap.at(fs.start), sb))
+            return "No se pudo escribir el superbloque en " + std::to_string(fs.start);
+
+        stats.filesystems++;
+        stats.inodes += count;
+        stats.saved  += saved;
+        return "";
+    }
+
+    // -----------------------------------------------
+    // E/S sobre los archivos
+    // -----------------------------------------------
+    template<typename T>
+    static bool readStruct(int fd, long long offset, T& out) {
+        char raw[sizeof(T)];
+        if(!readAll(fd, raw, sizeof(T), offset)) return false;
+        diskDecode(raw, out);
+        return true;
+    }
+
+    template<typename T>
+    static bool writeStruct(int fd, long long offset, const T& in) {
+        char raw[sizeof(T)];
+        diskEncode(in, raw);
+        return writeAll(fd, raw, sizeof(T), offset);
+    }
+
+    static bool readAll(int fd, char* dst, size_t len, long long offset) {
+        while(len > 0) {
+            ssize_t n = pread(fd, dst, len, offset);
+            if(n < 0 && errno == EINTR) continue;
+            if(n <= 0) return false;
+            dst += n; len -= n; offset += n;
+        }
+        return true;
+    }
+
+    static bool writeAll(int fd, const char* src, size_t len, long long offset) {
+        while(len > 0) {
+            ssize_t n = pwrite(fd, src, len, offset);
+            if(n < 0 && errno == EINTR) continue;
+            if(n <= 0) return false;
+            src += n; len -= n; offset += n;
+        }
+        return true;
+    }
+
+    // Copia [from, to) de 'src' a 'shift' bytes más adelante en 'dst'.
+    // Solo las zonas con datos (SEEK_DATA/SEEK_HOLE) y con
+    // copy_file_range: los huecos de un disco disperso siguen siéndolo
+    static bool copySparse(int src, int dst, long long from, long long to, long long shift) {
+        long long pos = from;
+        while(pos < to) {
+            off_t data = lseek(src, pos, SEEK_DATA);
+            if(data < 0) return errno == ENXIO; // no hay más datos
+            if(data >= to) return true;
+            off_t hole = lseek(src, data, SEEK_HOLE);
+            if(hole < 0 || hole > to) hole = to;
+            loff_t in = data, out = data + shift;
+            while(in < hole) {
+                ssize_t n = copy_file_range(src, &in, dst, &out, (size_t)(hole - in), 0);
+                if(n < 0 && errno == EINTR) continue;
+                if(n <= 0) return false;
+            }
+            pos = hole;
+        }
+        return true;
+    }
+
+    // El rename queda en el medio físico junto con el directorio
+    static void syncParentDir(const std::string& path) {
+        int dir = open(getParentDir(path).c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if(dir < 0) return;
+        fsync(dir);
+        close(dir);
+    }
+};
+
+#endif // CONVERT_H
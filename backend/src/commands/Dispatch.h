@@ -0,0 +1,65 @@
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include "../utils/CommandParser.h"
+#include "../utils/Session.h"
+#include "MkDisk.h"
+#include "RmDisk.h"
+#include "FDisk.h"
+#include "Mount.h"
+#include "MkFs.h"
+#include "Login.h"
+#include "Sync.h"
+#include "FreeSpace.h"
+#include "Fsck.h"
+#include "Rep.h"
+#include "Convert.h"
+
+// =============================================
+// DISPATCH
+// Procesa un solo comando y retorna su salida. La línea se analiza como
+// vistas sobre el script (sin copias) y el comando se identifica con la
+// tabla de hash perfecto de CommandParser.h. Lo usan el servidor
+// (main.cpp) y los programas de backend/tests y backend/bench, que
+// ejecutan comandos sin pasar por HTTP.
+// =============================================
+inline std::string processCommand(std::string_view rawLine, SessionContext& ctx) {
+    std::string_view line = trimView(rawLine);
+    if(line.empty())    return "";
+    if(line[0] == '#')  return std::string(line); // comentario
+
+    CommandLine cmd = CommandLine::parse(line);
+    if(cmd.overflow())
+        return "Error: Demasiados parámetros (máximo " + std::to_string(MAX_PARAMS) + ")";
+
+    // Una excepción (p.ej. un acceso fuera de rango) no debe terminar
+    // el hilo trabajador: se convierte en un error del comando
+    try {
+        switch(lookupCommand(cmd.name)) {
+            case CMD_MKDISK:    return MkDisk::execute(cmd);
+            case CMD_RMDISK:    return RmDisk::execute(cmd);
+            case CMD_FDISK:     return FDisk::execute(cmd);
+            case CMD_MOUNT:     return Mount::execute(cmd);
+            case CMD_MOUNTED:   return Mounted::execute();
+            case CMD_UNMOUNT:   return Unmount::execute(cmd);
+            case CMD_MKFS:      return MkFs::execute(cmd);
+            case CMD_LOGIN:     return Login::execute(cmd, ctx);
+            case CMD_LOGOUT:    return Logout::execute(ctx);
+            case CMD_SYNC:      return Sync::execute(cmd);
+            case CMD_FREESPACE: return FreeSpace::execute(cmd);
+            case CMD_FSCK:      return Fsck::execute(cmd);
+            case CMD_REP:       return Rep::execute(cmd);
+            case CMD_CONVERT:   return Convert::execute(cmd);
+            case CMD_UNKNOWN:   break;
+        }
+    } catch(const std::exception& e) {
+        return "Error: Fallo al ejecutar '" + std::string(cmd.name) + "' -> " + e.what();
+    }
+
+    return "Error: Comando no reconocido -> " + std::string(cmd.name);
+}
+
+#endif // DISPATCH_H
@@ -3,74 +3,111 @@
 
 #include <string>
 #include <vector>
-#include <fstream>
+#include <memory>
 #include <cstring>
+#include <climits>
 #include <sys/stat.h>
 #include "../structs/Structs.h"
 #include "../utils/Utils.h"
-
+#include "../utils/CommandParser.h"
+#include "../utils/DiskLocks.h"
+#include "../utils/DiskManager.h"
+#include "../utils/FreeExtents.h"
+#include "../utils/EbrIndex.h"
+#include "../utils/MountedPartitions.h"
+#include "../utils/Bitmap.h"
+#include "../utils/PathResolver.h"
+#include "../utils/UsersTable.h"
+
+// =============================================
+// FDISK - Crear, eliminar o redimensionar particiones
+// fdisk -size=N -path=... -name=... [-unit] [-type=P|E|L] [-fit]
+// fdisk -delete=fast|full -path=... -name=...
+// fdisk -add=±N -path=... -name=... [-unit]
+// =============================================
 class FDisk {
 public:
-    static std::string execute(const std::vector<std::pair<std::string,std::string>>& params) {
+    // fast: solo se actualiza MBR/EBR; full: además se pone en cero la región
+    enum class DeleteMode { NONE, FAST, FULL };
+
+    static std::string execute(const CommandLine& cmd) {
         int         size = -1;
-        std::string unit = "k";
+        Unit        unit = Unit::K;
         std::string path = "";
-        std::string type = "p";
-        std::string fit  = "wf";
+        PartType    type = PartType::PRIMARY;
+        Fit         fit  = Fit::WF;
         std::string name = "";
+        DeleteMode  del  = DeleteMode::NONE;
+        int         add  = 0;
+        bool        hasAdd = false;
 
-        for(const auto& p : params) {
-            std::string key = toLower(p.first);
-            std::string val = p.second;
-
-            if(key == "size")      size = std::stoi(val);
-            else if(key == "unit") unit = toLower(val);
-            else if(key == "path") path = val;
-            else if(key == "type") type = toLower(val);
-            else if(key == "fit")  fit  = toLower(val);
-            else if(key == "name") name = val;
-            else return "Error: Parámetro no reconocido -> " + p.first;
+        for(const Param& p : cmd) {
+            if(p.is("size")) {
+                if(!parseInt(p.value, size)) return invalidValue(p);
+            }
+            else if(p.is("unit")) {
+                if(!parseEnum(p.value, UNIT_NAMES, unit)) return "Error: -unit debe ser B, K o M";
+            }
+            else if(p.is("path")) path = p.value;
+            else if(p.is("type")) {
+                if(!parseEnum(p.value, TYPE_NAMES, type)) return "Error: -type debe ser P, E o L";
+            }
+            else if(p.is("fit")) {
+                if(!parseEnum(p.value, FIT_NAMES, fit)) return "Error: -fit debe ser BF, FF o WF";
+            }
+            else if(p.is("name")) name = p.value;
+            else if(p.is("delete")) {
+                if(!parseEnum(p.value, DELETE_NAMES, del)) return "Error: -delete debe ser FAST o FULL";
+            }
+            else if(p.is("add")) {
+                if(!parseInt(p.value, add)) return invalidValue(p);
+                hasAdd = true;
+            }
+            else return unknownParam(p);
         }
 
         // Validaciones
         if(path.empty()) return "Error: -path es obligatorio";
-        if(name.empty()) return "Error: -name es obligatorio";
-        if(size <= 0)    return "Error: -size debe ser mayor a 0";
 
-        if(unit != "b" && unit != "k" && unit != "m")
-            return "Error: -unit debe ser B, K o M";
-        if(type != "p" && type != "e" && type != "l")
-            return "Error: -type debe ser P, E o L";
-        if(fit != "bf" && fit != "ff" && fit != "wf")
-            return "Error: -fit debe ser BF, FF o WF";
+        // Candados, discos abiertos y cachés van por la ruta canónica
+        path = canonicalPath(path);
+        if(name.empty()) return "Error: -name es obligatorio";
+        if(del != DeleteMode::NONE && hasAdd)
+            return "Error: -delete y -add no se pueden usar juntos";
+        if(hasAdd && add == 0) return "Error: -add no puede ser 0";
+        if(del == DeleteMode::NONE && !hasAdd && size <= 0)
+            return "Error: -size debe ser mayor a 0";
 
         // Verificar que el disco existe
         struct stat st;
         if(stat(path.c_str(), &st) != 0)
             return "Error: El disco no existe: " + path;
 
-        // Calcular tamaño en bytes
-        long long sizeBytes;
-        if(unit == "b")      sizeBytes = size;
-        else if(unit == "k") sizeBytes = (long long)size * 1024;
-        else                 sizeBytes = (long long)size * 1024 * 1024;
-
-        char fitChar = (fit == "bf") ? 'B' : (fit == "ff") ? 'F' : 'W';
+        long long sizeBytes = (long long)size * unitBytes(unit);
 
         // Abrir disco
-        std::fstream disk(path, std::ios::binary | std::ios::in | std::ios::out);
-        if(!disk.is_open())
+        auto diskLock = DiskLocks::exclusive(path);
+        std::shared_ptr<Disk> disk = DiskManager::get(path);
+        if(!disk)
             return "Error: No se pudo abrir el disco: " + path;
 
         // Leer MBR
         MBR mbr;
-        disk.seekg(0, std::ios::beg);
-        disk.read(reinterpret_cast<char*>(&mbr), sizeof(MBR));
-
-        if(type == "l") {
-            return createLogical(disk, mbr, path, sizeBytes, fitChar, name);
+        if(!disk->read(0, mbr))
+            return "Error: No se pudo leer el MBR de: " + path;
+        std::string formatError = mbrFormatError(mbr, path);
+        if(!formatError.empty()) return formatError;
+
+        if(del != DeleteMode::NONE)
+            return removePartition(*disk, mbr, path, name, del);
+        if(hasAdd)
+            return resizePartition(*disk, mbr, path, name, (long long)add * unitBytes(unit));
+
+        if(type == PartType::LOGICAL) {
+            return createLogical(*disk, mbr, path, sizeBytes, fitChar(fit), name);
         } else {
-            return createPrimary(disk, mbr, path, sizeBytes, fitChar, name, type[0]);
+            return createPrimary(*disk, mbr, path, sizeBytes, fitChar(fit), name,
+                                 type == PartType::EXTENDED ? 'e' : 'p');
         }
     }
 
@@ -78,7 +115,7 @@ private:
     // -----------------------------------------------
     // Crear partición primaria o extendida
     // -----------------------------------------------
-    static std::string createPrimary(std::fstream& disk, MBR& mbr,
+    static std::string createPrimary(Disk& disk, MBR& mbr,
                                      const std::string& path,
                                      long long sizeBytes, char fitChar,
                                      const std::string& name, char typeChar) {
@@ -99,6 +136,10 @@ private:
                     return "Error: Ya existe una partición con ese nombre: " + name;
             }
         }
+        long long logicalPos;
+        std::shared_ptr<EbrChain> chain = EbrIndex::get(disk, path, mbr);
+        if(chain && chain->find(name, logicalPos))
+            return "Error: Ya existe una partición lógica con ese nombre: " + name;
 
         if(count >= 4)
             return "Error: Ya existen 4 particiones (máximo permitido)";
@@ -106,7 +147,7 @@ private:
             return "Error: Solo puede existir una partición extendida por disco";
 
         // Encontrar espacio libre según el ajuste del MBR
-        int startByte = findFreeSpace(mbr, mbr.mbr_tamano, sizeBytes, mbr.dsk_fit);
+        long long startByte = mbrFreeSpace(mbr).find(sizeBytes, mbr.dsk_fit);
         if(startByte == -1)
             return "Error: No hay espacio suficiente en el disco";
 
@@ -124,7 +165,7 @@ private:
         part.part_type   = (typeChar == 'p' || typeChar == 'P') ? 'P' : 'E';
         part.part_fit    = fitChar;
         part.part_start  = startByte;
-        part.part_s      = (int)sizeBytes;
+        part.part_s      = sizeBytes;
         std::strncpy(part.part_name, name.c_str(), 15);
         part.part_name[15]   = '\0';
         part.part_correlative = -1;
@@ -140,14 +181,13 @@ private:
             ebr.part_next  = -1;
             std::memset(ebr.part_name, 0, 16);
 
-            disk.seekp(startByte, std::ios::beg);
-            disk.write(reinterpret_cast<char*>(&ebr), sizeof(EBR));
+            disk.write(startByte, ebr);
+            EbrIndex::invalidate(path);
         }
 
         // Escribir MBR actualizado
-        disk.seekp(0, std::ios::beg);
-        disk.write(reinterpret_cast<char*>(&mbr), sizeof(MBR));
-        disk.close();
+        if(!disk.write(0, mbr))
+            return "Error: No se pudo escribir el MBR";
 
         return "OK: Partición '" + name + "' creada exitosamente | Inicio: " +
                std::to_string(startByte) + " | Tamaño: " + std::to_string(sizeBytes) + " bytes";
@@ -156,12 +196,12 @@ private:
     // -----------------------------------------------
     // Crear partición lógica dentro de la extendida
     // -----------------------------------------------
-    static std::string createLogical(std::fstream& disk, MBR& mbr,
+    static std::string createLogical(Disk& disk, MBR& mbr,
                                      const std::string& path,
                                      long long sizeBytes, char fitChar,
                                      const std::string& name) {
         // Buscar partición extendida
-        int extStart = -1, extSize = -1;
+        long long extStart = -1, extSize = -1;
         for(int i = 0; i < 4; i++) {
             if(mbr.mbr_partitions[i].part_type == 'E' &&
                mbr.mbr_partitions[i].part_start != -1) {
@@ -173,124 +213,167 @@ private:
         if(extStart == -1)
             return "Error: No existe una partición extendida. Créala primero con -type=E";
 
-        // Recorrer lista de EBRs
-        EBR ebr;
-        int currentPos  = extStart;
-        int lastEBRPos  = -1;
-        int usedSpace   = 0;
-
-        while(true) {
-            disk.seekg(currentPos, std::ios::beg);
-            disk.read(reinterpret_cast<char*>(&ebr), sizeof(EBR));
-
-            // Verificar nombre duplicado
-            if(std::string(ebr.part_name) == name)
-                return "Error: Ya existe una partición lógica con ese nombre: " + name;
-
-            lastEBRPos = currentPos;
-
-            if(ebr.part_next == -1) break;
-            currentPos = ebr.part_next;
-        }
-
-        // Calcular dónde escribir el nuevo EBR
-        int newEBRPos;
-        if(ebr.part_s == -1) {
-            // Primer EBR (vacío), usarlo directamente
-            newEBRPos = extStart;
-        } else {
-            // Ir después del último EBR + su partición
-            newEBRPos = lastEBRPos + sizeof(EBR) + ebr.part_s;
+        // Lista de EBRs indexada en RAM: se recorre del disco solo la primera vez
+        std::shared_ptr<EbrChain> chain = EbrIndex::get(disk, path, extStart, extSize);
+        long long existing;
+        if(chain->find(name, existing))
+            return "Error: Ya existe una partición lógica con ese nombre: " + name;
+        for(int i = 0; i < 4; i++) {
+            if(mbr.mbr_partitions[i].part_start != -1 &&
+               std::string(mbr.mbr_partitions[i].part_name) == name)
+                return "Error: Ya existe una partición con ese nombre: " + name;
         }
 
-        // Verificar que cabe dentro de la extendida
-        if(newEBRPos + (int)sizeof(EBR) + (int)sizeBytes > extStart + extSize)
+        // Hueco de la extendida para el EBR y la partición, según -fit
+        long long newEBRPos = chain->place(sizeBytes, fitChar);
+        if(newEBRPos == -1)
             return "Error: No hay espacio suficiente en la partición extendida";
 
-        // Crear nuevo EBR
+        // Crear nuevo EBR (insert() lo enlaza con el anterior)
         EBR newEBR;
         newEBR.part_mount = '0';
         newEBR.part_fit   = fitChar;
-        newEBR.part_start = newEBRPos + sizeof(EBR);
-        newEBR.part_s     = (int)sizeBytes;
-        newEBR.part_next  = -1;
+        newEBR.part_start = newEBRPos + (long long)sizeof(EBR);
+        newEBR.part_s     = sizeBytes;
         std::strncpy(newEBR.part_name, name.c_str(), 15);
         newEBR.part_name[15] = '\0';
 
-        // Actualizar el EBR anterior para que apunte al nuevo
-        if(ebr.part_s != -1) {
-            ebr.part_next = newEBRPos;
-            disk.seekp(lastEBRPos, std::ios::beg);
-            disk.write(reinterpret_cast<char*>(&ebr), sizeof(EBR));
+        if(!chain->insert(disk, newEBRPos, newEBR)) {
+            EbrIndex::invalidate(path);
+            return "Error: No se pudo escribir el EBR";
         }
 
-        // Escribir nuevo EBR
-        disk.seekp(newEBRPos, std::ios::beg);
-        disk.write(reinterpret_cast<char*>(&newEBR), sizeof(EBR));
-        disk.close();
-
         return "OK: Partición lógica '" + name + "' creada | Inicio: " +
                std::to_string(newEBR.part_start) + " | Tamaño: " +
                std::to_string(sizeBytes) + " bytes";
     }
 
-    // -----------------------------------------------
-    // Encontrar espacio libre en el disco
-    // Soporta FF (First Fit), BF (Best Fit), WF (Worst Fit)
-    // -----------------------------------------------
-    static int findFreeSpace(MBR& mbr, int diskSize, long long neededSize, char fit) {
-        // Construir lista de espacios ocupados
-        std::vector<std::pair<int,int>> occupied; // {start, end}
-        occupied.push_back({0, (int)sizeof(MBR)}); // El MBR siempre ocupa el inicio
+    static constexpr EnumName<DeleteMode> DELETE_NAMES[] = {{"fast", DeleteMode::FAST},
+                                                            {"full", DeleteMode::FULL}};
 
+    // Índice en el MBR de la primaria/extendida 'name' (-1 si no está)
+    static int findSlot(const MBR& mbr, const std::string& name) {
         for(int i = 0; i < 4; i++) {
-            if(mbr.mbr_partitions[i].part_start != -1) {
-                int s = mbr.mbr_partitions[i].part_start;
-                int e = s + mbr.mbr_partitions[i].part_s;
-                occupied.push_back({s, e});
-            }
+            if(mbr.mbr_partitions[i].part_start != -1 &&
+               std::string(mbr.mbr_partitions[i].part_name) == name) return i;
         }
+        return -1;
+    }
 
-        // Ordenar por inicio
-        std::sort(occupied.begin(), occupied.end());
+    static bool isMounted(const std::string& path, const std::string& name) {
+        MountedPartition mp;
+        return MountedPartitions::findByPathAndName(path, name, mp);
+    }
 
-        // Construir lista de espacios libres
-        std::vector<std::pair<int,int>> freeSpaces; // {start, size}
-        int prev = 0;
-        for(const auto& occ : occupied) {
-            if(occ.first > prev) {
-                freeSpaces.push_back({prev, occ.first - prev});
+    // Lo que se recuerda del contenido de las particiones ya no vale
+    static void invalidateCaches(const std::string& path) {
+        BitmapCache::invalidate(path);
+        DentryCache::invalidate(path);
+        UsersCache::invalidate(path);
+    }
+
+    // -----------------------------------------------
+    // Eliminar partición (primaria, extendida o lógica)
+    // -----------------------------------------------
+    static std::string removePartition(Disk& disk, MBR& mbr, const std::string& path,
+                                       const std::string& name, DeleteMode mode) {
+        if(isMounted(path, name))
+            return "Error: La partición '" + name + "' está montada; desmóntala primero";
+        bool full = (mode == DeleteMode::FULL);
+
+        int slot = findSlot(mbr, name);
+        if(slot != -1) {
+            Partition& part = mbr.mbr_partitions[slot];
+            if(part.part_type == 'E') {
+                std::shared_ptr<EbrChain> chain = EbrIndex::get(disk, path, mbr);
+                std::string mounted;
+                chain->forEach([&](long long, const EBR& ebr) {
+                    if(mounted.empty() && isMounted(path, ebr.part_name)) mounted = ebr.part_name;
+                });
+                if(!mounted.empty())
+                    return "Error: La lógica '" + mounted + "' está montada; desmóntala primero";
             }
-            prev = occ.second;
-        }
-        if(prev < diskSize) {
-            freeSpaces.push_back({prev, diskSize - prev});
+
+            if(full && !disk.zero(part.part_start, part.part_s))
+                return "Error: No se pudo poner en cero la partición";
+            char typeChar = part.part_type;
+            part = Partition();
+            if(!disk.write(0, mbr))
+                return "Error: No se pudo escribir el MBR";
+            if(typeChar == 'E') EbrIndex::invalidate(path);
+            invalidateCaches(path);
+            return "OK: Partición '" + name + "' eliminada (" + (full ? "full" : "fast") + ")";
         }
 
-        // Filtrar espacios que caben
-        std::vector<std::pair<int,int>> candidates;
-        for(const auto& fs : freeSpaces) {
-            if(fs.second >= neededSize) candidates.push_back(fs);
+        // Lógica: se desenlaza su EBR
+        std::shared_ptr<EbrChain> chain = EbrIndex::get(disk, path, mbr);
+        long long pos;
+        const EBR* found = chain ? chain->find(name, pos) : nullptr;
+        if(!found) return "Error: No se encontró la partición: " + name;
+
+        // En full se limpia también el EBR, salvo el primero (sigue en uso)
+        long long zeroStart = (pos == chain->start()) ? found->part_start : pos;
+        long long zeroEnd   = found->part_start + (long long)found->part_s;
+        if(!chain->remove(disk, pos)) {
+            EbrIndex::invalidate(path);
+            return "Error: No se pudo actualizar la lista de EBRs";
         }
-        if(candidates.empty()) return -1;
-
-        if(fit == 'F') {
-            // First Fit: el primero que cabe
-            return candidates[0].first;
-        } else if(fit == 'B') {
-            // Best Fit: el más pequeño que cabe
-            auto best = candidates[0];
-            for(const auto& c : candidates)
-                if(c.second < best.second) best = c;
-            return best.first;
+        if(full && !disk.zero(zeroStart, zeroEnd - zeroStart))
+            return "Error: No se pudo poner en cero la partición";
+        invalidateCaches(path);
+        return "OK: Partición lógica '" + name + "' eliminada (" + (full ? "full" : "fast") + ")";
+    }
+
+    // -----------------------------------------------
+    // Agregar (delta > 0) o quitar (delta < 0) espacio al final de la
+    // partición. Crecer solo usa espacio libre contiguo (los huecos de
+    // FreeExtents); nada se mueve ni se reescribe fuera de MBR/EBR.
+    // -----------------------------------------------
+    static std::string resizePartition(Disk& disk, MBR& mbr, const std::string& path,
+                                       const std::string& name, long long delta) {
+        if(isMounted(path, name))
+            return "Error: La partición '" + name + "' está montada; desmóntala primero";
+
+        long long newSize;
+        int slot = findSlot(mbr, name);
+        if(slot != -1) {
+            Partition& part = mbr.mbr_partitions[slot];
+            if(!addOffset(part.part_s, delta, newSize) || newSize <= 0)
+                return "Error: La partición quedaría sin espacio (tamaño actual: " +
+                       std::to_string(part.part_s) + " bytes)";
+            long long end;
+            if(!addOffset(part.part_start, part.part_s, end) ||
+               (delta > 0 && !mbrFreeSpace(mbr).reserve(end, delta)))
+                return "Error: No hay espacio libre suficiente después de la partición";
+
+            // La extendida no puede dejar lógicas fuera
+            std::shared_ptr<EbrChain> chain;
+            if(part.part_type == 'E') {
+                chain = EbrIndex::get(disk, path, mbr);
+                if(!chain->setEnd(part.part_start + newSize))
+                    return "Error: Hay particiones lógicas en el espacio que se quitaría";
+            }
+            part.part_s = newSize;
+            if(!disk.write(0, mbr)) {
+                EbrIndex::invalidate(path);
+                return "Error: No se pudo escribir el MBR";
+            }
         } else {
-            // Worst Fit: el más grande
-            auto worst = candidates[0];
-            for(const auto& c : candidates)
-                if(c.second > worst.second) worst = c;
-            return worst.first;
+            std::shared_ptr<EbrChain> chain = EbrIndex::get(disk, path, mbr);
+            long long pos;
+            const EBR* found = chain ? chain->find(name, pos) : nullptr;
+            if(!found) return "Error: No se encontró la partición: " + name;
+            if(!addOffset(found->part_s, delta, newSize) || newSize <= 0)
+                return "Error: La partición quedaría sin espacio (tamaño actual: " +
+                       std::to_string(found->part_s) + " bytes)";
+            if(!chain->resize(disk, pos, newSize))
+                return "Error: No hay espacio libre suficiente después de la partición";
         }
+
+        invalidateCaches(path);
+        return "OK: Partición '" + name + "' redimensionada | Tamaño: " +
+               std::to_string(newSize) + " bytes";
     }
 };
 
-#endif // FDISK_H
\ No newline at end of file
+#endif // FDISK_H
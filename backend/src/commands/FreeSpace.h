@@ -0,0 +1,79 @@
+#ifndef FREESPACE_H
+#define FREESPACE_H
+
+#include <string>
+#include <memory>
+#include <cstdio>
+#include "../structs/Structs.h"
+#include "../utils/Utils.h"
+#include "../utils/CommandParser.h"
+#include "../utils/DiskLocks.h"
+#include "../utils/DiskManager.h"
+#include "../utils/FreeExtents.h"
+#include "../utils/EbrIndex.h"
+
+// Huecos que se listan por nivel (el resto solo se cuenta)
+#define FREESPACE_MAX_LISTED 32
+
+// =============================================
+// FREESPACE - Reporte de espacio libre y fragmentación
+// freespace -path=/a.mia
+// Por nivel (disco según el MBR y, si existe, la extendida según sus
+// EBR): cantidad de huecos, bytes libres, hueco mayor y fragmentación
+// externa (1 - mayor/libre), más la lista de huecos.
+// =============================================
+class FreeSpace {
+public:
+    static std::string execute(const CommandLine& cmd) {
+        std::string path = "";
+
+        for(const Param& p : cmd) {
+            if(p.is("path")) path = p.value;
+            else return unknownParam(p);
+        }
+
+        if(path.empty()) return "Error: -path es obligatorio";
+
+        // Candados, discos abiertos y cachés van por la ruta canónica
+        path = canonicalPath(path);
+
+        auto diskLock = DiskLocks::exclusive(path);
+        std::shared_ptr<Disk> disk = DiskManager::get(path);
+        if(!disk) return "Error: No se pudo abrir el disco: " + path;
+
+        MBR mbr;
+        if(!disk->read(0, mbr)) return "Error: No se pudo leer el MBR de: " + path;
+        std::string formatError = mbrFormatError(mbr, path);
+        if(!formatError.empty()) return formatError;
+
+        std::string result = "Espacio libre en " + path + "\n";
+        result += level("Disco (MBR)", mbrFreeSpace(mbr));
+
+        std::shared_ptr<EbrChain> chain = EbrIndex::get(*disk, path, mbr);
+        if(chain)
+            result += level("Extendida (" + std::to_string(chain->count()) + " lógicas)",
+                            chain->freeSpace());
+        return result;
+    }
+
+private:
+    static std::string level(const std::string& title, const FreeExtents& free) {
+        char pct[32];
+        snprintf(pct, sizeof(pct), "%.2f%%", free.fragmentation() * 100.0);
+        std::string out = "--------------------------------\n" + title + ": " +
+                          std::to_string(free.count()) + " huecos | Libre: " +
+                          std::to_string(free.total()) + " bytes | Mayor: " +
+                          std::to_string(free.largest()) + " bytes | Fragmentación: " + pct + "\n";
+
+        size_t listed = 0;
+        free.forEach([&](long long start, long long len) {
+            if(listed++ < FREESPACE_MAX_LISTED)
+                out += "  Inicio: " + std::to_string(start) + " | Tamaño: " + std::to_string(len) + "\n";
+        });
+        if(listed > FREESPACE_MAX_LISTED)
+            out += "  ... (" + std::to_string(listed - FREESPACE_MAX_LISTED) + " huecos más)\n";
+        return out;
+    }
+};
+
+#endif // FREESPACE_H
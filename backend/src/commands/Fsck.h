@@ -0,0 +1,482 @@
+#ifndef FSCK_H
+#define FSCK_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <unordered_set>
+#include "../structs/Structs.h"
+#include "../utils/Utils.h"
+#include "../utils/CommandParser.h"
+#include "../utils/MountedPartitions.h"
+#include "../utils/DiskLocks.h"
+#include "../utils/DiskManager.h"
+#include "../utils/DiskView.h"
+#include "../utils/Bitmap.h"
+#include "../utils/InodeBlocks.h"
+#include "../utils/PathResolver.h"
+#include "../utils/UsersTable.h"
+#include "../utils/ThreadPool.h"
+
+// Inconsistencias que se listan en la respuesta (el resto solo se cuenta)
+#define FSCK_MAX_LISTED 50
+
+// Bytes de bitmap que lee cada hilo por vez (múltiplo de 64)
+#define FSCK_BITMAP_CHUNK (1024 * 1024)
+
+// =============================================
+// FSCK - Verifica (y opcionalmente repara) el EXT2 de una partición
+// fsck -id=111A           -> solo revisa (candado compartido)
+// fsck -id=111A -repair   -> además corrige (candado exclusivo)
+//
+// 1. Recorre el árbol desde el inodo 0 por niveles: los inodos de un
+//    nivel se reparten entre hilos (cada uno con su PartitionView) y
+//    se arman los conjuntos de inodos y bloques alcanzables, incluidos
+//    los bloques de apuntadores.
+// 2. Compara esos conjuntos con los dos bitmaps del disco de a 64 bits;
+//    cada hilo lee su tramo de bitmap directo del archivo.
+// 3. Compara los contadores y primeros libres del superbloque.
+// Reparar reescribe solo las palabras de bitmap que difieren, el
+// superbloque y las entradas/apuntadores inválidos (se vacían).
+// =============================================
+class Fsck {
+public:
+    static std::string execute(const CommandLine& cmd) {
+        std::string id     = "";
+        bool        repair = false;
+
+        for(const Param& p : cmd) {
+            if(p.is("id")) id = p.value;
+            else if(p.is("repair")) {
+                if(!p.value.empty()) return "Error: -repair no lleva valor";
+                repair = true;
+            }
+            else return unknownParam(p);
+        }
+
+        if(id.empty()) return "Error: -id es obligatorio";
+
+        MountedPartition mp;
+        if(!MountedPartitions::findById(id, mp))
+            return "Error: No existe partición montada con ID: " + id;
+
+        if(repair) {
+            auto diskLock = DiskLocks::exclusive(mp.path);
+            return check(mp, true);
+        }
+        auto diskLock = DiskLocks::shared(mp.path);
+        return check(mp, false);
+    }
+
+private:
+    // Entrada de carpeta que lleva a un inodo (block = -1 para la raíz)
+    struct Visit { int inode, parent, block, slot; };
+
+    // Dónde está un apuntador: i_block[slot] del inodo si holder = -1,
+    // si no la casilla 'slot' del bloque de apuntadores 'holder'
+    struct Ref { int inode, holder, slot; };
+
+    struct Use { int block; Ref ref; bool pointer; };
+
+    // Entrada de carpeta a corregir: apuntar a 'inode' o vaciarla (-1)
+    struct EntryFix { int block, slot, inode; };
+
+    struct Problems {
+        size_t                   count = 0;
+        std::vector<std::string> listed;
+
+        void add(const std::string& msg) {
+            if(listed.size() < FSCK_MAX_LISTED) listed.push_back(msg);
+            count++;
+        }
+        void merge(const Problems& other) {
+            for(const std::string& msg : other.listed)
+                if(listed.size() < FSCK_MAX_LISTED) listed.push_back(msg);
+            count += other.count;
+        }
+    };
+
+    // Lo que un hilo encontró en su tramo de un nivel
+    struct Scan {
+        std::vector<Use>                 uses;
+        std::vector<Visit>               children;
+        std::vector<Visit>               invalid;
+        std::vector<Ref>                 badRefs;
+        std::vector<EntryFix>            entryFixes;
+        std::vector<std::pair<int, int>> sizeFixes;   // (inodo, tamaño)
+        Problems                         problems;
+    };
+
+    // Diferencias de un tramo de bitmap
+    struct Diff {
+        size_t              leaked = 0;    // marcado en disco, nadie lo usa
+        size_t              missing = 0;   // en uso pero libre en el disco
+        std::vector<size_t> words;         // palabras que hay que reescribir
+        Problems            problems;
+    };
+
+    // Todo lo que se corrige al final con -repair
+    struct Fixes {
+        std::vector<Ref>                 badRefs;
+        std::vector<EntryFix>            entryFixes;
+        std::vector<std::pair<int, int>> sizeFixes;
+    };
+
+    static std::string check(const MountedPartition& mp, bool repair) {
+        std::shared_ptr<Disk> disk = DiskManager::get(mp.path);
+        if(!disk) return "Error: No se pudo abrir el disco: " + mp.path;
+
+        auto t0 = std::chrono::steady_clock::now();
+        PartitionView fs(*disk, mp.start, mp.size);
+        if(!fs.load()) return "Error: La partición no tiene un sistema EXT2: " + mp.id;
+        SuperBloque sb = fs.sb();
+        std::string layout = checkLayout(sb, mp);
+        if(!layout.empty()) return "Error: Superbloque dañado en " + mp.id + ": " + layout;
+
+        // Los hilos leen el archivo directo: lo sucio del caché va primero
+        if(!disk->flush()) return "Error: No se pudo escribir el caché del disco: " + mp.path;
+
+        // -----------------------------------------------
+        // 1. Recorrido desde la raíz
+        // -----------------------------------------------
+        Problems problems;
+        Fixes    fixes;
+        Bitmap   reachInodes(sb.s_inodes_count);
+        Bitmap   reachBlocks(sb.s_blocks_count);
+        size_t   threads = 1;
+
+        const Inode& root = fs.inode(0);
+        if(root.i_type != '0') return "Error: El inodo raíz no es una carpeta en " + mp.id;
+
+        std::vector<Visit> level = {{0, 0, -1, -1}};
+        reachInodes.set(0);
+        while(!level.empty()) {
+            std::vector<Scan> scans(scanThreads());
+            size_t parts = parallelFor(level.size(), 256, [&](size_t t, size_t from, size_t to) {
+                PartitionView view(*disk, mp.start, mp.size);
+                view.load();
+                for(size_t i = from; i < to; i++) scanInode(view, level[i], scans[t]);
+            });
+            threads = std::max(threads, parts);
+
+            scans.resize(parts);
+            std::vector<Visit> next;
+            mergeScans(scans, reachInodes, reachBlocks, next, problems, fixes);
+            level.swap(next);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+
+        // -----------------------------------------------
+        // 2. Bitmaps del disco contra lo alcanzable
+        // -----------------------------------------------
+        Diff inodeDiff, blockDiff;
+        if(!compareBitmap(*disk, sb.s_bm_inode_start, reachInodes, "inodo", inodeDiff, threads) ||
+           !compareBitmap(*disk, sb.s_bm_block_start, reachBlocks, "bloque", blockDiff, threads))
+            return "Error: No se pudieron leer los bitmaps de " + mp.id;
+        problems.merge(inodeDiff.problems);
+        problems.merge(blockDiff.problems);
+        auto t2 = std::chrono::steady_clock::now();
+
+        // -----------------------------------------------
+        // 3. Superbloque
+        // -----------------------------------------------
+        auto bm = std::make_shared<PartitionBitmaps>();
+        bm->inodes = std::move(reachInodes);
+        bm->blocks = std::move(reachBlocks);
+        SuperBloque expected = sb;
+        BitmapAllocator::syncSuperblock(expected, *bm);
+        checkCounter(problems, "s_free_inodes_count", sb.s_free_inodes_count, expected.s_free_inodes_count);
+        checkCounter(problems, "s_free_blocks_count", sb.s_free_blocks_count, expected.s_free_blocks_count);
+        checkCounter(problems, "s_firts_ino", sb.s_firts_ino, expected.s_firts_ino);
+        checkCounter(problems, "s_first_blo", sb.s_first_blo, expected.s_first_blo);
+
+        bool repaired = false;
+        if(repair && problems.count > 0) {
+            if(!applyFixes(*disk, sb, fixes, *bm, inodeDiff, blockDiff) ||
+               !disk->write(mp.start, expected))
+                return "Error: No se pudo reparar el sistema de archivos de " + mp.id;
+            BitmapCache::invalidate(mp.path);
+            DentryCache::invalidate(mp.path);
+            UsersCache::invalidate(mp.path);
+            BitmapCache::put(mp.path, mp.start, bm);
+            repaired = true;
+        }
+        auto t3 = std::chrono::steady_clock::now();
+
+        char summary[256];
+        std::snprintf(summary, sizeof(summary),
+                      "  Inodos usados: %zu de %d | Bloques usados: %zu de %d\n"
+                      "  Hilos: %zu | Tiempos (ms): recorrido %.3f | bitmaps %.3f | total %.3f",
+                      bm->inodes.size() - bm->inodes.freeCount(), sb.s_inodes_count,
+                      bm->blocks.size() - bm->blocks.freeCount(), sb.s_blocks_count,
+                      threads,
+                      std::chrono::duration<double, std::milli>(t1 - t0).count(),
+                      std::chrono::duration<double, std::milli>(t2 - t1).count(),
+                      std::chrono::duration<double, std::milli>(t3 - t0).count());
+
+        if(problems.count == 0)
+            return "OK: Sistema de archivos consistente en " + mp.id + "\n" + summary;
+
+        std::string out = repaired
+            ? "OK: " + std::to_string(problems.count) + " inconsistencias corregidas en " + mp.id + "\n"
+            : "Error: " + std::to_string(problems.count) + " inconsistencias en " + mp.id +
+              " (fsck -repair las corrige)\n";
+        for(const std::string& msg : problems.listed) out += "  - " + msg + "\n";
+        if(problems.count > problems.listed.size())
+            out += "  ... y " + std::to_string(problems.count - problems.listed.size()) + " más\n";
+        return out + summary;
+    }
+
+    // -----------------------------------------------
+    // Superbloque: regiones en orden y dentro de la partición
+    // -----------------------------------------------
+    static std::string checkLayout(const SuperBloque& sb, const MountedPartition& mp) {
+        if(sb.s_inodes_count <= 0 || sb.s_blocks_count <= 0) return "cantidades inválidas";
+        if(sb.s_inode_s != (int)sizeof(Inode)) return "tamaño de inodo " + std::to_string(sb.s_inode_s);
+        if(!validBlockSize(sb.s_block_s)) return "tamaño de bloque " + std::to_string(sb.s_block_s);
+        long long end = (long long)mp.start + mp.size;
+        if(sb.s_bm_inode_start < mp.start + (long long)sizeof(SuperBloque) ||
+           sb.s_bm_block_start < (long long)sb.s_bm_inode_start + sb.s_inodes_count ||
+           sb.s_inode_start    < (long long)sb.s_bm_block_start + sb.s_blocks_count ||
+           sb.s_block_start    < sb.s_inode_start + (long long)sb.s_inodes_count * sb.s_inode_s ||
+           sb.s_block_start + (long long)sb.s_blocks_count * sb.s_block_s > end)
+            return "regiones fuera de orden o fuera de la partición";
+        return "";
+    }
+
+    // -----------------------------------------------
+    // Un inodo del recorrido (corre en un hilo con su propia vista)
+    // -----------------------------------------------
+    static void scanInode(PartitionView& fs, const Visit& v, Scan& out) {
+        Inode inode = fs.inode(v.inode);
+        if(inode.i_type != '0' && inode.i_type != '1') {
+            out.problems.add("inodo " + std::to_string(v.inode) + ": tipo inválido");
+            out.invalid.push_back(v);
+            return;
+        }
+        long long maxSize = InodeBlocks::maxBytes(fs);
+        if(inode.i_s < 0 || inode.i_s > maxSize) {
+            out.problems.add("inodo " + std::to_string(v.inode) + ": tamaño inválido (" +
+                             std::to_string(inode.i_s) + ")");
+            out.sizeFixes.push_back({v.inode, inode.i_s < 0 ? 0 : (int)maxSize});
+        }
+
+        std::vector<int> data;
+        for(int i = 0; i < 15; i++) {
+            if(inode.i_block[i] == -1) continue;
+            int level = (i < DIRECT_BLOCKS) ? 0 : i - DIRECT_BLOCKS + 1;
+            walkRef(fs, inode.i_block[i], level, {v.inode, -1, i}, out, data);
+        }
+        if(inode.i_type == '0')
+            for(int b : data) scanFolder(fs, v, b, out);
+    }
+
+    // Apuntador de nivel 'level' (0 = bloque de datos): valida el rango
+    // antes de leer, así un apuntador dañado no sale de la partición
+    static void walkRef(PartitionView& fs, int ptr, int level, Ref ref,
+                        Scan& out, std::vector<int>& data) {
+        if(ptr < 0 || ptr >= fs.sb().s_blocks_count) {
+            out.problems.add("inodo " + std::to_string(ref.inode) + ": apuntador fuera de rango (" +
+                             std::to_string(ptr) + ")");
+            out.badRefs.push_back(ref);
+            return;
+        }
+        out.uses.push_back({ptr, ref, level > 0});
+        if(level == 0) { data.push_back(ptr); return; }
+
+        // Copia: la recursión puede mover la ventana de la vista
+        const int32_t* w = fs.words(ptr);
+        std::vector<int32_t> pointers(w, w + fs.blockWords());
+        for(int i = 0; i < (int)pointers.size(); i++) {
+            if(pointers[i] == -1) continue;
+            walkRef(fs, pointers[i], level - 1, {ref.inode, ptr, i}, out, data);
+        }
+    }
+
+    static void scanFolder(PartitionView& fs, const Visit& v, int block, Scan& out) {
+        const Content* entries = fs.folder(block);
+        std::vector<Content> folder(entries, entries + fs.folderEntries());
+        int parent = (v.block < 0) ? v.inode : v.parent;
+        for(int k = 0; k < (int)folder.size(); k++) {
+            const Content& c = folder[k];
+            if(c.b_inodo == -1) continue;
+            std::string name(c.b_name, strnlen(c.b_name, sizeof(c.b_name)));
+            std::string where = "carpeta " + std::to_string(v.inode) + ", entrada '" + name + "'";
+
+            if(name == "." || name == "..") {
+                int want = (name == ".") ? v.inode : parent;
+                if(c.b_inodo != want) {
+                    out.problems.add(where + " apunta a " + std::to_string(c.b_inodo) +
+                                     " en vez de " + std::to_string(want));
+                    out.entryFixes.push_back({block, k, want});
+                }
+                continue;
+            }
+            if(name.empty() || c.b_inodo < 0 || c.b_inodo >= fs.sb().s_inodes_count) {
+                out.problems.add(where + ": inodo inválido (" + std::to_string(c.b_inodo) + ")");
+                out.entryFixes.push_back({block, k, -1});
+                continue;
+            }
+            out.children.push_back({c.b_inodo, v.inode, block, k});
+        }
+    }
+
+    // -----------------------------------------------
+    // Une lo de los hilos a los conjuntos, tramo por tramo en orden, así
+    // el resultado no depende de cuántos hilos hubo: el primero que usa
+    // un bloque o enlaza un inodo se queda con él, los demás son
+    // inconsistencias
+    // -----------------------------------------------
+    static void mergeScans(const std::vector<Scan>& scans, Bitmap& reachInodes, Bitmap& reachBlocks,
+                           std::vector<Visit>& next, Problems& problems, Fixes& fixes) {
+        for(const Scan& scan : scans) {
+            problems.merge(scan.problems);
+            fixes.badRefs.insert(fixes.badRefs.end(), scan.badRefs.begin(), scan.badRefs.end());
+            fixes.entryFixes.insert(fixes.entryFixes.end(), scan.entryFixes.begin(), scan.entryFixes.end());
+            fixes.sizeFixes.insert(fixes.sizeFixes.end(), scan.sizeFixes.begin(), scan.sizeFixes.end());
+            for(const Visit& bad : scan.invalid) {
+                reachInodes.clear(bad.inode);
+                if(bad.block >= 0) fixes.entryFixes.push_back({bad.block, bad.slot, -1});
+            }
+        }
+
+        // Lo que cuelga de un bloque de apuntadores repetido ya se contó
+        // con su primer dueño
+        std::unordered_set<int> dropped;
+        for(const Scan& scan : scans) {
+            for(const Use& use : scan.uses) {
+                if(use.ref.holder != -1 && dropped.count(use.ref.holder)) {
+                    if(use.pointer) dropped.insert(use.block);
+                    continue;
+                }
+                if(reachBlocks.test(use.block)) {
+                    problems.add("bloque " + std::to_string(use.block) + " usado otra vez por el inodo " +
+                                 std::to_string(use.ref.inode));
+                    fixes.badRefs.push_back(use.ref);
+                    if(use.pointer) dropped.insert(use.block);
+                    continue;
+                }
+                reachBlocks.set(use.block);
+            }
+        }
+
+        for(const Scan& scan : scans) {
+            for(const Visit& child : scan.children) {
+                if(reachInodes.test(child.inode)) {
+                    problems.add("inodo " + std::to_string(child.inode) + " enlazado otra vez desde la carpeta " +
+                                 std::to_string(child.parent));
+                    fixes.entryFixes.push_back({child.block, child.slot, -1});
+                    continue;
+                }
+                reachInodes.set(child.inode);
+                next.push_back(child);
+            }
+        }
+    }
+
+    // -----------------------------------------------
+    // Bitmap ASCII del disco contra 'reach', de a 64 elementos. Cada
+    // hilo lee su tramo directo del archivo (ya sin el caché de páginas)
+    // -----------------------------------------------
+    static bool compareBitmap(Disk& disk, long long start, const Bitmap& reach,
+                              const char* what, Diff& total, size_t& threads) {
+        std::vector<Diff> diffs(scanThreads());
+        std::vector<char> ok(diffs.size(), 1);
+        size_t parts = parallelFor(reach.size(), 1 << 20, [&](size_t t, size_t from, size_t to) {
+            std::vector<char> buf(std::min<size_t>(FSCK_BITMAP_CHUNK, to - from));
+            for(size_t pos = from; pos < to; pos += buf.size()) {
+                size_t n = std::min(buf.size(), to - pos);
+                if(!disk.readDirect(start + (long long)pos, buf.data(), n)) { ok[t] = 0; return; }
+                Bitmap onDisk = Bitmap::fromAscii(buf.data(), n);
+                for(size_t w = 0; w < onDisk.wordCount(); w++) {
+                    uint64_t want = reach.word(pos / 64 + w);
+                    uint64_t have = onDisk.word(w);
+                    if(want == have) continue;
+                    diffs[t].words.push_back(pos / 64 + w);
+                    countBits(diffs[t], have & ~want, pos + w * 64, what, "marcado pero sin usar", diffs[t].leaked);
+                    countBits(diffs[t], want & ~have, pos + w * 64, what, "en uso pero libre en el bitmap", diffs[t].missing);
+                }
+            }
+        }, 64);
+        threads = std::max(threads, parts);
+
+        for(size_t t = 0; t < parts; t++) {
+            if(!ok[t]) return false;
+            total.leaked  += diffs[t].leaked;
+            total.missing += diffs[t].missing;
+            total.words.insert(total.words.end(), diffs[t].words.begin(), diffs[t].words.end());
+            total.problems.merge(diffs[t].problems);
+        }
+        return true;
+    }
+
+    static void countBits(Diff& diff, uint64_t bits, size_t base, const char* what,
+                          const char* msg, size_t& counter) {
+        while(bits != 0) {
+            size_t i = base + __builtin_ctzll(bits);
+            diff.problems.add(std::string(what) + " " + std::to_string(i) + " " + msg);
+            counter++;
+            bits &= bits - 1;
+        }
+    }
+
+    static void checkCounter(Problems& problems, const char* field, int have, int want) {
+        if(have != want)
+            problems.add(std::string("superbloque: ") + field + " = " + std::to_string(have) +
+                         ", debería ser " + std::to_string(want));
+    }
+
+    // -----------------------------------------------
+    // Reparación: entradas, apuntadores y tamaños; después solo las
+    // palabras de bitmap que difieren (el superbloque lo escribe check)
+    // -----------------------------------------------
+    static bool applyFixes(Disk& disk, const SuperBloque& sb, const Fixes& fixes,
+                           const PartitionBitmaps& bm, const Diff& inodeDiff, const Diff& blockDiff) {
+        auto blockPos = [&](int b) { return sb.s_block_start + (long long)b * sb.s_block_s; };
+        auto inodePos = [&](int n) { return sb.s_inode_start + (long long)n * sb.s_inode_s; };
+        const int none = -1;
+
+        for(const EntryFix& fix : fixes.entryFixes) {
+            long long pos = blockPos(fix.block) + (long long)fix.slot * sizeof(Content);
+            Content c;
+            if(fix.inode != -1 && !disk.read(pos, c)) return false;
+            c.b_inodo = fix.inode;
+            if(!disk.write(pos, c)) return false;
+        }
+        for(const Ref& ref : fixes.badRefs) {
+            long long pos = (ref.holder == -1)
+                ? inodePos(ref.inode) + (long long)offsetof(Inode, i_block) + ref.slot * sizeof(int)
+                : blockPos(ref.holder) + (long long)ref.slot * sizeof(int);
+            if(!disk.write(pos, none)) return false;
+        }
+        for(const auto& fix : fixes.sizeFixes) {
+            if(!disk.write(inodePos(fix.first) + (long long)offsetof(Inode, i_s), fix.second)) return false;
+        }
+        return writeWords(disk, sb.s_bm_inode_start, bm.inodes, inodeDiff.words) &&
+               writeWords(disk, sb.s_bm_block_start, bm.blocks, blockDiff.words);
+    }
+
+    // Reescribe en ASCII las palabras indicadas (en orden), juntando las
+    // consecutivas en una sola escritura
+    static bool writeWords(Disk& disk, long long start, const Bitmap& map,
+                           const std::vector<size_t>& words) {
+        std::vector<char> ascii;
+        for(size_t i = 0; i < words.size();) {
+            size_t j = i + 1;
+            while(j < words.size() && words[j] == words[j - 1] + 1) j++;
+            size_t from = words[i] * 64;
+            size_t n    = std::min(map.size(), words[j - 1] * 64 + 64) - from;
+            ascii.resize(n);
+            map.toAscii(ascii.data(), from, n);
+            if(!disk.write(start + (long long)from, ascii.data(), n)) return false;
+            i = j;
+        }
+        return true;
+    }
+};
+
+#endif // FSCK_H
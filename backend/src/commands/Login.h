@@ -3,163 +3,113 @@
 
 #include <string>
 #include <vector>
-#include <fstream>
-#include <sstream>
+#include <memory>
+#include <cstring>
 #include "../structs/Structs.h"
 #include "../utils/Utils.h"
+#include "../utils/CommandParser.h"
 #include "../utils/MountedPartitions.h"
 #include "../utils/Session.h"
+#include "../utils/DiskLocks.h"
+#include "../utils/DiskManager.h"
+#include "../utils/DiskView.h"
+#include "../utils/PathResolver.h"
+#include "../utils/FileIO.h"
+#include "../utils/UsersTable.h"
 
 class Login {
 public:
-    static std::string execute(
-        const std::vector<std::pair<std::string,std::string>>& params)
-    {
+    // Con éxito deja en ctx el token de la nueva sesión
+    static std::string execute(const CommandLine& cmd, SessionContext& ctx) {
         std::string user = "";
         std::string pass = "";
         std::string id   = "";
 
-        for(const auto& p : params) {
-            std::string key = toLower(p.first);
+        for(const Param& p : cmd) {
             // user y pass distinguen mayúsculas
-            if(key == "user")      user = p.second;
-            else if(key == "pass") pass = p.second;
-            else if(key == "id")   id   = p.second;
-            else return "Error: Parámetro no reconocido -> " + p.first;
+            if(p.is("user"))      user = p.value;
+            else if(p.is("pass")) pass = p.value;
+            else if(p.is("id"))   id   = p.value;
+            else return unknownParam(p);
         }
 
         if(user.empty()) return "Error: -user es obligatorio";
         if(pass.empty()) return "Error: -pass es obligatorio";
         if(id.empty())   return "Error: -id es obligatorio";
 
-        // Verificar que no haya sesión activa
-        if(currentSession.active)
+        // Verificar que este cliente no tenga ya una sesión activa
+        Session current;
+        if(SessionTable::find(ctx.token, current))
             return "Error: Ya hay una sesión activa. Ejecute logout primero";
 
         // Buscar partición montada
-        MountedPartition* mp = MountedPartitions::findById(id);
-        if(mp == nullptr)
+        MountedPartition mp;
+        if(!MountedPartitions::findById(id, mp))
             return "Error: No existe partición montada con ID: " + id;
 
-        // Leer users.txt desde el disco
-        std::string usersContent = readUsersFile(mp);
-        if(usersContent.empty())
+        // users.txt ya interpretado (se lee del disco solo la primera vez)
+        std::shared_ptr<const UsersTable> table = loadUsers(mp);
+        if(!table)
             return "Error: No se pudo leer users.txt";
 
-        // Buscar usuario en users.txt
-        // Formato línea usuario: UID,U,grupo,usuario,contraseña
-        std::istringstream ss(usersContent);
-        std::string line;
-        bool found = false;
-        int  foundUID = -1;
-        int  foundGID = -1;
-
-        while(std::getline(ss, line)) {
-            if(line.empty()) continue;
-            std::vector<std::string> parts = splitCSV(line);
-            if(parts.size() < 5) continue;
-            if(trim(parts[1]) != "U") continue;
-
-            std::string fileUser = trim(parts[3]);
-            std::string filePass = trim(parts[4]);
-            std::string statusStr= trim(parts[0]);
-
-            // Verificar que no esté eliminado (id != 0)
-            if(statusStr == "0") continue;
-
-            // Comparar usuario y contraseña (case sensitive)
-            if(fileUser == user && filePass == pass) {
-                found    = true;
-                foundUID = std::stoi(statusStr);
-                // Buscar GID del grupo
-                foundGID = getGID(usersContent, trim(parts[2]));
-                break;
-            }
-        }
-
-        if(!found)
+        // Comparar usuario y contraseña (case sensitive)
+        auto it = table->users.find(user);
+        if(it == table->users.end() || it->second.pass != pass)
             return "Error: Usuario o contraseña incorrectos";
-
-        // Iniciar sesión
-        currentSession.active   = true;
-        currentSession.username = user;
-        currentSession.id       = id;
-        currentSession.uid      = foundUID;
-        currentSession.gid      = foundGID;
+        int foundUID = it->second.uid;
+        int foundGID = it->second.gid;
+
+        // Iniciar sesión (cada cliente tiene la suya)
+        Session session;
+        session.username = user;
+        session.id       = id;
+        session.uid      = foundUID;
+        session.gid      = foundGID;
+        std::string token = SessionTable::create(std::move(session));
+        if(token.empty())
+            return "Error: No se pudo generar el token de sesión";
+        ctx.token   = token;
+        ctx.changed = true;
 
         return "OK: Sesión iniciada como '" + user + "' en partición " + id;
     }
 
 private:
-    static std::string readUsersFile(MountedPartition* mp) {
-        std::fstream disk(mp->path, std::ios::binary | std::ios::in);
-        if(!disk.is_open()) return "";
-
-        // Leer SuperBloque
-        SuperBloque sb;
-        disk.seekg(mp->start, std::ios::beg);
-        disk.read(reinterpret_cast<char*>(&sb), sizeof(SuperBloque));
-
-        // Leer inodo 0 (raíz)
-        Inode rootInode;
-        disk.seekg(sb.s_inode_start, std::ios::beg);
-        disk.read(reinterpret_cast<char*>(&rootInode), sizeof(Inode));
-
-        // Leer bloque carpeta raíz
-        FolderBlock rootBlock;
-        disk.seekg(sb.s_block_start, std::ios::beg);
-        disk.read(reinterpret_cast<char*>(&rootBlock), sizeof(FolderBlock));
-
-        // Buscar users.txt en la raíz
-        int usersInodeNum = -1;
-        for(int i = 0; i < 4; i++) {
-            if(std::string(rootBlock.b_content[i].b_name) == "users.txt") {
-                usersInodeNum = rootBlock.b_content[i].b_inodo;
-                break;
-            }
-        }
-        if(usersInodeNum == -1) { disk.close(); return ""; }
-
-        // Leer inodo de users.txt
-        Inode usersInode;
-        disk.seekg(sb.s_inode_start + usersInodeNum * sizeof(Inode), std::ios::beg);
-        disk.read(reinterpret_cast<char*>(&usersInode), sizeof(Inode));
-
-        // Leer bloques de contenido
-        std::string content = "";
-        for(int i = 0; i < 12; i++) {
-            if(usersInode.i_block[i] == -1) break;
-            FileBlock fb;
-            disk.seekg(sb.s_block_start + usersInode.i_block[i] * 64, std::ios::beg);
-            disk.read(reinterpret_cast<char*>(&fb), sizeof(FileBlock));
-            content += std::string(fb.b_content, 64);
-        }
+    // Tabla de usuarios de la partición: del caché o leyendo users.txt
+    static std::shared_ptr<const UsersTable> loadUsers(const MountedPartition& mp) {
+        std::shared_ptr<const UsersTable> table = UsersCache::find(mp.path, mp.start);
+        if(table) return table;
+
+        uint64_t gen = UsersCache::generation();
+        std::string content = readUsersFile(mp);
+        if(content.empty()) return nullptr;
+        table = UsersTable::parse(content);
+        UsersCache::put(mp.path, mp.start, table, gen);
+        return table;
+    }
+
+    static std::string readUsersFile(const MountedPartition& mp) {
+        auto diskLock = DiskLocks::shared(mp.path);
+        std::shared_ptr<Disk> disk = DiskManager::get(mp.path);
+        if(!disk) return "";
+
+        // Con el backend mmap estas referencias apuntan directo a la imagen
+        PartitionView fs(*disk, mp.start, mp.size);
+        if(!fs.load()) return "";
+
+        // Buscar /users.txt (con el caché de entradas de carpeta)
+        PathResolver resolver(fs, mp.path, mp.start);
+        int usersInodeNum = resolver.resolve("/users.txt");
+        if(usersInodeNum == -1) return "";
+
+        // Contenido completo (i_s bytes), en una lectura por racha de bloques
+        std::string content;
+        if(!FileIO::read(fs, fs.inode(usersInodeNum), content)) return "";
 
-        disk.close();
         // Limpiar nulls del final
         content.erase(content.find_last_not_of('\0') + 1);
         return content;
     }
-
-    static std::vector<std::string> splitCSV(const std::string& line) {
-        std::vector<std::string> result;
-        std::stringstream ss(line);
-        std::string token;
-        while(std::getline(ss, token, ',')) result.push_back(token);
-        return result;
-    }
-
-    static int getGID(const std::string& content, const std::string& groupName) {
-        std::istringstream ss(content);
-        std::string line;
-        while(std::getline(ss, line)) {
-            auto parts = splitCSV(line);
-            if(parts.size() < 3) continue;
-            if(trim(parts[1]) == "G" && trim(parts[2]) == groupName)
-                return std::stoi(trim(parts[0]));
-        }
-        return -1;
-    }
 };
 
 // =============================================
@@ -167,12 +117,15 @@ private:
 // =============================================
 class Logout {
 public:
-    static std::string execute() {
-        if(!currentSession.active)
+    static std::string execute(SessionContext& ctx) {
+        Session current;
+        if(!SessionTable::find(ctx.token, current))
             return "Error: No hay sesión activa";
 
-        std::string user = currentSession.username;
-        currentSession.clear();
+        SessionTable::remove(ctx.token);
+        ctx.token.clear();
+        ctx.changed = true;
+        std::string user = current.username;
         return "OK: Sesión cerrada para usuario '" + user + "'";
     }
 };
@@ -2,40 +2,57 @@
 #define MKDISK_H
 
 #include <string>
-#include <fstream>
 #include <iostream>
 #include <cstring>
 #include <cstdlib>
 #include <ctime>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include "../structs/Structs.h"
 #include "../utils/Utils.h"
+#include "../utils/CommandParser.h"
+#include "../utils/DiskLocks.h"
+#include "../utils/DiskManager.h"
+#include "../utils/PathResolver.h"
+#include "../utils/UsersTable.h"
+#include "../utils/EbrIndex.h"
+#include "../utils/Bitmap.h"
+
+// Tamaño (y alineación) del buffer para el modo zero
+#define ZERO_CHUNK (1024 * 1024)
 
 class MkDisk {
 public:
-    static std::string execute(const std::vector<std::pair<std::string,std::string>>& params) {
+    enum class Mode { ZERO, SPARSE, PREALLOC };
+
+    static std::string execute(const CommandLine& cmd) {
         // Valores por defecto
         int         size = -1;
-        std::string fit  = "ff";  // First Fit por defecto
-        std::string unit = "m";   // Megabytes por defecto
+        Fit         fit  = Fit::FF;     // First Fit por defecto
+        Unit        unit = Unit::M;     // Megabytes por defecto
         std::string path = "";
+        Mode        mode = Mode::ZERO;
 
         // Leer parámetros
-        for(const auto& p : params) {
-            std::string key = toLower(p.first);
-            std::string val = p.second;
-
-            if(key == "size") {
-                size = std::stoi(val);
-            } else if(key == "fit") {
-                fit = toLower(val);
-            } else if(key == "unit") {
-                unit = toLower(val);
-            } else if(key == "path") {
-                path = val;
+        for(const Param& p : cmd) {
+            if(p.is("size")) {
+                if(!parseInt(p.value, size)) return invalidValue(p);
+            } else if(p.is("fit")) {
+                if(!parseEnum(p.value, FIT_NAMES, fit))
+                    return "Error: -fit debe ser BF, FF o WF";
+            } else if(p.is("unit")) {
+                if(!parseEnum(p.value, UNIT_NAMES, unit) || unit == Unit::B)
+                    return "Error: -unit debe ser K o M";
+            } else if(p.is("path")) {
+                path = p.value;
+            } else if(p.is("mode")) {
+                if(!parseEnum(p.value, MODE_NAMES, mode))
+                    return "Error: -mode debe ser ZERO, SPARSE o PREALLOC";
             } else {
-                return "Error: Parámetro no reconocido -> " + p.first;
+                return unknownParam(p);
             }
         }
 
@@ -46,20 +63,9 @@ public:
         if(path.empty()) {
             return "Error: El parámetro -path es obligatorio";
         }
-        if(fit != "bf" && fit != "ff" && fit != "wf") {
-            return "Error: -fit debe ser BF, FF o WF";
-        }
-        if(unit != "k" && unit != "m") {
-            return "Error: -unit debe ser K o M";
-        }
 
         // Calcular tamaño en bytes
-        long long sizeBytes;
-        if(unit == "k") {
-            sizeBytes = (long long)size * 1024;
-        } else {
-            sizeBytes = (long long)size * 1024 * 1024;
-        }
+        long long sizeBytes = (long long)size * unitBytes(unit);
 
         // Crear directorios padre si no existen
         std::string parentDir = getParentDir(path);
@@ -67,40 +73,110 @@ public:
             return "Error: No se pudo crear el directorio: " + parentDir;
         }
 
+        // Candados, discos abiertos y cachés van por la ruta canónica
+        path = canonicalPath(path);
+
         // Crear el archivo binario del disco
-        std::ofstream disk(path, std::ios::binary | std::ios::out);
-        if(!disk.is_open()) {
+        auto diskLock = DiskLocks::exclusive(path);
+        DiskManager::drop(path, true); // el caché de un disco anterior ya no sirve
+        BitmapCache::invalidate(path);
+        DentryCache::invalidate(path);
+        UsersCache::invalidate(path);
+        EbrIndex::invalidate(path);
+        int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if(fd < 0) {
             return "Error: No se pudo crear el archivo en: " + path;
         }
 
-        // Llenar con ceros usando buffer de 1024 bytes
-        char buffer[1024];
-        std::memset(buffer, 0, sizeof(buffer));
-        long long remaining = sizeBytes;
-        while(remaining > 0) {
-            long long toWrite = (remaining > 1024) ? 1024 : remaining;
-            disk.write(buffer, toWrite);
-            remaining -= toWrite;
+        std::string error = allocate(fd, sizeBytes, mode);
+        if(!error.empty()) {
+            close(fd);
+            return error;
         }
 
         // Crear y escribir el MBR al inicio del disco
         MBR mbr;
-        mbr.mbr_tamano         = (int)sizeBytes;
+        mbr.mbr_tamano         = sizeBytes;
         mbr.mbr_fecha_creacion = time(nullptr);
         mbr.mbr_dsk_signature  = rand() % 100000;
 
-        // Convertir fit a char
-        if(fit == "bf") mbr.dsk_fit = 'B';
-        else if(fit == "ff") mbr.dsk_fit = 'F';
-        else mbr.dsk_fit = 'W';
+        mbr.dsk_fit            = fitChar(fit);
 
-        // Escribir MBR al inicio
-        disk.seekp(0, std::ios::beg);
-        disk.write(reinterpret_cast<char*>(&mbr), sizeof(MBR));
-        disk.close();
+        // Escribir MBR al inicio (misma posición en los tres modos)
+        char raw[sizeof(MBR)];
+        diskEncode(mbr, raw);
+        bool ok = pwriteAll(fd, raw, sizeof(MBR), 0);
+        if(close(fd) != 0) ok = false;
+        if(!ok) {
+            return "Error: No se pudo escribir el MBR en: " + path;
+        }
 
         return "OK: Disco creado exitosamente en " + path +
-               " | Tamaño: " + std::to_string(sizeBytes) + " bytes";
+               " | Tamaño: " + std::to_string(sizeBytes) + " bytes" +
+               " | Modo: " + std::string(modeName(mode));
+    }
+
+private:
+    static constexpr EnumName<Mode> MODE_NAMES[] = {{"zero",     Mode::ZERO},
+                                                    {"sparse",   Mode::SPARSE},
+                                                    {"prealloc", Mode::PREALLOC}};
+
+    static std::string_view modeName(Mode mode) {
+        for(const auto& entry : MODE_NAMES) if(entry.value == mode) return entry.name;
+        return "";
+    }
+
+    // -----------------------------------------------
+    // Reservar el espacio del disco según el modo:
+    //  sparse   -> ftruncate, el archivo queda con huecos
+    //  prealloc -> fallocate, se reservan extents sin escribirlos
+    //  zero     -> escritura explícita de ceros en bloques de 1 MB alineados
+    // -----------------------------------------------
+    static std::string allocate(int fd, long long sizeBytes, Mode mode) {
+        if(mode == Mode::SPARSE) {
+            if(ftruncate(fd, sizeBytes) != 0)
+                return "Error: ftruncate falló: " + std::string(strerror(errno));
+            return "";
+        }
+
+        if(mode == Mode::PREALLOC) {
+            if(fallocate(fd, 0, 0, sizeBytes) == 0) return "";
+            if(errno != EOPNOTSUPP)
+                return "Error: fallocate falló: " + std::string(strerror(errno));
+            // El sistema de archivos no soporta fallocate: glibc lo emula
+            int err = posix_fallocate(fd, 0, sizeBytes);
+            if(err != 0)
+                return "Error: posix_fallocate falló: " + std::string(strerror(err));
+            return "";
+        }
+
+        void* buffer = nullptr;
+        if(posix_memalign(&buffer, 4096, ZERO_CHUNK) != 0)
+            return "Error: No hay memoria para el buffer de ceros";
+        std::memset(buffer, 0, ZERO_CHUNK);
+
+        long long offset = 0;
+        while(offset < sizeBytes) {
+            size_t toWrite = (size_t)std::min<long long>(ZERO_CHUNK, sizeBytes - offset);
+            if(!pwriteAll(fd, buffer, toWrite, offset)) {
+                free(buffer);
+                return "Error: No se pudo escribir el disco: " + std::string(strerror(errno));
+            }
+            offset += toWrite;
+        }
+        free(buffer);
+        return "";
+    }
+
+    static bool pwriteAll(int fd, const void* data, size_t len, long long offset) {
+        const char* p = static_cast<const char*>(data);
+        while(len > 0) {
+            ssize_t n = pwrite(fd, p, len, offset);
+            if(n < 0 && errno == EINTR) continue;
+            if(n <= 0) return false;
+            p += n; len -= n; offset += n;
+        }
+        return true;
     }
 };
 
@@ -3,106 +3,123 @@
 
 #include <string>
 #include <vector>
-#include <fstream>
+#include <memory>
 #include <cstring>
-#include <cmath>
+#include <cstdint>
+#include <chrono>
+#include <cstdio>
+#include <sys/uio.h>
 #include "../structs/Structs.h"
 #include "../utils/Utils.h"
+#include "../utils/CommandParser.h"
 #include "../utils/MountedPartitions.h"
+#include "../utils/DiskLocks.h"
+#include "../utils/DiskManager.h"
+#include "../utils/Bitmap.h"
+#include "../utils/PathResolver.h"
+#include "../utils/UsersTable.h"
+
+// Buffer de ceros compartido por los segmentos de pwritev
+#define MKFS_ZERO_CHUNK (1024 * 1024)
+
+// Bloques por inodo (-ratio): por defecto 1 inodo cada 3 bloques
+#define MKFS_DEFAULT_RATIO 3
+#define MKFS_MAX_RATIO     1024
 
 class MkFs {
 public:
-    static std::string execute(const std::vector<std::pair<std::string,std::string>>& params) {
-        std::string id   = "";
-        std::string type = "full";
-
-        for(const auto& p : params) {
-            std::string key = toLower(p.first);
-            if(key == "id")        id   = p.second;
-            else if(key == "type") type = toLower(p.second);
-            else return "Error: Parámetro no reconocido -> " + p.first;
+    static std::string execute(const CommandLine& cmd) {
+        std::string id        = "";
+        bool        zeroAreas = true; // -type=full
+        int         blockSize = BLOCK_SIZE_DEFAULT;
+        int         ratio     = MKFS_DEFAULT_RATIO;
+
+        for(const Param& p : cmd) {
+            if(p.is("id")) id = p.value;
+            else if(p.is("bs")) {
+                if(!parseInt(p.value, blockSize) || !validBlockSize(blockSize))
+                    return "Error: -bs debe ser 64, 512, 1024 o 4096";
+            }
+            else if(p.is("ratio")) {
+                if(!parseInt(p.value, ratio) || ratio < 1 || ratio > MKFS_MAX_RATIO)
+                    return "Error: -ratio debe estar entre 1 y " + std::to_string(MKFS_MAX_RATIO);
+            }
+            else if(p.is("type")) {
+                // fast: como la inicialización diferida de ext4, no se ponen
+                // en cero las áreas de inodos y bloques (solo lo que se usa)
+                if(iequals(p.value, "full"))      zeroAreas = true;
+                else if(iequals(p.value, "fast")) zeroAreas = false;
+                else return "Error: -type debe ser FULL o FAST";
+            }
+            else return unknownParam(p);
         }
 
         if(id.empty()) return "Error: -id es obligatorio";
-        if(type != "full") return "Error: -type solo acepta 'full'";
 
         // Buscar partición montada
-        MountedPartition* mp = MountedPartitions::findById(id);
-        if(mp == nullptr)
+        MountedPartition mp;
+        if(!MountedPartitions::findById(id, mp))
             return "Error: No existe partición montada con ID: " + id;
 
         // Abrir disco
-        std::fstream disk(mp->path, std::ios::binary | std::ios::in | std::ios::out);
-        if(!disk.is_open())
-            return "Error: No se pudo abrir el disco: " + mp->path;
+        auto diskLock = DiskLocks::exclusive(mp.path);
+        std::shared_ptr<Disk> disk = DiskManager::get(mp.path);
+        if(!disk)
+            return "Error: No se pudo abrir el disco: " + mp.path;
 
-        int partStart = mp->start;
-        int partSize  = mp->size;
+        long long partStart = mp.start;
+        long long partSize  = mp.size;
 
         // -----------------------------------------------
-        // Calcular número de inodos y bloques
-        // tamaño = sizeof(SB) + n + 3n + n*sizeof(Inode) + 3n*sizeof(Block)
-        // Despejando n:
-        // n = (partSize - sizeof(SB)) / (1 + 3 + sizeof(Inode) + 3*64)
+        // Calcular número de inodos y bloques (r = -ratio, bs = -bs)
+        // tamaño = sizeof(SB) + n + rn + n*sizeof(Inode) + rn*bs
+        // Despejando n (división entera de 64 bits):
+        // n = (partSize - sizeof(SB)) / (1 + r + sizeof(Inode) + r*bs)
+        // Los contadores y los números de inodo/bloque son de 32 bits: en
+        // una partición enorme n se limita y lo que sobra queda sin usar.
         // -----------------------------------------------
-        int sbSize    = sizeof(SuperBloque);
-        int inodeSize = sizeof(Inode);
-        int blockSize = 64;
+        long long sbSize    = sizeof(SuperBloque);
+        int       inodeSize = sizeof(Inode);
 
-        double n = (double)(partSize - sbSize) /
-                   (1 + 3 + inodeSize + 3 * blockSize);
-        int numStructures = (int)floor(n);
-
-        if(numStructures <= 0) {
-            disk.close();
+        long long n = (partSize - sbSize) / (1 + ratio + inodeSize + (long long)ratio * blockSize);
+        if(n <= 0) {
             return "Error: La partición es demasiado pequeña para EXT2";
         }
 
-        int numInodes = numStructures;
-        int numBlocks = numStructures * 3;
+        int numStructures = (int)std::min<long long>(n, INT32_MAX / ratio);
+        int numInodes     = numStructures;
+        int numBlocks     = numStructures * ratio;
 
-        // -----------------------------------------------
-        // Calcular posiciones dentro de la partición
-        // -----------------------------------------------
-        int bmInodeStart = partStart + sbSize;
-        int bmBlockStart = bmInodeStart + numInodes;
-        int inodeStart   = bmBlockStart + numBlocks;
-        int blockStart   = inodeStart + numInodes * inodeSize;
+        // La raíz y users.txt usan dos inodos y dos bloques
+        if(numInodes < 2 || numBlocks < 2) {
+            return "Error: La partición es demasiado pequeña para EXT2";
+        }
 
         // -----------------------------------------------
-        // Llenar bitmaps con ceros (todo libre)
+        // Calcular posiciones dentro de la partición (con verificación
+        // de desborde: un MBR dañado no debe dar posiciones inválidas)
         // -----------------------------------------------
-        char zero = '0';
-        disk.seekp(bmInodeStart, std::ios::beg);
-        for(int i = 0; i < numInodes; i++) disk.write(&zero, 1);
-
-        disk.seekp(bmBlockStart, std::ios::beg);
-        for(int i = 0; i < numBlocks; i++) disk.write(&zero, 1);
+        long long bmInodeStart, bmBlockStart, inodeStart, blockStart;
+        long long inodeBytes, blockBytes, fsEnd, partEnd;
+        if(!addOffset(partStart, sbSize, bmInodeStart) ||
+           !addOffset(bmInodeStart, numInodes, bmBlockStart) ||
+           !addOffset(bmBlockStart, numBlocks, inodeStart) ||
+           !mulOffset(numInodes, inodeSize, inodeBytes) ||
+           !addOffset(inodeStart, inodeBytes, blockStart) ||
+           !mulOffset(numBlocks, blockSize, blockBytes) ||
+           !addOffset(blockStart, blockBytes, fsEnd) ||
+           !addOffset(partStart, partSize, partEnd) || fsEnd > partEnd) {
+            return "Error: La partición no tiene un tamaño válido para EXT2";
+        }
 
         // -----------------------------------------------
-        // Crear SuperBloque
+        // Todo se arma en memoria y cada región se escribe con un
+        // solo pwritev: superbloque, bitmap de inodos, bitmap de
+        // bloques, tabla de inodos y área de bloques
         // -----------------------------------------------
-        SuperBloque sb;
-        sb.s_filesystem_type   = 2;
-        sb.s_inodes_count      = numInodes;
-        sb.s_blocks_count      = numBlocks;
-        sb.s_free_inodes_count = numInodes;
-        sb.s_free_blocks_count = numBlocks;
-        sb.s_mtime             = time(nullptr);
-        sb.s_umtime            = 0;
-        sb.s_mnt_count         = 1;
-        sb.s_magic             = 0xEF53;
-        sb.s_inode_s           = inodeSize;
-        sb.s_block_s           = blockSize;
-        sb.s_firts_ino         = inodeStart;
-        sb.s_first_blo         = blockStart;
-        sb.s_bm_inode_start    = bmInodeStart;
-        sb.s_bm_block_start    = bmBlockStart;
-        sb.s_inode_start       = inodeStart;
-        sb.s_block_start       = blockStart;
-
-        disk.seekp(partStart, std::ios::beg);
-        disk.write(reinterpret_cast<char*>(&sb), sizeof(SuperBloque));
+        auto bm = std::make_shared<PartitionBitmaps>();
+        bm->inodes = Bitmap(numInodes);
+        bm->blocks = Bitmap(numBlocks);
 
         // -----------------------------------------------
         // Crear inodo raíz (inodo 0) -> carpeta "/"
@@ -120,34 +137,20 @@ public:
         rootInode.i_perm[2]= '7';
         for(int i = 0; i < 15; i++) rootInode.i_block[i] = -1;
         rootInode.i_block[0] = 0; // apunta al bloque 0
-
-        // Escribir inodo 0
-        disk.seekp(inodeStart, std::ios::beg);
-        disk.write(reinterpret_cast<char*>(&rootInode), sizeof(Inode));
-
-        // Marcar inodo 0 como usado en bitmap
-        char one = '1';
-        disk.seekp(bmInodeStart, std::ios::beg);
-        disk.write(&one, 1);
+        bm->inodes.set(0);
 
         // -----------------------------------------------
         // Crear bloque carpeta raíz (bloque 0)
-        // Contiene "." y ".." apuntando al inodo 0
+        // Contiene ".", ".." y users.txt; el resto de casillas, libres
         // -----------------------------------------------
-        FolderBlock rootBlock;
-        std::strncpy(rootBlock.b_content[0].b_name, ".", 11);
-        rootBlock.b_content[0].b_inodo = 0;
-        std::strncpy(rootBlock.b_content[1].b_name, "..", 11);
-        rootBlock.b_content[1].b_inodo = 0;
-        rootBlock.b_content[2].b_inodo = -1;
-        rootBlock.b_content[3].b_inodo = -1;
-
-        disk.seekp(blockStart, std::ios::beg);
-        disk.write(reinterpret_cast<char*>(&rootBlock), sizeof(FolderBlock));
-
-        // Marcar bloque 0 como usado
-        disk.seekp(bmBlockStart, std::ios::beg);
-        disk.write(&one, 1);
+        std::vector<Content> rootBlock(blockSize / sizeof(Content));
+        std::strncpy(rootBlock[0].b_name, ".", 11);
+        rootBlock[0].b_inodo = 0;
+        std::strncpy(rootBlock[1].b_name, "..", 11);
+        rootBlock[1].b_inodo = 0;
+        std::strncpy(rootBlock[2].b_name, "users.txt", 11);
+        rootBlock[2].b_inodo = 1;
+        bm->blocks.set(0);
 
         // -----------------------------------------------
         // Crear inodo para users.txt (inodo 1)
@@ -168,55 +171,120 @@ public:
         usersInode.i_perm[2]= '7';
         for(int i = 0; i < 15; i++) usersInode.i_block[i] = -1;
         usersInode.i_block[0] = 1; // apunta al bloque 1
-
-        // Escribir inodo 1
-        disk.seekp(inodeStart + inodeSize, std::ios::beg);
-        disk.write(reinterpret_cast<char*>(&usersInode), sizeof(Inode));
-
-        // Marcar inodo 1 como usado
-        disk.seekp(bmInodeStart + 1, std::ios::beg);
-        disk.write(&one, 1);
+        bm->inodes.set(1);
 
         // -----------------------------------------------
         // Crear bloque archivo para users.txt (bloque 1)
         // -----------------------------------------------
-        FileBlock usersBlock;
-        std::memset(usersBlock.b_content, 0, 64);
-        std::strncpy(usersBlock.b_content, usersContent.c_str(), 63);
-
-        disk.seekp(blockStart + blockSize, std::ios::beg);
-        disk.write(reinterpret_cast<char*>(&usersBlock), sizeof(FileBlock));
-
-        // Marcar bloque 1 como usado
-        disk.seekp(bmBlockStart + 1, std::ios::beg);
-        disk.write(&one, 1);
+        // (entra en el bloque más chico; se escribe al armar usedBlocks)
+        bm->blocks.set(1);
 
         // -----------------------------------------------
-        // Agregar users.txt al bloque raíz
+        // Crear SuperBloque (contadores desde los bitmaps)
         // -----------------------------------------------
-        std::strncpy(rootBlock.b_content[2].b_name, "users.txt", 11);
-        rootBlock.b_content[2].b_inodo = 1;
-
-        disk.seekp(blockStart, std::ios::beg);
-        disk.write(reinterpret_cast<char*>(&rootBlock), sizeof(FolderBlock));
+        SuperBloque sb;
+        sb.s_filesystem_type   = 2;
+        sb.s_inodes_count      = numInodes;
+        sb.s_blocks_count      = numBlocks;
+        sb.s_mtime             = time(nullptr);
+        sb.s_umtime            = 0;
+        sb.s_mnt_count         = 1;
+        sb.s_magic             = 0xEF53;
+        sb.s_inode_s           = inodeSize;
+        sb.s_block_s           = blockSize;
+        sb.s_bm_inode_start    = bmInodeStart;
+        sb.s_bm_block_start    = bmBlockStart;
+        sb.s_inode_start       = inodeStart;
+        sb.s_block_start       = blockStart;
+        BitmapAllocator::syncSuperblock(sb, *bm);
+
+        // De cada bitmap solo se arma el inicio (donde están los usados);
+        // el resto se completa con '0' desde un buffer compartido
+        std::vector<char> bmInodeHead(std::min<size_t>(numInodes, MKFS_ZERO_CHUNK));
+        std::vector<char> bmBlockHead(std::min<size_t>(numBlocks, MKFS_ZERO_CHUNK));
+        bm->inodes.toAscii(bmInodeHead.data(), 0, bmInodeHead.size());
+        bm->blocks.toAscii(bmBlockHead.data(), 0, bmBlockHead.size());
+        std::vector<char> freeAscii(numBlocks > MKFS_ZERO_CHUNK ? MKFS_ZERO_CHUNK : 0, '0');
+
+        // Structs ya en el formato del disco: inodos 0 y 1 contiguos,
+        // igual para los bloques 0 y 1
+        char sbRaw[sizeof(SuperBloque)];
+        char usedInodes[2 * sizeof(Inode)];
+        std::vector<char> usedBlocks(2 * (size_t)blockSize, 0);
+        diskEncode(sb, sbRaw);
+        diskEncode(rootInode,  usedInodes);
+        diskEncode(usersInode, usedInodes + sizeof(Inode));
+        for(size_t k = 0; k < rootBlock.size(); k++)
+            diskEncode(rootBlock[k], usedBlocks.data() + k * sizeof(Content));
+        std::memcpy(usedBlocks.data() + blockSize, usersContent.data(),
+                    std::min<size_t>(usersContent.size(), blockSize - 1));
 
         // -----------------------------------------------
-        // Actualizar SuperBloque: 2 inodos y 2 bloques usados
+        // Escribir cada región y medir su tiempo
         // -----------------------------------------------
-        sb.s_free_inodes_count -= 2;
-        sb.s_free_blocks_count -= 2;
-        sb.s_firts_ino          = inodeStart + 2 * inodeSize;
-        sb.s_first_blo          = blockStart + 2 * blockSize;
+        std::vector<char> zeros(zeroAreas ? MKFS_ZERO_CHUNK : 0, 0);
+        double msSb, msBmInode, msBmBlock, msInodes, msBlocks;
+
+        if(!timedWrite(*disk, partStart, {{sbRaw, sizeof(SuperBloque)}}, msSb) ||
+           !timedWrite(*disk, bmInodeStart,
+                       withFill({bmInodeHead.data(), bmInodeHead.size()}, numInodes, freeAscii),
+                       msBmInode) ||
+           !timedWrite(*disk, bmBlockStart,
+                       withFill({bmBlockHead.data(), bmBlockHead.size()}, numBlocks, freeAscii),
+                       msBmBlock) ||
+           !timedWrite(*disk, inodeStart,
+                       withFill({usedInodes, sizeof(usedInodes)}, zeroAreas ? inodeBytes : 0, zeros),
+                       msInodes) ||
+           !timedWrite(*disk, blockStart,
+                       withFill({usedBlocks.data(), usedBlocks.size()}, zeroAreas ? blockBytes : 0, zeros),
+                       msBlocks)) {
+            return "Error: No se pudo escribir el sistema de archivos en: " + mp.path;
+        }
 
-        disk.seekp(partStart, std::ios::beg);
-        disk.write(reinterpret_cast<char*>(&sb), sizeof(SuperBloque));
+        // Los bitmaps quedan en caché para las próximas reservas
+        BitmapCache::invalidate(mp.path);
+        DentryCache::invalidate(mp.path);
+        UsersCache::invalidate(mp.path);
+        BitmapCache::put(mp.path, partStart, bm);
 
-        disk.close();
+        char timing[256];
+        std::snprintf(timing, sizeof(timing),
+                      "  Tiempos (ms): superbloque %.3f | bm_inodos %.3f | bm_bloques %.3f"
+                      " | inodos %.3f | bloques %.3f | total %.3f",
+                      msSb, msBmInode, msBmBlock, msInodes, msBlocks,
+                      msSb + msBmInode + msBmBlock + msInodes + msBlocks);
 
         return "OK: Partición formateada como EXT2\n"
                "  Inodos totales:  " + std::to_string(numInodes) + "\n"
                "  Bloques totales: " + std::to_string(numBlocks)  + "\n"
-               "  Archivo users.txt creado en la raíz";
+               "  Tamaño de bloque: " + std::to_string(blockSize) + " bytes"
+               " (1 inodo cada " + std::to_string(ratio) + " bloques)\n"
+               "  Archivo users.txt creado en la raíz\n"
+               "  Tipo: " + std::string(zeroAreas ? "full" : "fast") + "\n" + timing;
+    }
+
+private:
+    // Segmentos de una región: lo armado al inicio y, si 'regionSize'
+    // es mayor, el buffer 'fill' repetido hasta completar la región
+    static std::vector<iovec> withFill(iovec head, long long regionSize,
+                                       std::vector<char>& fill) {
+        std::vector<iovec> iov = { head };
+        long long remaining = regionSize - (long long)head.iov_len;
+        while(remaining > 0) {
+            size_t len = (size_t)std::min<long long>(remaining, fill.size());
+            iov.push_back({fill.data(), len});
+            remaining -= len;
+        }
+        return iov;
+    }
+
+    static bool timedWrite(Disk& disk, long long offset,
+                           const std::vector<iovec>& iov, double& ms) {
+        auto t0 = std::chrono::steady_clock::now();
+        bool ok = disk.writev(offset, iov);
+        ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - t0).count();
+        return ok;
     }
 };
 
@@ -3,37 +3,46 @@
 
 #include <string>
 #include <vector>
-#include <fstream>
+#include <memory>
 #include "../structs/Structs.h"
 #include "../utils/Utils.h"
+#include "../utils/CommandParser.h"
 #include "../utils/MountedPartitions.h"
+#include "../utils/DiskLocks.h"
+#include "../utils/DiskManager.h"
+#include "../utils/EbrIndex.h"
 
 class Mount {
 public:
-    static std::string execute(const std::vector<std::pair<std::string,std::string>>& params) {
+    static std::string execute(const CommandLine& cmd) {
         std::string path = "";
         std::string name = "";
 
-        for(const auto& p : params) {
-            std::string key = toLower(p.first);
-            if(key == "path")      path = p.second;
-            else if(key == "name") name = p.second;
-            else return "Error: Parámetro no reconocido -> " + p.first;
+        for(const Param& p : cmd) {
+            if(p.is("path"))      path = p.value;
+            else if(p.is("name")) name = p.value;
+            else return unknownParam(p);
         }
 
         if(path.empty()) return "Error: -path es obligatorio";
+
+        // Candados, discos abiertos y cachés van por la ruta canónica
+        path = canonicalPath(path);
         if(name.empty()) return "Error: -name es obligatorio";
 
         // Abrir disco
-        std::fstream disk(path, std::ios::binary | std::ios::in | std::ios::out);
-        if(!disk.is_open()) return "Error: No se pudo abrir el disco: " + path;
+        auto diskLock = DiskLocks::exclusive(path);
+        std::shared_ptr<Disk> disk = DiskManager::get(path);
+        if(!disk) return "Error: No se pudo abrir el disco: " + path;
 
         // Leer MBR
         MBR mbr;
-        disk.seekg(0, std::ios::beg);
-        disk.read(reinterpret_cast<char*>(&mbr), sizeof(MBR));
+        if(!disk->read(0, mbr)) return "Error: No se pudo leer el MBR de: " + path;
+        std::string formatError = mbrFormatError(mbr, path);
+        if(!formatError.empty()) return formatError;
 
-        // Buscar la partición por nombre (solo primarias)
+        // Buscar la partición por nombre: primarias en el MBR y lógicas
+        // en el índice de EBRs de la extendida
         int partIdx = -1;
         for(int i = 0; i < 4; i++) {
             if(mbr.mbr_partitions[i].part_start != -1 &&
@@ -44,44 +53,106 @@ public:
             }
         }
 
-        if(partIdx == -1)
-            return "Error: No se encontró la partición primaria: " + name;
-
-        // Verificar que no esté ya montada
-        if(MountedPartitions::findByPathAndName(path, name) != nullptr)
-            return "Error: La partición ya está montada";
+        std::shared_ptr<EbrChain> chain;
+        long long ebrPos = -1;
+        EBR logical;
+        if(partIdx == -1) {
+            chain = EbrIndex::get(*disk, path, mbr);
+            const EBR* found = chain ? chain->find(name, ebrPos) : nullptr;
+            if(!found) return "Error: No se encontró la partición: " + name;
+            logical = *found;
+        }
 
-        // Generar ID
-        std::string id = MountedPartitions::getNextID(path);
+        long long start = (partIdx != -1) ? mbr.mbr_partitions[partIdx].part_start : logical.part_start;
+        long long size  = (partIdx != -1) ? mbr.mbr_partitions[partIdx].part_s     : logical.part_s;
 
-        // Contar cuántas particiones del mismo disco están montadas
+        // Verificar que no esté ya montada y registrarla en RAM
+        MountedPartition mp;
         int correlativo = 0;
-        for(const auto& mp : MountedPartitions::mounted) {
-            if(mp.path == path) correlativo++;
+        std::string mountError;
+        if(!MountedPartitions::tryMount(path, name, start, size, mp, correlativo, mountError))
+            return "Error: " + mountError;
+        std::string id = mp.id;
+
+        bool written;
+        if(partIdx != -1) {
+            // Actualizar la partición en el MBR
+            mbr.mbr_partitions[partIdx].part_status = '1';
+            mbr.mbr_partitions[partIdx].part_correlative = correlativo;
+            std::strncpy(mbr.mbr_partitions[partIdx].part_id, id.c_str(), 3);
+            mbr.mbr_partitions[partIdx].part_id[3] = '\0';
+
+            // Escribir MBR actualizado
+            written = disk->write(0, mbr);
+        } else {
+            // La lógica solo guarda el estado en su EBR
+            logical.part_mount = '1';
+            written = chain->update(*disk, ebrPos, logical);
+        }
+
+        // Sin el estado en disco no queda montada en RAM
+        if(!written) {
+            MountedPartition removed;
+            MountedPartitions::unmount(id, removed);
+            return "Error: No se pudo guardar el estado de montaje en: " + path;
+        }
+
+        return "OK: Partición '" + name + "' montada con ID: " + id;
+    }
+};
+
+// =============================================
+// UNMOUNT - Desmontar por ID
+// unmount -id=111A
+// =============================================
+class Unmount {
+public:
+    static std::string execute(const CommandLine& cmd) {
+        std::string id = "";
+
+        for(const Param& p : cmd) {
+            if(p.is("id")) id = p.value;
+            else return unknownParam(p);
         }
-        correlativo++;
 
-        // Actualizar la partición en el MBR
-        mbr.mbr_partitions[partIdx].part_status = '1';
-        mbr.mbr_partitions[partIdx].part_correlative = correlativo;
-        std::strncpy(mbr.mbr_partitions[partIdx].part_id, id.c_str(), 3);
-        mbr.mbr_partitions[partIdx].part_id[3] = '\0';
+        if(id.empty()) return "Error: -id es obligatorio";
 
-        // Escribir MBR actualizado
-        disk.seekp(0, std::ios::beg);
-        disk.write(reinterpret_cast<char*>(&mbr), sizeof(MBR));
-        disk.close();
+        std::shared_ptr<const MountedPartition> entry = MountedPartitions::get(id);
+        if(!entry) return "Error: No existe partición montada con ID: " + id;
 
-        // Agregar a la lista en RAM
+        auto diskLock = DiskLocks::exclusive(entry->path);
         MountedPartition mp;
-        mp.id    = id;
-        mp.path  = path;
-        mp.name  = name;
-        mp.start = mbr.mbr_partitions[partIdx].part_start;
-        mp.size  = mbr.mbr_partitions[partIdx].part_s;
-        MountedPartitions::mounted.push_back(mp);
+        if(!MountedPartitions::unmount(id, mp))
+            return "Error: No existe partición montada con ID: " + id;
 
-        return "OK: Partición '" + name + "' montada con ID: " + id;
+        // Limpiar el estado de montaje en el MBR (si el disco sigue ahí)
+        std::shared_ptr<Disk> disk = DiskManager::get(mp.path);
+        MBR mbr;
+        if(disk && disk->read(0, mbr)) {
+            bool primary = false;
+            for(int i = 0; i < 4; i++) {
+                Partition& part = mbr.mbr_partitions[i];
+                if(part.part_start != mp.start || mp.name != part.part_name) continue;
+                part.part_status      = '0';
+                part.part_correlative = -1;
+                std::memset(part.part_id, 0, sizeof(part.part_id));
+                disk->write(0, mbr);
+                primary = true;
+                break;
+            }
+
+            // Lógica: limpiar part_mount en su EBR
+            std::shared_ptr<EbrChain> chain = primary ? nullptr : EbrIndex::get(*disk, mp.path, mbr);
+            long long ebrPos;
+            const EBR* found = chain ? chain->find(mp.name, ebrPos) : nullptr;
+            if(found && found->part_start == mp.start) {
+                EBR logical = *found;
+                logical.part_mount = '0';
+                chain->update(*disk, ebrPos, logical);
+            }
+        }
+
+        return "OK: Partición '" + mp.name + "' desmontada (ID: " + id + ")";
     }
 };
 
@@ -91,12 +162,13 @@ public:
 class Mounted {
 public:
     static std::string execute() {
-        if(MountedPartitions::mounted.empty())
+        std::vector<MountedPartition> mounted = MountedPartitions::snapshot();
+        if(mounted.empty())
             return "No hay particiones montadas actualmente";
 
         std::string result = "Particiones montadas:\n";
         result += "--------------------------------\n";
-        for(const auto& mp : MountedPartitions::mounted) {
+        for(const auto& mp : mounted) {
             result += "ID: " + mp.id +
                       " | Disco: " + mp.path +
                       " | Partición: " + mp.name + "\n";
@@ -0,0 +1,800 @@
+#ifndef REP_H
+#define REP_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cerrno>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "../structs/Structs.h"
+#include "../utils/Utils.h"
+#include "../utils/CommandParser.h"
+#include "../utils/MountedPartitions.h"
+#include "../utils/DiskLocks.h"
+#include "../utils/DiskManager.h"
+#include "../utils/DiskView.h"
+#include "../utils/Bitmap.h"
+#include "../utils/InodeBlocks.h"
+#include "../utils/FileIO.h"
+#include "../utils/PathResolver.h"
+#include "../utils/EbrIndex.h"
+#include "../utils/FreeExtents.h"
+#include "../utils/ThreadPool.h"
+
+extern char** environ;
+
+// Inodos que arma cada hilo por tanda antes de pasarlos al archivo
+#define REP_INODE_CHUNK 2048
+// Bits por línea en los reportes de bitmap
+#define REP_BITMAP_LINE 20
+// Bits de bitmap que arma cada hilo por tanda (múltiplo de la línea)
+#define REP_BITMAP_CHUNK (REP_BITMAP_LINE * 16384)
+// Buffer del archivo de salida
+#define REP_FILE_BUFFER (1024 * 1024)
+
+// =============================================
+// REPORT FILE
+// Archivo de salida con un buffer grande. Los reportes agregan sus
+// tramos en orden a medida que los terminan, así nunca se arma el
+// reporte completo en memoria.
+// =============================================
+class ReportFile {
+public:
+    ReportFile() = default;
+    ~ReportFile() { if(file) std::fclose(file); }
+
+    ReportFile(const ReportFile&)            = delete;
+    ReportFile& operator=(const ReportFile&) = delete;
+
+    bool open(const std::string& path) {
+        file = std::fopen(path.c_str(), "wb");
+        if(!file) return false;
+        std::setvbuf(file, nullptr, _IOFBF, REP_FILE_BUFFER);
+        return true;
+    }
+
+    bool write(std::string_view data) {
+        if(failed || data.empty()) return !failed;
+        if(std::fwrite(data.data(), 1, data.size(), file) != data.size()) failed = true;
+        return !failed;
+    }
+
+    bool close() {
+        if(!file) return false;
+        bool ok = (std::fclose(file) == 0) && !failed;
+        file = nullptr;
+        return ok;
+    }
+
+private:
+    std::FILE* file   = nullptr;
+    bool       failed = false;
+};
+
+// =============================================
+// REP - Reportes de un disco y de su EXT2
+// rep -name=mbr|disk|inode|block|bm_inode|bm_block|tree|sb|file
+//     -id=111A -path=/reportes/x.svg [-path_file_ls=/users.txt]
+//
+// mbr, disk, inode, block, tree y sb se escriben en Graphviz (DOT). Si
+// -path termina en .svg, .png, .jpg o .pdf el DOT queda al lado (con
+// extensión .dot) y se convierte con el 'dot' del sistema, si existe.
+// bm_inode, bm_block y file son texto.
+//
+// inode, block, tree y los bitmaps se arman por tandas: cada hilo (con
+// su PartitionView) escribe su tramo en un buffer propio y los buffers
+// se pasan al archivo en orden. Los inodos en uso salen del bitmap de
+// a 64 bits, así las regiones vacías no se leen.
+// =============================================
+class Rep {
+public:
+    enum class Kind { MBR, DISK, INODE, BLOCK, BM_INODE, BM_BLOCK, TREE, SB, FILE };
+
+    static std::string execute(const CommandLine& cmd) {
+        std::string id     = "";
+        std::string path   = "";
+        std::string fileLs = "";
+        Kind        kind   = Kind::MBR;
+        std::string name   = "";
+
+        for(const Param& p : cmd) {
+            if(p.is("name")) {
+                if(!parseEnum(p.value, KIND_NAMES, kind))
+                    return "Error: -name debe ser MBR, DISK, INODE, BLOCK, BM_INODE, BM_BLOCK, TREE, SB o FILE";
+                name = toLower(std::string(p.value));
+            }
+            else if(p.is("id"))           id     = p.value;
+            else if(p.is("path"))         path   = p.value;
+            else if(p.is("path_file_ls")) fileLs = p.value;
+            else return unknownParam(p);
+        }
+
+        if(name.empty()) return "Error: -name es obligatorio";
+        if(id.empty())   return "Error: -id es obligatorio";
+        if(path.empty()) return "Error: -path es obligatorio";
+        if(kind == Kind::FILE && fileLs.empty())
+            return "Error: -path_file_ls es obligatorio para el reporte FILE";
+
+        MountedPartition mp;
+        if(!MountedPartitions::findById(id, mp))
+            return "Error: No existe partición montada con ID: " + id;
+
+        std::string parentDir = getParentDir(path);
+        if(!mkdirRecursive(parentDir))
+            return "Error: No se pudo crear el directorio: " + parentDir;
+
+        bool        text    = (kind == Kind::BM_INODE || kind == Kind::BM_BLOCK || kind == Kind::FILE);
+        std::string format  = text ? "" : imageFormat(path);
+        std::string outPath = format.empty() ? path : withExtension(path, ".dot");
+
+        auto  t0 = std::chrono::steady_clock::now();
+        Stats stats;
+        std::string error = build(kind, mp, fileLs, outPath, stats);
+        if(!error.empty()) return "Error: " + error;
+        auto t1 = std::chrono::steady_clock::now();
+
+        std::string note = "";
+        if(!format.empty()) {
+            std::string dot = findDot();
+            if(dot.empty())
+                note = " | sin 'dot' en el PATH: solo se generó " + outPath;
+            else if(!runDot(dot, format, outPath, path))
+                return "Error: dot no pudo generar " + path + " (el DOT quedó en " + outPath + ")";
+        }
+        auto t2 = std::chrono::steady_clock::now();
+
+        char timing[160];
+        std::snprintf(timing, sizeof(timing), "Hilos: %zu | Tiempos (ms): reporte %.3f | dot %.3f",
+                      stats.threads,
+                      std::chrono::duration<double, std::milli>(t1 - t0).count(),
+                      std::chrono::duration<double, std::milli>(t2 - t1).count());
+        return "OK: Reporte " + name + " de " + id + " en " + path + " | Elementos: " +
+               std::to_string(stats.items) + " | " + timing + note;
+    }
+
+private:
+    static constexpr EnumName<Kind> KIND_NAMES[] = {{"mbr",      Kind::MBR},
+                                                    {"disk",     Kind::DISK},
+                                                    {"inode",    Kind::INODE},
+                                                    {"block",    Kind::BLOCK},
+                                                    {"bm_inode", Kind::BM_INODE},
+                                                    {"bm_block", Kind::BM_BLOCK},
+                                                    {"tree",     Kind::TREE},
+                                                    {"sb",       Kind::SB},
+                                                    {"file",     Kind::FILE}};
+
+    struct Stats {
+        size_t items   = 0;
+        size_t threads = 1;
+    };
+
+    // Bloque del recorrido de un inodo: 'c' carpeta, 'a' archivo,
+    // 'p' apuntadores
+    struct BlockRef {
+        int  block;
+        char kind;
+    };
+
+    // Abre la salida y arma el reporte; si falla (o se lanza una
+    // excepción) no deja un archivo a medias
+    static std::string build(Kind kind, const MountedPartition& mp, const std::string& fileLs,
+                             const std::string& outPath, Stats& stats) {
+        ReportFile out;
+        if(!out.open(outPath)) return "No se pudo crear el archivo: " + outPath;
+
+        std::string error;
+        try {
+            error = generate(kind, mp, fileLs, out, stats);
+        } catch(...) {
+            out.close();
+            std::remove(outPath.c_str());
+            throw;
+        }
+        if(!out.close() && error.empty()) error = "No se pudo escribir el archivo: " + outPath;
+        if(!error.empty()) std::remove(outPath.c_str());
+        return error;
+    }
+
+    static std::string generate(Kind kind, const MountedPartition& mp, const std::string& fileLs,
+                                ReportFile& out, Stats& stats) {
+        std::shared_ptr<Disk> disk = DiskManager::get(mp.path);
+        if(!disk) return "No se pudo abrir el disco: " + mp.path;
+
+        if(kind == Kind::MBR || kind == Kind::DISK) {
+            // El índice de EBRs se arma con el candado exclusivo
+            auto diskLock = DiskLocks::exclusive(mp.path);
+            return (kind == Kind::MBR) ? mbrReport(*disk, mp, out, stats)
+                                       : diskReport(*disk, mp, out, stats);
+        }
+
+        auto diskLock = DiskLocks::shared(mp.path);
+        PartitionView fs(*disk, mp.start, mp.size);
+        if(!fs.load()) return "La partición no tiene un sistema EXT2: " + mp.id;
+        switch(kind) {
+            case Kind::SB:       return sbReport(fs, mp, out, stats);
+            case Kind::INODE:    return inodeReport(*disk, fs, mp, out, stats);
+            case Kind::BLOCK:    return blockReport(*disk, fs, mp, out, stats);
+            case Kind::TREE:     return treeReport(*disk, fs, mp, out, stats);
+            case Kind::BM_INODE: return bitmapReport(fs, mp, true, out, stats);
+            case Kind::BM_BLOCK: return bitmapReport(fs, mp, false, out, stats);
+            case Kind::FILE:     return fileReport(fs, mp, fileLs, out, stats);
+            default:             return "";
+        }
+    }
+
+    // -----------------------------------------------
+    // Tandas en paralelo: fn(tramo, inicio, fin, buffer) arma los
+    // elementos [inicio, fin) y link(tramo) lo que une un tramo con el
+    // anterior (en el hilo que escribe, en orden)
+    // -----------------------------------------------
+    template<typename Fn, typename Link>
+    static bool streamChunks(ReportFile& out, size_t count, size_t perThread, Stats& stats,
+                             Fn&& fn, Link&& link) {
+        std::vector<std::string> parts(scanThreads());
+        size_t round = perThread * parts.size();
+        for(size_t base = 0; base < count; base += round) {
+            size_t n    = std::min(round, count - base);
+            size_t used = parallelFor(n, perThread, [&](size_t t, size_t from, size_t to) {
+                parts[t].clear();
+                fn(t, base + from, base + to, parts[t]);
+            }, perThread);
+            stats.threads = std::max(stats.threads, used);
+            for(size_t t = 0; t < used; t++) {
+                if(!out.write(link(t)) || !out.write(parts[t])) return false;
+            }
+        }
+        return true;
+    }
+
+    template<typename Fn>
+    static bool streamChunks(ReportFile& out, size_t count, size_t perThread, Stats& stats, Fn&& fn) {
+        return streamChunks(out, count, perThread, stats, fn, [](size_t) { return std::string(); });
+    }
+
+    // -----------------------------------------------
+    // MBR: tabla del MBR, sus particiones y los EBR de la extendida
+    // -----------------------------------------------
+    static std::string mbrReport(Disk& disk, const MountedPartition& mp, ReportFile& out, Stats& stats) {
+        MBR mbr;
+        if(!disk.read(0, mbr)) return "No se pudo leer el MBR de: " + mp.path;
+
+        std::string dot = "digraph MBR {\n  node [shape=plaintext fontname=\"Helvetica\"];\n"
+                          "  mbr [label=<<table border=\"0\" cellborder=\"1\" cellspacing=\"0\" cellpadding=\"4\">\n";
+        title(dot, "REPORTE DE MBR", "#4b2e83");
+        row(dot, "mbr_tamano", std::to_string(mbr.mbr_tamano));
+        row(dot, "mbr_fecha_creacion", formatTime(mbr.mbr_fecha_creacion));
+        row(dot, "mbr_disk_signature", std::to_string(mbr.mbr_dsk_signature));
+        row(dot, "dsk_fit", std::string(1, mbr.dsk_fit));
+        stats.items = 1;
+
+        for(int i = 0; i < 4; i++) {
+            const Partition& part = mbr.mbr_partitions[i];
+            if(part.part_start == -1) continue;
+            title(dot, "Partición", "#7e57c2");
+            row(dot, "part_status", std::string(1, part.part_status));
+            row(dot, "part_type", std::string(1, part.part_type));
+            row(dot, "part_fit", std::string(1, part.part_fit));
+            row(dot, "part_start", std::to_string(part.part_start));
+            row(dot, "part_size", std::to_string(part.part_s));
+            row(dot, "part_name", fixedString(part.part_name, sizeof(part.part_name)));
+            row(dot, "part_correlative", std::to_string(part.part_correlative));
+            row(dot, "part_id", fixedString(part.part_id, sizeof(part.part_id)));
+            stats.items++;
+
+            if(part.part_type != 'E') continue;
+            std::shared_ptr<EbrChain> chain = EbrIndex::get(disk, mp.path, part.part_start, part.part_s);
+            chain->forEach([&](long long pos, const EBR& ebr) {
+                title(dot, "Partición Lógica (EBR en " + std::to_string(pos) + ")", "#f28b30");
+                row(dot, "part_mount", std::string(1, ebr.part_mount));
+                row(dot, "part_fit", std::string(1, ebr.part_fit));
+                row(dot, "part_start", std::to_string(ebr.part_start));
+                row(dot, "part_size", std::to_string(ebr.part_s));
+                row(dot, "part_next", std::to_string(ebr.part_next));
+                row(dot, "part_name", fixedString(ebr.part_name, sizeof(ebr.part_name)));
+                stats.items++;
+            });
+        }
+        dot += "  </table>>];\n}\n";
+        return out.write(dot) ? "" : "No se pudo escribir el reporte";
+    }
+
+    // -----------------------------------------------
+    // DISK: el disco de izquierda a derecha con el porcentaje de cada
+    // parte; la extendida anidada con sus EBR, lógicas y huecos
+    // -----------------------------------------------
+    struct Segment {
+        long long   start;
+        long long   size;
+        std::string label;
+        long long   extSize;   // > 0: extendida (se anida su contenido)
+    };
+
+    static std::string diskReport(Disk& disk, const MountedPartition& mp, ReportFile& out, Stats& stats) {
+        MBR mbr;
+        if(!disk.read(0, mbr)) return "No se pudo leer el MBR de: " + mp.path;
+        double total = (double)std::max<long long>(1, mbr.mbr_tamano);
+
+        std::vector<Segment> segments;
+        mbrFreeSpace(mbr).forEach([&](long long start, long long len) {
+            segments.push_back({start, len, "Libre", 0});
+        });
+        std::shared_ptr<EbrChain> chain;
+        for(int i = 0; i < 4; i++) {
+            const Partition& part = mbr.mbr_partitions[i];
+            if(part.part_start == -1) continue;
+            std::string name = fixedString(part.part_name, sizeof(part.part_name));
+            if(part.part_type == 'E') {
+                segments.push_back({part.part_start, part.part_s, "Extendida " + name, part.part_s});
+                chain = EbrIndex::get(disk, mp.path, part.part_start, part.part_s);
+            } else {
+                segments.push_back({part.part_start, part.part_s, "Primaria " + name, 0});
+            }
+        }
+        std::sort(segments.begin(), segments.end(),
+                  [](const Segment& a, const Segment& b) { return a.start < b.start; });
+
+        std::string dot = "digraph DISK {\n  node [shape=plaintext fontname=\"Helvetica\"];\n"
+                          "  disk [label=<<table border=\"0\" cellborder=\"1\" cellspacing=\"0\" cellpadding=\"8\"><tr>";
+        cell(dot, "MBR", "", "#4b2e83");
+        for(const Segment& seg : segments) {
+            std::string pct = percent(seg.size, total);
+            if(seg.extSize <= 0 || !chain) {
+                cell(dot, seg.label, pct, seg.label == "Libre" ? "#e0e0e0" : "#b39ddb");
+                stats.items++;
+                continue;
+            }
+            std::vector<Segment> inner;
+            chain->forEach([&](long long pos, const EBR& ebr) {
+                inner.push_back({pos, ebr.part_start - pos, "EBR", 0});
+                inner.push_back({ebr.part_start, ebr.part_s,
+                                 "Lógica " + fixedString(ebr.part_name, sizeof(ebr.part_name)), 0});
+            });
+            chain->freeSpace().forEach([&](long long start, long long len) {
+                inner.push_back({start, len, "Libre", 0});
+            });
+            std::sort(inner.begin(), inner.end(),
+                      [](const Segment& a, const Segment& b) { return a.start < b.start; });
+
+            dot += "<td bgcolor=\"#ffe0b2\"><table border=\"0\" cellborder=\"1\" cellspacing=\"0\">"
+                   "<tr><td colspan=\"" + std::to_string(std::max<size_t>(1, inner.size())) + "\"><b>";
+            escapeTo(dot, seg.label);
+            dot += "</b><br/>" + pct + "</td></tr><tr>";
+            for(const Segment& part : inner) {
+                const char* color = (part.label == "EBR") ? "#f28b30" : (part.label == "Libre") ? "#e0e0e0" : "#ffcc80";
+                cell(dot, part.label, part.label == "EBR" ? "" : percent(part.size, total), color);
+                stats.items++;
+            }
+            if(inner.empty()) dot += "<td>Libre</td>";
+            dot += "</tr></table></td>";
+            stats.items++;
+        }
+        dot += "</tr></table>>];\n}\n";
+        return out.write(dot) ? "" : "No se pudo escribir el reporte";
+    }
+
+    // -----------------------------------------------
+    // SB
+    // -----------------------------------------------
+    static std::string sbReport(PartitionView& fs, const MountedPartition& mp, ReportFile& out, Stats& stats) {
+        const SuperBloque& sb = fs.sb();
+        std::string dot = "digraph SB {\n  node [shape=plaintext fontname=\"Helvetica\"];\n"
+                          "  sb [label=<<table border=\"0\" cellborder=\"1\" cellspacing=\"0\" cellpadding=\"4\">\n";
+        title(dot, "REPORTE DE SUPERBLOQUE (" + mp.id + ")", "#1b5e20");
+        row(dot, "s_filesystem_type", std::to_string(sb.s_filesystem_type));
+        row(dot, "s_inodes_count", std::to_string(sb.s_inodes_count));
+        row(dot, "s_blocks_count", std::to_string(sb.s_blocks_count));
+        row(dot, "s_free_blocks_count", std::to_string(sb.s_free_blocks_count));
+        row(dot, "s_free_inodes_count", std::to_string(sb.s_free_inodes_count));
+        row(dot, "s_mtime", formatTime(sb.s_mtime));
+        row(dot, "s_umtime", formatTime(sb.s_umtime));
+        row(dot, "s_mnt_count", std::to_string(sb.s_mnt_count));
+        row(dot, "s_magic", "0x" + hex(sb.s_magic));
+        row(dot, "s_version", std::to_string(sb.s_version));
+        row(dot, "s_inode_s", std::to_string(sb.s_inode_s));
+        row(dot, "s_block_s", std::to_string(sb.s_block_s));
+        row(dot, "s_firts_ino", std::to_string(sb.s_firts_ino));
+        row(dot, "s_first_blo", std::to_string(sb.s_first_blo));
+        row(dot, "s_bm_inode_start", std::to_string(sb.s_bm_inode_start));
+        row(dot, "s_bm_block_start", std::to_string(sb.s_bm_block_start));
+        row(dot, "s_inode_start", std::to_string(sb.s_inode_start));
+        row(dot, "s_block_start", std::to_string(sb.s_block_start));
+        dot += "  </table>>];\n}\n";
+        stats.items = 1;
+        return out.write(dot) ? "" : "No se pudo escribir el reporte";
+    }
+
+    // -----------------------------------------------
+    // INODE: cada inodo en uso, encadenados en orden
+    // -----------------------------------------------
+    static std::string inodeReport(Disk& disk, PartitionView& fs, const MountedPartition& mp,
+                                   ReportFile& out, Stats& stats) {
+        std::vector<int> inodes = usedInodes(fs, mp);
+        stats.items = inodes.size();
+        out.write("digraph INODES {\n  rankdir=LR;\n  node [shape=plaintext fontname=\"Helvetica\"];\n");
+        bool ok = streamChunks(out, inodes.size(), REP_INODE_CHUNK, stats,
+                               [&](size_t, size_t from, size_t to, std::string& buf) {
+            PartitionView view(disk, mp.start, mp.size);
+            view.load();
+            for(size_t i = from; i < to; i++) {
+                inodeNode(buf, inodes[i], view.inode(inodes[i]), false);
+                if(i + 1 < inodes.size())
+                    buf += "  i" + std::to_string(inodes[i]) + " -> i" + std::to_string(inodes[i + 1]) + ";\n";
+            }
+        });
+        return (ok && out.write("}\n")) ? "" : "No se pudo escribir el reporte";
+    }
+
+    // -----------------------------------------------
+    // BLOCK: los bloques de cada inodo en uso (apuntadores incluidos),
+    // encadenados en el orden del recorrido
+    // -----------------------------------------------
+    static std::string blockReport(Disk& disk, PartitionView& fs, const MountedPartition& mp,
+                                   ReportFile& out, Stats& stats) {
+        std::vector<int> inodes = usedInodes(fs, mp);
+        std::vector<std::pair<int, int>> ends(scanThreads());   // (primero, último) de cada tramo
+        std::vector<size_t>              counts(scanThreads());
+        int last = -1;
+
+        out.write("digraph BLOCKS {\n  rankdir=LR;\n  node [shape=plaintext fontname=\"Helvetica\"];\n");
+        bool ok = streamChunks(out, inodes.size(), REP_INODE_CHUNK, stats,
+                               [&](size_t t, size_t from, size_t to, std::string& buf) {
+            PartitionView view(disk, mp.start, mp.size);
+            view.load();
+            std::vector<BlockRef> blocks;
+            ends[t] = {-1, -1};
+            for(size_t i = from; i < to; i++) {
+                blocks.clear();
+                collectBlocks(view, view.inode(inodes[i]), blocks);
+                for(const BlockRef& ref : blocks) {
+                    blockNode(view, ref, nullptr, buf);
+                    if(ends[t].second != -1)
+                        buf += "  b" + std::to_string(ends[t].second) + " -> b" + std::to_string(ref.block) + ";\n";
+                    if(ends[t].first == -1) ends[t].first = ref.block;
+                    ends[t].second = ref.block;
+                }
+                counts[t] += blocks.size();
+            }
+        }, [&](size_t t) {
+            std::string edge;
+            if(ends[t].first == -1) return edge;
+            if(last != -1) edge = "  b" + std::to_string(last) + " -> b" + std::to_string(ends[t].first) + ";\n";
+            last = ends[t].second;
+            return edge;
+        });
+        for(size_t n : counts) stats.items += n;
+        return (ok && out.write("}\n")) ? "" : "No se pudo escribir el reporte";
+    }
+
+    // -----------------------------------------------
+    // TREE: inodos en uso con sus bloques; las entradas de carpeta
+    // apuntan a los inodos hijos y los apuntadores a sus bloques
+    // -----------------------------------------------
+    static std::string treeReport(Disk& disk, PartitionView& fs, const MountedPartition& mp,
+                                  ReportFile& out, Stats& stats) {
+        std::shared_ptr<PartitionBitmaps> bm = bitmaps(fs, mp);
+        std::vector<int> inodes = usedInodes(bm->inodes);
+        stats.items = inodes.size();
+
+        out.write("digraph TREE {\n  rankdir=LR;\n  node [shape=plaintext fontname=\"Helvetica\"];\n");
+        bool ok = streamChunks(out, inodes.size(), REP_INODE_CHUNK, stats,
+                               [&](size_t, size_t from, size_t to, std::string& buf) {
+            PartitionView view(disk, mp.start, mp.size);
+            view.load();
+            std::vector<BlockRef> blocks;
+            for(size_t i = from; i < to; i++) {
+                const Inode& inode = view.inode(inodes[i]);
+                inodeNode(buf, inodes[i], inode, true);
+                for(int k = 0; k < 15; k++) {
+                    if(!validBlock(view, inode.i_block[k])) continue;
+                    buf += "  i" + std::to_string(inodes[i]) + ":p" + std::to_string(k) +
+                           " -> b" + std::to_string(inode.i_block[k]) + ";\n";
+                }
+                blocks.clear();
+                collectBlocks(view, inode, blocks);
+                for(const BlockRef& ref : blocks) blockNode(view, ref, &bm->inodes, buf);
+            }
+        });
+        return (ok && out.write("}\n")) ? "" : "No se pudo escribir el reporte";
+    }
+
+    // -----------------------------------------------
+    // BM_INODE / BM_BLOCK: '0'/'1' de REP_BITMAP_LINE por línea
+    // -----------------------------------------------
+    static std::string bitmapReport(PartitionView& fs, const MountedPartition& mp, bool inodes,
+                                    ReportFile& out, Stats& stats) {
+        std::shared_ptr<PartitionBitmaps> bm = bitmaps(fs, mp);
+        const Bitmap& map = inodes ? bm->inodes : bm->blocks;
+        stats.items = map.size();
+
+        bool ok = streamChunks(out, map.size(), REP_BITMAP_CHUNK, stats,
+                               [&](size_t, size_t from, size_t to, std::string& buf) {
+            buf.reserve((to - from) * 2);
+            for(size_t i = from; i < to; i++) {
+                buf += map.test(i) ? '1' : '0';
+                buf += ((i + 1) % REP_BITMAP_LINE == 0 || i + 1 == map.size()) ? '\n' : ' ';
+            }
+        });
+        return ok ? "" : "No se pudo escribir el reporte";
+    }
+
+    // -----------------------------------------------
+    // FILE: contenido de un archivo de la partición
+    // -----------------------------------------------
+    static std::string fileReport(PartitionView& fs, const MountedPartition& mp, const std::string& fileLs,
+                                  ReportFile& out, Stats& stats) {
+        PathResolver resolver(fs, mp.path, mp.start);
+        int n = resolver.resolve(fileLs);
+        if(n < 0) return "No existe el archivo: " + fileLs;
+        const Inode& inode = fs.inode(n);
+        if(inode.i_type != '1') return "No es un archivo: " + fileLs;
+
+        std::string content;
+        if(!FileIO::read(fs, inode, content)) return "No se pudo leer el archivo: " + fileLs;
+        stats.items = content.size();
+        return out.write(content) ? "" : "No se pudo escribir el reporte";
+    }
+
+    // -----------------------------------------------
+    // Inodos en uso y bloques de un inodo
+    // -----------------------------------------------
+    static std::shared_ptr<PartitionBitmaps> bitmaps(PartitionView& fs, const MountedPartition& mp) {
+        std::shared_ptr<PartitionBitmaps> bm = BitmapCache::find(mp.path, mp.start);
+        if(bm) return bm;
+        bm = std::make_shared<PartitionBitmaps>();
+        bm->inodes = Bitmap::fromAscii(fs.inodeBitmap(), fs.sb().s_inodes_count);
+        bm->blocks = Bitmap::fromAscii(fs.blockBitmap(), fs.sb().s_blocks_count);
+        BitmapCache::put(mp.path, mp.start, bm);
+        return bm;
+    }
+
+    // De a 64 bits: una palabra en cero se salta sin mirar sus bits
+    static std::vector<int> usedInodes(const Bitmap& map) {
+        std::vector<int> out;
+        for(size_t w = 0; w < map.wordCount(); w++) {
+            for(uint64_t bits = map.word(w); bits != 0; bits &= bits - 1)
+                out.push_back((int)(w * 64 + __builtin_ctzll(bits)));
+        }
+        return out;
+    }
+
+    static std::vector<int> usedInodes(PartitionView& fs, const MountedPartition& mp) {
+        return usedInodes(bitmaps(fs, mp)->inodes);
+    }
+
+    static bool validBlock(PartitionView& fs, int blockNo) {
+        return blockNo >= 0 && blockNo < fs.sb().s_blocks_count;
+    }
+
+    // Bloques del inodo en orden; cada bloque de apuntadores va antes
+    // de lo que cuelga de él
+    static void collectBlocks(PartitionView& fs, const Inode& inode, std::vector<BlockRef>& out) {
+        char data = (inode.i_type == '0') ? 'c' : 'a';
+        for(int i = 0; i < 15; i++) {
+            int level = (i < DIRECT_BLOCKS) ? 0 : i - DIRECT_BLOCKS + 1;
+            collectRef(fs, inode.i_block[i], level, data, out);
+        }
+    }
+
+    static void collectRef(PartitionView& fs, int ptr, int level, char data, std::vector<BlockRef>& out) {
+        if(!validBlock(fs, ptr)) return;
+        out.push_back({ptr, level > 0 ? 'p' : data});
+        if(level == 0) return;
+        const int32_t* w = fs.words(ptr);
+        std::vector<int32_t> pointers(w, w + fs.blockWords());
+        for(int child : pointers) collectRef(fs, child, level - 1, data, out);
+    }
+
+    // -----------------------------------------------
+    // Nodos DOT (etiquetas HTML de Graphviz)
+    // -----------------------------------------------
+    static void inodeNode(std::string& out, int n, const Inode& inode, bool tree) {
+        out += "  i" + std::to_string(n) +
+               " [label=<<table border=\"0\" cellborder=\"1\" cellspacing=\"0\" cellpadding=\"3\">";
+        title(out, "Inodo " + std::to_string(n), "#1565c0");
+        if(!tree) {
+            row(out, "i_uid", std::to_string(inode.i_uid));
+            row(out, "i_gid", std::to_string(inode.i_gid));
+        }
+        row(out, "i_s", std::to_string(inode.i_s));
+        if(!tree) {
+            row(out, "i_atime", formatTime(inode.i_atime));
+            row(out, "i_ctime", formatTime(inode.i_ctime));
+            row(out, "i_mtime", formatTime(inode.i_mtime));
+        }
+        for(int k = 0; k < 15; k++) {
+            if(tree && inode.i_block[k] == -1) continue;
+            std::string key = "i_block_" + std::to_string(k + 1);
+            std::string value = std::to_string(inode.i_block[k]);
+            if(tree) out += "<tr><td>" + key + "</td><td colspan=\"3\" port=\"p" + std::to_string(k) + "\">" + value + "</td></tr>";
+            else     row(out, key, value);
+        }
+        row(out, "i_type", std::string(1, inode.i_type));
+        row(out, "i_perm", fixedString(inode.i_perm, sizeof(inode.i_perm)));
+        out += "</table>>];\n";
+    }
+
+    // 'inodes' (solo en el árbol) decide a qué entradas se dibuja flecha
+    static void blockNode(PartitionView& fs, const BlockRef& ref, const Bitmap* inodes, std::string& out) {
+        std::string id = "b" + std::to_string(ref.block);
+        std::string edges;
+        out += "  " + id + " [label=<<table border=\"0\" cellborder=\"1\" cellspacing=\"0\" cellpadding=\"3\">";
+
+        if(ref.kind == 'c') {
+            title(out, "Bloque Carpeta " + std::to_string(ref.block), "#f9a825");
+            // Con bloques grandes solo se muestran las casillas usadas
+            // (las cuatro primeras siempre, como en bloques de 64 bytes)
+            const Content* entries = fs.folder(ref.block);
+            for(int k = 0; k < fs.folderEntries(); k++) {
+                const Content& c = entries[k];
+                if(k >= 4 && c.b_inodo == -1) continue;
+                std::string name = fixedString(c.b_name, sizeof(c.b_name));
+                out += "<tr><td>";
+                escapeTo(out, name);
+                out += "</td><td colspan=\"3\" port=\"e" + std::to_string(k) + "\">" + std::to_string(c.b_inodo) + "</td></tr>";
+                if(inodes && c.b_inodo >= 0 && (size_t)c.b_inodo < inodes->size() &&
+                   inodes->test(c.b_inodo) && name != "." && name != "..")
+                    edges += "  " + id + ":e" + std::to_string(k) + " -> i" + std::to_string(c.b_inodo) + ";\n";
+            }
+        } else if(ref.kind == 'a') {
+            title(out, "Bloque Archivo " + std::to_string(ref.block), "#2e7d32");
+            const char* content = fs.fileBlock(ref.block);
+            out += "<tr><td colspan=\"4\" align=\"left\">";
+            escapeTo(out, fixedString(content, fs.blockSize()));
+            out += "</td></tr>";
+        } else {
+            title(out, "Bloque Apuntadores " + std::to_string(ref.block), "#c62828");
+            // Hasta el último apuntador usado (al menos 16, los de un
+            // bloque de 64 bytes), de a 4 por fila
+            const int32_t* pointers = fs.words(ref.block);
+            int shown = fs.blockWords();
+            while(shown > 16 && pointers[shown - 1] == -1) shown--;
+            out += "<tr>";
+            for(int k = 0; k < shown; k++) {
+                int child = pointers[k];
+                out += "<td port=\"q" + std::to_string(k) + "\">" + std::to_string(child) + "</td>";
+                if(k % 4 == 3 && k + 1 < shown) out += "</tr><tr>";
+                if(inodes && validBlock(fs, child))
+                    edges += "  " + id + ":q" + std::to_string(k) + " -> b" + std::to_string(child) + ";\n";
+            }
+            out += "</tr>";
+        }
+        out += "</table>>];\n" + edges;
+    }
+
+    // Fila de título (ocupa la tabla a lo ancho)
+    static void title(std::string& out, const std::string& text, const char* color) {
+        out += "<tr><td colspan=\"4\" bgcolor=\"";
+        out += color;
+        out += "\"><font color=\"white\"><b>";
+        escapeTo(out, text);
+        out += "</b></font></td></tr>";
+    }
+
+    static void row(std::string& out, const std::string& key, const std::string& value) {
+        out += "<tr><td align=\"left\">";
+        escapeTo(out, key);
+        out += "</td><td align=\"left\" colspan=\"3\">";
+        escapeTo(out, value);
+        out += "</td></tr>";
+    }
+
+    static void cell(std::string& out, const std::string& label, const std::string& pct, const char* color) {
+        out += "<td bgcolor=\"";
+        out += color;
+        out += "\">";
+        escapeTo(out, label);
+        if(!pct.empty()) out += "<br/>" + pct;
+        out += "</td>";
+    }
+
+    // Texto para una etiqueta HTML
+    static void escapeTo(std::string& out, std::string_view s) {
+        for(char ch : s) {
+            if(ch == '&')       out += "&amp;";
+            else if(ch == '<')  out += "&lt;";
+            else if(ch == '>')  out += "&gt;";
+            else if(ch == '"')  out += "&quot;";
+            else if(ch == '\n') out += "<br align=\"left\"/>";
+            else if((unsigned char)ch < 0x20) out += ' ';
+            else out += ch;
+        }
+    }
+
+    // Texto leído del disco: lo que no es ASCII imprimible pasa a '.'
+    // (un bloque puede cortar un carácter UTF-8 a la mitad, y Graphviz
+    // rechaza el UTF-8 inválido)
+    static std::string fixedString(const char* s, size_t max) {
+        std::string out(s, strnlen(s, max));
+        for(char& ch : out) {
+            if(ch != '\n' && ((unsigned char)ch < 0x20 || (unsigned char)ch >= 0x7f)) ch = '.';
+        }
+        return out;
+    }
+
+    static std::string percent(long long part, double total) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.2f%%", (double)part * 100.0 / total);
+        return buf;
+    }
+
+    static std::string hex(int value) {
+        char buf[16];
+        std::snprintf(buf, sizeof(buf), "%X", (unsigned)value);
+        return buf;
+    }
+
+    // Como timeToString pero con localtime_r (se llama desde varios hilos)
+    static std::string formatTime(time_t t) {
+        if(t == 0) return "-";
+        char buf[64];
+        struct tm tmInfo;
+        localtime_r(&t, &tmInfo);
+        std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tmInfo);
+        return buf;
+    }
+
+    // -----------------------------------------------
+    // Salida: formato según la extensión y conversión con 'dot'
+    // -----------------------------------------------
+    static std::string imageFormat(const std::string& path) {
+        std::string name = getFileName(path);
+        size_t dot = name.find_last_of('.');
+        if(dot == std::string::npos) return "";
+        std::string ext = toLower(name.substr(dot + 1));
+        if(ext == "jpeg") ext = "jpg";
+        return (ext == "svg" || ext == "png" || ext == "jpg" || ext == "pdf") ? ext : "";
+    }
+
+    static std::string withExtension(const std::string& path, const std::string& ext) {
+        size_t slash = path.find_last_of('/');
+        size_t dot   = path.find_last_of('.');
+        if(dot == std::string::npos || (slash != std::string::npos && dot < slash)) return path + ext;
+        return path.substr(0, dot) + ext;
+    }
+
+    // Ruta del ejecutable 'dot' en el PATH ("" si no está)
+    static std::string findDot() {
+        const char* env = std::getenv("PATH");
+        std::string dirs = env ? env : "/usr/local/bin:/usr/bin:/bin";
+        size_t start = 0;
+        while(start <= dirs.size()) {
+            size_t end = dirs.find(':', start);
+            if(end == std::string::npos) end = dirs.size();
+            std::string dir = dirs.substr(start, end - start);
+            if(!dir.empty()) {
+                std::string candidate = dir + "/dot";
+                if(access(candidate.c_str(), X_OK) == 0) return candidate;
+            }
+            start = end + 1;
+        }
+        return "";
+    }
+
+    // dot -T<formato> entrada -o salida, sin pasar por un shell
+    static bool runDot(const std::string& dot, const std::string& format,
+                       const std::string& input, const std::string& output) {
+        std::string type = "-T" + format;
+        std::string dst  = "-o" + output;
+        std::string src  = input;
+        char* argv[] = {const_cast<char*>("dot"), &type[0], &src[0], &dst[0], nullptr};
+
+        pid_t pid;
+        if(posix_spawn(&pid, dot.c_str(), nullptr, nullptr, argv, environ) != 0) return false;
+        int status = 0;
+        while(waitpid(pid, &status, 0) < 0) {
+            if(errno != EINTR) return false;
+        }
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+};
+
+#endif // REP_H
@@ -6,18 +6,24 @@
 #include <cstdio>
 #include <sys/stat.h>
 #include "../utils/Utils.h"
+#include "../utils/CommandParser.h"
+#include "../utils/DiskLocks.h"
+#include "../utils/DiskManager.h"
+#include "../utils/PathResolver.h"
+#include "../utils/UsersTable.h"
+#include "../utils/EbrIndex.h"
+#include "../utils/Bitmap.h"
 
 class RmDisk {
 public:
-    static std::string execute(const std::vector<std::pair<std::string,std::string>>& params) {
+    static std::string execute(const CommandLine& cmd) {
         std::string path = "";
 
-        for(const auto& p : params) {
-            std::string key = toLower(p.first);
-            if(key == "path") {
-                path = p.second;
+        for(const Param& p : cmd) {
+            if(p.is("path")) {
+                path = p.value;
             } else {
-                return "Error: Parámetro no reconocido -> " + p.first;
+                return unknownParam(p);
             }
         }
 
@@ -25,13 +31,22 @@ public:
             return "Error: El parámetro -path es obligatorio";
         }
 
+        // Candados, discos abiertos y cachés van por la ruta canónica
+        path = canonicalPath(path);
+
         // Verificar que el archivo existe
+        auto diskLock = DiskLocks::exclusive(path);
         struct stat st;
         if(stat(path.c_str(), &st) != 0) {
             return "Error: El archivo no existe: " + path;
         }
 
-        // Eliminar el archivo
+        // Eliminar el archivo (y cerrar su descriptor en el registro)
+        DiskManager::drop(path, true);
+        BitmapCache::invalidate(path);
+        DentryCache::invalidate(path);
+        UsersCache::invalidate(path);
+        EbrIndex::invalidate(path);
         if(remove(path.c_str()) != 0) {
             return "Error: No se pudo eliminar el archivo: " + path;
         }
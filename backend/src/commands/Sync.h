@@ -0,0 +1,49 @@
+#ifndef SYNC_H
+#define SYNC_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include "../utils/Utils.h"
+#include "../utils/CommandParser.h"
+#include "../utils/DiskLocks.h"
+#include "../utils/DiskManager.h"
+
+// =============================================
+// SYNC - Escribe el caché de páginas al disco físico
+// sync               -> todos los discos abiertos
+// sync -path=/a.mia  -> solo ese disco
+// =============================================
+class Sync {
+public:
+    static std::string execute(const CommandLine& cmd) {
+        std::string path = "";
+
+        for(const Param& p : cmd) {
+            if(p.is("path")) path = p.value;
+            else return unknownParam(p);
+        }
+
+        // Todos: uno por uno, cada uno con su candado como en -path
+        if(path.empty()) {
+            bool ok = true;
+            for(const std::string& diskPath : DiskManager::openPaths()) {
+                auto diskLock = DiskLocks::exclusive(diskPath);
+                if(!DiskManager::sync(diskPath)) ok = false;
+            }
+            if(!ok) return "Error: No se pudieron sincronizar todos los discos";
+            return "OK: Discos sincronizados";
+        }
+
+        // Candados, discos abiertos y cachés van por la ruta canónica
+        path = canonicalPath(path);
+
+        auto diskLock = DiskLocks::exclusive(path);
+        std::shared_ptr<Disk> disk = DiskManager::get(path);
+        if(!disk) return "Error: No se pudo abrir el disco: " + path;
+        if(!disk->sync()) return "Error: No se pudo sincronizar el disco: " + path;
+        return "OK: Disco sincronizado: " + path;
+    }
+};
+
+#endif // SYNC_H
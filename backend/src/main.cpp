@@ -4,109 +4,244 @@
 #include <vector>
 #include <fstream>
 #include <cstring>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <unistd.h>
 #include <algorithm>
+#include <stdexcept>
+#include <chrono>
+#include <functional>
 
 #include "utils/Utils.h"
+#include "utils/CommandParser.h"
+#include "utils/ThreadPool.h"
+#include "utils/HttpServer.h"
 #include "utils/MountedPartitions.h"
 #include "utils/Session.h"
-#include "commands/MkDisk.h"
-#include "commands/RmDisk.h"
-#include "commands/FDisk.h"
-#include "commands/Mount.h"
-#include "commands/MkFs.h"
-#include "commands/Login.h"
+#include "utils/DiskManager.h"
+#include "utils/PathResolver.h"
+#include "commands/Dispatch.h"
 
 #define PORT 3001
-#define BUFFER_SIZE 65536
+#define DEFAULT_WORKERS   4
+#define DEFAULT_QUEUE     64
+#define DEFAULT_BACKLOG   128
+#define DEFAULT_KEEPALIVE 15
 
 // -----------------------------------------------
-// Procesa un solo comando y retorna su salida
+// Escapar string para JSON
+// jsonEscapeTo agrega al final de 'out' sin crear copias intermedias
 // -----------------------------------------------
-std::string processCommand(const std::string& rawLine) {
-    std::string line = trim(rawLine);
-    if(line.empty())    return "";
-    if(line[0] == '#')  return line; // comentario
-
-    // Separar nombre del comando del resto
-    size_t spacePos = line.find(' ');
-    std::string cmd = toLower(
-        (spacePos == std::string::npos) ? line : line.substr(0, spacePos)
-    );
-    std::string rest = (spacePos == std::string::npos) ? "" : line.substr(spacePos + 1);
-
-    auto params = parseParams(rest);
+void jsonEscapeTo(std::string& out, std::string_view s) {
+    for(char c : s) {
+        if(c == '"')       out += "\\\"";
+        else if(c == '\\') out += "\\\\";
+        else if(c == '\n') out += "\\n";
+        else if(c == '\r') out += "\\r";
+        else if(c == '\t') out += "\\t";
+        else if((unsigned char)c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", (unsigned char)c);
+            out += buf;
+        }
+        else out += c;
+    }
+}
 
-    if(cmd == "mkdisk")  return MkDisk::execute(params);
-    if(cmd == "rmdisk")  return RmDisk::execute(params);
-    if(cmd == "fdisk")   return FDisk::execute(params);
-    if(cmd == "mount")   return Mount::execute(params);
-    if(cmd == "mounted") return Mounted::execute();
-    if(cmd == "mkfs")    return MkFs::execute(params);
-    if(cmd == "login")   return Login::execute(params);
-    if(cmd == "logout")  return Logout::execute();
+std::string jsonEscape(const std::string& s) {
+    std::string result;
+    result.reserve(s.size() + s.size() / 8);
+    jsonEscapeTo(result, s);
+    return result;
+}
 
-    return "Error: Comando no reconocido -> " + cmd;
+// -----------------------------------------------
+// Recorre las líneas de un script como vistas, sin copiarlas.
+// Si fn retorna false se detiene.
+// -----------------------------------------------
+void forEachLine(std::string_view script,
+                 const std::function<bool(std::string_view)>& fn) {
+    size_t start = 0;
+    while(start < script.size()) {
+        size_t end = script.find('\n', start);
+        if(end == std::string_view::npos) end = script.size();
+        if(!fn(script.substr(start, end - start))) return;
+        start = end + 1;
+    }
 }
 
 // -----------------------------------------------
 // Procesa múltiples comandos (script completo)
 // -----------------------------------------------
-std::string processScript(const std::string& script) {
-    std::string output = "";
-    std::istringstream ss(script);
-    std::string line;
+std::string processScript(const std::string& script, SessionContext& ctx) {
+    std::string output;
+    output.reserve(script.size() * 2);
 
-    while(std::getline(ss, line)) {
-        std::string result = processCommand(line);
+    forEachLine(script, [&](std::string_view line) {
+        std::string result = processCommand(line, ctx);
         if(!result.empty()) {
-            output += result + "\n";
+            output.append(result);
+            output.push_back('\n');
         }
-    }
+        return true;
+    });
+
+    // Punto de flush: lo modificado por el script llega al archivo .mia
+    DiskManager::flushAll();
     return output;
 }
 
 // -----------------------------------------------
-// Construir respuesta HTTP con CORS
+// Procesa un script y retorna un arreglo JSON con un resultado
+// por comando: línea, comando, estado (ok/error), salida y tiempo.
+// Con stopOnError se detiene en el primer comando con error.
 // -----------------------------------------------
-std::string buildResponse(const std::string& body,
-                           const std::string& status = "200 OK") {
-    std::string response =
-        "HTTP/1.1 " + status + "\r\n"
-        "Content-Type: application/json\r\n"
-        "Access-Control-Allow-Origin: *\r\n"
-        "Access-Control-Allow-Methods: POST, GET, OPTIONS\r\n"
-        "Access-Control-Allow-Headers: Content-Type\r\n"
-        "Content-Length: " + std::to_string(body.size()) + "\r\n"
-        "\r\n" + body;
-    return response;
+std::string processBatch(const std::string& script, bool stopOnError, SessionContext& ctx) {
+    std::string json;
+    json.reserve(script.size() * 3 + 2);
+    json.push_back('[');
+
+    int  lineNo = 0;
+    bool first  = true;
+    forEachLine(script, [&](std::string_view raw) {
+        lineNo++;
+        std::string_view line = trimView(raw);
+        if(line.empty() || line[0] == '#') return true;
+
+        auto t0 = std::chrono::steady_clock::now();
+        std::string result = processCommand(line, ctx);
+        long long us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - t0).count();
+        bool isError = result.compare(0, 5, "Error") == 0;
+
+        if(!first) json.push_back(',');
+        first = false;
+        json.append("{\"line\":").append(std::to_string(lineNo));
+        json.append(",\"command\":\"");
+        jsonEscapeTo(json, line);
+        json.append("\",\"status\":\"").append(isError ? "error" : "ok");
+        json.append("\",\"output\":\"");
+        jsonEscapeTo(json, result);
+        json.append("\",\"elapsed_us\":").append(std::to_string(us));
+        json.push_back('}');
+
+        return !(isError && stopOnError);
+    });
+
+    json.push_back(']');
+    DiskManager::flushAll();
+    return json;
 }
 
 // -----------------------------------------------
-// Escapar string para JSON
+// CORS común a todas las respuestas (el token de sesión viaja en
+// X-Session-Token, así que el navegador debe poder enviarlo y leerlo)
 // -----------------------------------------------
-std::string jsonEscape(const std::string& s) {
-    std::string result;
-    for(char c : s) {
-        if(c == '"')  result += "\\\"";
-        else if(c == '\\') result += "\\\\";
-        else if(c == '\n') result += "\\n";
-        else if(c == '\r') result += "\\r";
-        else if(c == '\t') result += "\\t";
-        else result += c;
+const std::string CORS_HEADERS =
+    "Access-Control-Allow-Origin: *\r\n"
+    "Access-Control-Allow-Methods: POST, GET, OPTIONS\r\n"
+    "Access-Control-Allow-Headers: Content-Type, X-Session-Token\r\n"
+    "Access-Control-Expose-Headers: X-Session-Token\r\n";
+
+// -----------------------------------------------
+// Token de sesión del request: encabezado X-Session-Token o cookie
+// "session"
+// -----------------------------------------------
+std::string requestToken(const HttpRequest& req) {
+    std::string token = req.header("x-session-token");
+    if(!token.empty()) return token;
+
+    std::string cookies = req.header("cookie");
+    size_t pos = 0;
+    while(pos < cookies.size()) {
+        size_t end = cookies.find(';', pos);
+        if(end == std::string::npos) end = cookies.size();
+        std::string_view item = trimView(std::string_view(cookies).substr(pos, end - pos));
+        if(item.compare(0, 8, "session=") == 0) return std::string(item.substr(8));
+        pos = end + 1;
     }
-    return result;
+    return "";
 }
 
 // -----------------------------------------------
-// Extraer body de la petición HTTP
+// Encabezados para devolver el token si login/logout lo cambiaron
 // -----------------------------------------------
-std::string extractBody(const std::string& request) {
-    size_t pos = request.find("\r\n\r\n");
-    if(pos == std::string::npos) return "";
-    return request.substr(pos + 4);
+std::string sessionHeaders(const SessionContext& ctx) {
+    if(!ctx.changed) return "";
+    if(ctx.token.empty())
+        return "X-Session-Token: \r\n"
+               "Set-Cookie: session=; Path=/; Max-Age=0; HttpOnly; SameSite=Lax\r\n";
+    return "X-Session-Token: " + ctx.token + "\r\n"
+           "Set-Cookie: session=" + ctx.token + "; Path=/; HttpOnly; SameSite=Lax\r\n";
+}
+
+// -----------------------------------------------
+// Enmarca 'data' como un chunk de Transfer-Encoding: chunked
+// -----------------------------------------------
+std::string chunk(const std::string& data) {
+    char size[20];
+    snprintf(size, sizeof(size), "%zx\r\n", data.size());
+    std::string out;
+    out.reserve(data.size() + 24);
+    out.append(size).append(data).append("\r\n");
+    return out;
+}
+
+// -----------------------------------------------
+// Ejecuta un script enviando cada resultado apenas termina el comando,
+// como eventos SSE dentro de una respuesta chunked:
+//   data: {"line":N,"output":"..."}
+// y al final "event: end" con el token de sesión resultante
+// (los encabezados ya se enviaron cuando login lo genera). Solo se retiene la salida de un comando a
+// la vez, así la memoria no crece con el tamaño total de la salida.
+// Si el cliente se desconecta el script sigue, pero sin enviar nada.
+// -----------------------------------------------
+std::string processScriptStream(const std::string& script,
+                                HttpServer::ResponseStream& stream,
+                                bool keepAlive, SessionContext& ctx) {
+    bool connected = stream.write(
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/event-stream\r\n"
+        "Cache-Control: no-cache\r\n" +
+        CORS_HEADERS +
+        "Connection: " + std::string(keepAlive ? "keep-alive" : "close") + "\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n");
+
+    int lineNo = 0;
+    std::string event;
+    forEachLine(script, [&](std::string_view line) {
+        lineNo++;
+        std::string result = processCommand(line, ctx);
+        if(result.empty() || !connected) return true;
+
+        event.assign("data: {\"line\":").append(std::to_string(lineNo));
+        event.append(",\"output\":\"");
+        jsonEscapeTo(event, result);
+        event.append("\"}\n\n");
+        connected = stream.write(chunk(event));
+        return true;
+    });
+
+    DiskManager::flushAll();
+    std::string end = "event: end\ndata: {\"session\":\"";
+    jsonEscapeTo(end, ctx.token);
+    end.append("\"}\n\n");
+    return chunk(end) + "0\r\n\r\n";
+}
+
+// -----------------------------------------------
+// Construir respuesta HTTP con CORS
+// -----------------------------------------------
+std::string buildResponse(const std::string& body,
+                           const std::string& status = "200 OK",
+                           bool keepAlive = false,
+                           const std::string& extraHeaders = "") {
+    std::string response =
+        "HTTP/1.1 " + status + "\r\n"
+        "Content-Type: application/json\r\n" +
+        CORS_HEADERS + extraHeaders +
+        "Connection: " + std::string(keepAlive ? "keep-alive" : "close") + "\r\n"
+        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+        "\r\n" + body;
+    return response;
 }
 
 // -----------------------------------------------
@@ -150,103 +285,199 @@ std::string extractJsonField(const std::string& json,
 }
 
 // -----------------------------------------------
-// Manejar una conexión de cliente
+// Extraer campo booleano JSON simple
+// {"stop_on_error":true} -> true
 // -----------------------------------------------
-void handleClient(int clientSocket) {
-    char buffer[BUFFER_SIZE] = {0};
-    read(clientSocket, buffer, BUFFER_SIZE - 1);
-    std::string request(buffer);
+bool extractJsonBool(const std::string& json, const std::string& field,
+                     bool defaultValue) {
+    std::string key = "\"" + field + "\"";
+    size_t pos = json.find(key);
+    if(pos == std::string::npos) return defaultValue;
+
+    pos = json.find(":", pos + key.size());
+    if(pos == std::string::npos) return defaultValue;
+    pos++;
 
-    // Extraer método y path
-    std::string method = request.substr(0, request.find(' '));
-    size_t pathStart   = request.find(' ') + 1;
-    size_t pathEnd     = request.find(' ', pathStart);
-    std::string path   = request.substr(pathStart, pathEnd - pathStart);
+    // Saltar espacios
+    while(pos < json.size() && json[pos] == ' ') pos++;
+    if(json.compare(pos, 4, "true") == 0)  return true;
+    if(json.compare(pos, 5, "false") == 0) return false;
+    return defaultValue;
+}
 
-    std::string response;
+// -----------------------------------------------
+// Atender una petición HTTP ya completa
+// (se ejecuta en un hilo trabajador del pool)
+// -----------------------------------------------
+std::string handleRequest(const HttpRequest& req, HttpServer::ResponseStream& stream) {
+    const std::string& method = req.method;
+    const std::string& path   = req.path;
+    bool keepAlive            = req.keepAlive;
+    SessionContext ctx;
+    ctx.token = requestToken(req);
 
     // Manejar preflight CORS
     if(method == "OPTIONS") {
-        response = buildResponse("", "204 No Content");
-        send(clientSocket, response.c_str(), response.size(), 0);
-        close(clientSocket);
-        return;
+        return buildResponse("", "204 No Content", keepAlive);
     }
 
     // -----------------------------------------------
     // POST /execute -> ejecutar comandos
     // -----------------------------------------------
     if(method == "POST" && path == "/execute") {
-        std::string body     = extractBody(request);
-        std::string commands = extractJsonField(body, "commands");
+        std::string commands = extractJsonField(req.body, "commands");
 
         if(commands.empty()) {
             std::string json = "{\"output\":\"Error: No se enviaron comandos\"}";
-            response = buildResponse(json);
-        } else {
-            std::string output = processScript(commands);
-            std::string json   = "{\"output\":\"" + jsonEscape(output) + "\"}";
-            response = buildResponse(json);
+            return buildResponse(json, "200 OK", keepAlive);
         }
+        std::string output = processScript(commands, ctx);
+        std::string json   = "{\"output\":\"" + jsonEscape(output) + "\","
+                             "\"session\":\"" + jsonEscape(ctx.token) + "\"}";
+        return buildResponse(json, "200 OK", keepAlive, sessionHeaders(ctx));
+    }
+    // -----------------------------------------------
+    // POST /execute/stream -> igual que /execute pero la salida de
+    // cada comando llega en cuanto termina (SSE sobre chunked)
+    // -----------------------------------------------
+    if(method == "POST" && path == "/execute/stream") {
+        std::string commands = extractJsonField(req.body, "commands");
+        if(commands.empty()) {
+            return buildResponse("{\"error\":\"No se enviaron comandos\"}",
+                                 "400 Bad Request", keepAlive);
+        }
+        return processScriptStream(commands, stream, keepAlive, ctx);
+    }
+    // -----------------------------------------------
+    // POST /batch -> ejecutar comandos con resultado por línea
+    // {"commands":"...", "stop_on_error":true}
+    // -----------------------------------------------
+    if(method == "POST" && path == "/batch") {
+        std::string commands = extractJsonField(req.body, "commands");
+        if(commands.empty()) {
+            return buildResponse("{\"error\":\"No se enviaron comandos\"}",
+                                 "400 Bad Request", keepAlive);
+        }
+        bool stopOnError = extractJsonBool(req.body, "stop_on_error", false);
+        std::string json = processBatch(commands, stopOnError, ctx);
+        return buildResponse(json, "200 OK", keepAlive, sessionHeaders(ctx));
     }
     // -----------------------------------------------
     // GET /status -> estado del servidor
     // -----------------------------------------------
-    else if(method == "GET" && path == "/status") {
-        std::string session = currentSession.active
-            ? currentSession.username : "none";
+    if(method == "GET" && path == "/status") {
+        std::string disks;
+        for(const auto& st : DiskManager::stats()) {
+            if(!disks.empty()) disks += ",";
+            disks += "{\"path\":\"" + jsonEscape(st.path) + "\","
+                     "\"backend\":\"" + st.backend + "\","
+                     "\"hits\":"   + std::to_string(st.hits)   + ","
+                     "\"misses\":" + std::to_string(st.misses) + ","
+                     "\"cached\":" + std::to_string(st.cached) + ","
+                     "\"dirty\":"  + std::to_string(st.dirty)  + ","
+                     "\"commits\":" + std::to_string(st.commits) + ","
+                     "\"fsyncs\":"  + std::to_string(st.fsyncs)  + "}";
+        }
+        DentryStats dc = DentryCache::stats();
         std::string json =
             "{\"status\":\"running\","
-            "\"session\":\"" + session + "\","
-            "\"mounted\":" + std::to_string(MountedPartitions::mounted.size()) + "}";
-        response = buildResponse(json);
-    }
-    else {
-        response = buildResponse("{\"error\":\"Ruta no encontrada\"}", "404 Not Found");
+            "\"sessions\":" + std::to_string(SessionTable::count()) + ","
+            "\"mounted\":" + std::to_string(MountedPartitions::count()) + ","
+            "\"disks\":[" + disks + "],"
+            "\"dentries\":{\"entries\":" + std::to_string(dc.entries) + ","
+            "\"hits\":"   + std::to_string(dc.hits)   + ","
+            "\"misses\":" + std::to_string(dc.misses) + "}}";
+        return buildResponse(json, "200 OK", keepAlive);
     }
 
-    send(clientSocket, response.c_str(), response.size(), 0);
-    close(clientSocket);
+    return buildResponse("{\"error\":\"Ruta no encontrada\"}", "404 Not Found", keepAlive);
 }
 
 // -----------------------------------------------
 // MAIN
+// Uso: ./server [-workers=N] [-queue=N] [-backlog=N] [-keepalive=SEG] [-cache=MB]
+//                [-backend=stream|mmap] [-session=SEG] [-journal=on|off]
 // -----------------------------------------------
-int main() {
+int main(int argc, char* argv[]) {
     srand(time(nullptr));
 
-    int serverSocket = socket(AF_INET, SOCK_STREAM, 0);
-    if(serverSocket == 0) {
-        std::cerr << "Error creando socket" << std::endl;
+    size_t numWorkers = DEFAULT_WORKERS;
+    size_t maxQueue   = DEFAULT_QUEUE;
+    int    backlog    = DEFAULT_BACKLOG;
+    int    keepAlive  = DEFAULT_KEEPALIVE;
+
+    // Mismo formato que los comandos: "server -workers=4 -backend=mmap"
+    std::string args = "server";
+    for(int i = 1; i < argc; i++) args += " " + std::string(argv[i]);
+    CommandLine cmd = CommandLine::parse(args);
+    if(cmd.overflow()) {
+        std::cerr << "Demasiados parámetros" << std::endl;
         return 1;
     }
+    for(const Param& p : cmd) {
+        int value = 0;
+        bool numeric = p.is("workers") || p.is("queue") || p.is("backlog") ||
+                       p.is("keepalive") || p.is("cache") || p.is("session");
+        if(numeric && (!parseInt(p.value, value) || value < 0)) {
+            std::cerr << "Valor inválido para -" << p.key << std::endl;
+            return 1;
+        }
 
-    // Permitir reutilizar el puerto
-    int opt = 1;
-    setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-
-    sockaddr_in address;
-    address.sin_family      = AF_INET;
-    address.sin_addr.s_addr = INADDR_ANY;
-    address.sin_port        = htons(PORT);
-
-    if(bind(serverSocket, (sockaddr*)&address, sizeof(address)) < 0) {
-        std::cerr << "Error en bind" << std::endl;
-        return 1;
+        if(p.is("workers"))        numWorkers = value;
+        else if(p.is("queue"))     maxQueue   = value;
+        else if(p.is("backlog"))   backlog    = value;
+        else if(p.is("keepalive")) keepAlive  = value;
+        else if(p.is("session"))   SessionTable::idleTimeout = value;
+        else if(p.is("cache"))
+            DiskManager::pagesPerDisk = (size_t)value * 1024 * 1024 / DISK_PAGE_SIZE;
+        else if(p.is("backend")) {
+            if(iequals(p.value, "mmap"))        DiskManager::backend = DiskManager::MMAP;
+            else if(iequals(p.value, "stream")) DiskManager::backend = DiskManager::STREAM;
+            else {
+                std::cerr << "-backend debe ser stream o mmap" << std::endl;
+                return 1;
+            }
+        }
+        else if(p.is("journal")) {
+            if(iequals(p.value, "on"))       DiskManager::journaling = true;
+            else if(iequals(p.value, "off")) DiskManager::journaling = false;
+            else {
+                std::cerr << "-journal debe ser on u off" << std::endl;
+                return 1;
+            }
+        }
+        else {
+            std::cerr << "Parámetro no reconocido -> " << p.key << std::endl;
+            return 1;
+        }
     }
-
-    if(listen(serverSocket, 10) < 0) {
-        std::cerr << "Error en listen" << std::endl;
+    if(numWorkers == 0 || maxQueue == 0 || backlog <= 0 || keepAlive <= 0 ||
+       DiskManager::pagesPerDisk == 0 || SessionTable::idleTimeout <= 0) {
+        std::cerr << "-workers, -queue, -backlog, -keepalive, -cache y -session deben ser mayores a 0" << std::endl;
         return 1;
     }
 
-    std::cout << "Servidor corriendo en puerto " << PORT << std::endl;
+    ThreadPool pool(numWorkers, maxQueue);
+    HttpServer server(pool, handleRequest,
+        [](const std::string& status, const std::string& json, bool keepAlive) {
+            return buildResponse(json, status, keepAlive);
+        });
 
-    while(true) {
-        int clientSocket = accept(serverSocket, nullptr, nullptr);
-        if(clientSocket < 0) continue;
-        handleClient(clientSocket);
+    std::string error;
+    if(!server.start(PORT, backlog, keepAlive, error)) {
+        std::cerr << error << std::endl;
+        return 1;
     }
 
+    std::cout << "Servidor corriendo en puerto " << PORT
+              << " | Workers: " << numWorkers
+              << " | Cola: " << maxQueue
+              << " | Backlog: " << backlog
+              << " | Disco: " << (DiskManager::backend == DiskManager::MMAP ? "mmap" : "stream")
+              << " | Journal: "
+              << (DiskManager::backend == DiskManager::STREAM && DiskManager::journaling ? "sí" : "no")
+              << std::endl;
+
+    server.run();
     return 0;
-}
\ No newline at end of file
+}
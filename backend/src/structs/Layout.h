@@ -0,0 +1,163 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <type_traits>
+#include <utility>
+
+// Versión del formato binario de los discos (MBR::mbr_version)
+//   v1: sin marca; structs con el relleno del compilador y time_t nativo
+//   v2: campos empaquetados, enteros little-endian y offsets fijos
+//   v3: posiciones y tamaños de 64 bits (discos de más de 2 GB); el
+//       tamaño de bloque (s_block_s) puede ser de 64 a 4096 bytes
+#define DISK_FORMAT_VERSION 3
+
+constexpr bool DISK_LITTLE_ENDIAN = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+// =============================================
+// DISK TIME
+// Fecha de 64 bits guardada como 8 bytes little-endian. Tiene
+// alineación 1, así que no agrega relleno en los structs que la usan.
+// Se lee y asigna como un time_t.
+// =============================================
+struct DiskTime {
+    unsigned char raw[8];
+
+    DiskTime() = default;
+    DiskTime(time_t t) { *this = t; }
+
+    DiskTime& operator=(time_t t) {
+        uint64_t v = (uint64_t)(int64_t)t;
+        if constexpr(!DISK_LITTLE_ENDIAN) v = __builtin_bswap64(v);
+        std::memcpy(raw, &v, sizeof(v));
+        return *this;
+    }
+
+    operator time_t() const {
+        uint64_t v;
+        std::memcpy(&v, raw, sizeof(v));
+        if constexpr(!DISK_LITTLE_ENDIAN) v = __builtin_bswap64(v);
+        return (time_t)(int64_t)v;
+    }
+};
+
+// =============================================
+// DISK LAYOUT
+// Cada struct del disco declara su formato como una tabla constexpr de
+// campos con el offset que tiene en disco (ver Structs.h). Con la tabla
+// se comprueba en compilación que el struct de C++ coincide byte a byte
+// (sin relleno) y se generan diskEncode/diskDecode: en un host
+// little-endian son un memcpy; en uno big-endian además invierten los
+// bytes de cada entero.
+// =============================================
+using DiskSwapFn = void (*)(char*);
+
+struct DiskField {
+    size_t     offset; // offset en el formato
+    size_t     actual; // offsetof en el struct de C++
+    size_t     size;   // bytes de cada elemento
+    size_t     count;  // elementos (arreglos)
+    DiskSwapFn swap;   // invierte un elemento; nullptr si son bytes sueltos
+};
+
+// Se especializa con 'static constexpr DiskField FIELDS[]'
+template<typename T>
+struct DiskLayout {};
+
+template<typename T, typename = void>
+struct HasDiskLayout : std::false_type {};
+
+template<typename T>
+struct HasDiskLayout<T, std::void_t<decltype(DiskLayout<T>::FIELDS)>> : std::true_type {};
+
+template<typename T>
+constexpr bool diskSerializable = std::is_arithmetic_v<T> || HasDiskLayout<T>::value;
+
+// -----------------------------------------------
+// Inversión de bytes por elemento
+// -----------------------------------------------
+template<typename T>
+inline void swapScalar(char* p) {
+    for(size_t i = 0; i < sizeof(T) / 2; i++) std::swap(p[i], p[sizeof(T) - 1 - i]);
+}
+
+template<typename T>
+inline void swapStruct(char* p) {
+    for(const DiskField& f : DiskLayout<T>::FIELDS) {
+        if(f.swap == nullptr) continue;
+        for(size_t i = 0; i < f.count; i++) f.swap(p + f.offset + i * f.size);
+    }
+}
+
+// Enteros: se invierten; structs del disco: campo por campo; lo demás
+// (char, DiskTime) ya está en el orden del disco
+template<typename E>
+constexpr DiskSwapFn elementSwap() {
+    if constexpr(std::is_arithmetic_v<E> && sizeof(E) > 1) return &swapScalar<E>;
+    else if constexpr(HasDiskLayout<E>::value)             return &swapStruct<E>;
+    else                                                    return nullptr;
+}
+
+#define DISK_ELEMENT(T, member) std::remove_all_extents_t<decltype(T::member)>
+
+// Campo 'member' de T, que en el formato empieza en el byte 'offset'
+#define DISK_FIELD(T, member, offset)                                         \
+    DiskField{offset, offsetof(T, member), sizeof(DISK_ELEMENT(T, member)),   \
+              sizeof(T::member) / sizeof(DISK_ELEMENT(T, member)),            \
+              elementSwap<DISK_ELEMENT(T, member)>()}
+
+// true si los offsets de la tabla son los del struct, los campos van
+// seguidos sin huecos y el struct mide exactamente 'size' bytes
+template<typename T>
+constexpr bool diskLayoutMatches(size_t size) {
+    size_t end = 0;
+    for(const DiskField& f : DiskLayout<T>::FIELDS) {
+        if(f.offset != end || f.actual != f.offset) return false;
+        end += f.size * f.count;
+    }
+    return end == size && sizeof(T) == size;
+}
+
+// -----------------------------------------------
+// Codificación: orden del host <-> orden del disco
+// -----------------------------------------------
+
+// Convierte en el lugar (la operación es su propia inversa). No hace
+// nada en un host little-endian.
+template<typename T>
+inline void diskOrder(void* p) {
+    static_assert(diskSerializable<T>, "el tipo no tiene formato en disco (DiskLayout)");
+    if constexpr(!DISK_LITTLE_ENDIAN) {
+        if constexpr(std::is_arithmetic_v<T>) swapScalar<T>(static_cast<char*>(p));
+        else                                  swapStruct<T>(static_cast<char*>(p));
+    }
+}
+
+template<typename T>
+inline void diskEncode(const T& in, void* out) {
+    std::memcpy(out, &in, sizeof(T));
+    diskOrder<T>(out);
+}
+
+template<typename T>
+inline void diskDecode(const void* in, T& out) {
+    std::memcpy(&out, in, sizeof(T));
+    diskOrder<T>(&out);
+}
+
+// -----------------------------------------------
+// Aritmética de posiciones y tamaños con verificación de desborde:
+// false si el resultado no cabe en 64 bits con signo
+// -----------------------------------------------
+inline bool addOffset(long long a, long long b, long long& out) {
+    return !__builtin_add_overflow(a, b, &out);
+}
+
+inline bool mulOffset(long long a, long long b, long long& out) {
+    return !__builtin_mul_overflow(a, b, &out);
+}
+
+#endif // LAYOUT_H
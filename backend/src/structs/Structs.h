@@ -3,19 +3,31 @@
 
 #include <ctime>
 #include <cstring>
+#include <cstdint>
+#include <string>
+#include "Layout.h"
+
+// Formato en disco (v3): campos sin relleno, enteros little-endian,
+// fechas de 8 bytes y posiciones/tamaños en bytes de 64 bits. Cada
+// struct declara sus offsets en DiskLayout y los static_assert
+// verifican que el struct de C++ los respete; así la imagen no depende
+// del compilador ni del host. MBR, EBR y Partition van empaquetados
+// (pack 1); los demás ya quedan densos por su orden.
+
+#pragma pack(push, 1)
 
 // =============================================
 // PARTITION
 // =============================================
 struct Partition {
-    char part_status;
-    char part_type;
-    char part_fit;
-    int  part_start;
-    int  part_s;
-    char part_name[16];
-    int  part_correlative;
-    char part_id[4];
+    char    part_status;
+    char    part_type;
+    char    part_fit;
+    int64_t part_start;
+    int64_t part_s;
+    char    part_name[16];
+    int32_t part_correlative;
+    char    part_id[4];
 
     Partition() {
         part_status      = '0';
@@ -29,17 +41,41 @@ struct Partition {
     }
 };
 
+template<> struct DiskLayout<Partition> {
+    static constexpr DiskField FIELDS[] = {
+        DISK_FIELD(Partition, part_status,       0),
+        DISK_FIELD(Partition, part_type,         1),
+        DISK_FIELD(Partition, part_fit,          2),
+        DISK_FIELD(Partition, part_start,        3),
+        DISK_FIELD(Partition, part_s,           11),
+        DISK_FIELD(Partition, part_name,        19),
+        DISK_FIELD(Partition, part_correlative, 35),
+        DISK_FIELD(Partition, part_id,          39),
+    };
+};
+static_assert(diskLayoutMatches<Partition>(43), "Partition no coincide con su formato en disco");
+
 // =============================================
 // MBR
+// Empieza con la marca "MIA" y la versión del formato. Un disco v1 no
+// la tiene: ahí los primeros 4 bytes son su tamaño, y "MIA"+versión
+// leído como entero es impar y no múltiplo de 1024, así que no hay
+// confusión posible con un tamaño creado por mkdisk.
 // =============================================
+#define MBR_MAGIC "MIA"
+
 struct MBR {
-    int       mbr_tamano;
-    time_t    mbr_fecha_creacion;
-    int       mbr_dsk_signature;
+    char      mbr_magic[3];
+    uint8_t   mbr_version;
+    int64_t   mbr_tamano;
+    DiskTime  mbr_fecha_creacion;
+    int32_t   mbr_dsk_signature;
     char      dsk_fit;
     Partition mbr_partitions[4];
 
     MBR() {
+        std::memcpy(mbr_magic, MBR_MAGIC, 3);
+        mbr_version        = DISK_FORMAT_VERSION;
         mbr_tamano         = 0;
         mbr_fecha_creacion = time(nullptr);
         mbr_dsk_signature  = 0;
@@ -47,16 +83,40 @@ struct MBR {
     }
 };
 
+template<> struct DiskLayout<MBR> {
+    static constexpr DiskField FIELDS[] = {
+        DISK_FIELD(MBR, mbr_magic,           0),
+        DISK_FIELD(MBR, mbr_version,         3),
+        DISK_FIELD(MBR, mbr_tamano,          4),
+        DISK_FIELD(MBR, mbr_fecha_creacion, 12),
+        DISK_FIELD(MBR, mbr_dsk_signature,  20),
+        DISK_FIELD(MBR, dsk_fit,            24),
+        DISK_FIELD(MBR, mbr_partitions,     25),
+    };
+};
+static_assert(diskLayoutMatches<MBR>(197), "MBR no coincide con su formato en disco");
+
+// Vacío si el disco usa el formato actual; si no, el error del comando
+inline std::string mbrFormatError(const MBR& mbr, const std::string& path) {
+    int version = (std::memcmp(mbr.mbr_magic, MBR_MAGIC, 3) != 0) ? 1 : mbr.mbr_version;
+    if(version == DISK_FORMAT_VERSION) return "";
+    if(version > DISK_FORMAT_VERSION)
+        return "Error: " + path + " usa el formato v" + std::to_string(version) +
+               ", más nuevo que el soportado (v" + std::to_string(DISK_FORMAT_VERSION) + ")";
+    return "Error: " + path + " usa el formato anterior v" + std::to_string(version) +
+           "; conviértalo con convert -path=" + path;
+}
+
 // =============================================
 // EBR
 // =============================================
 struct EBR {
-    char part_mount;
-    char part_fit;
-    int  part_start;
-    int  part_s;
-    int  part_next;
-    char part_name[16];
+    char    part_mount;
+    char    part_fit;
+    int64_t part_start;
+    int64_t part_s;
+    int64_t part_next;
+    char    part_name[16];
 
     EBR() {
         part_mount = '0';
@@ -68,12 +128,26 @@ struct EBR {
     }
 };
 
+template<> struct DiskLayout<EBR> {
+    static constexpr DiskField FIELDS[] = {
+        DISK_FIELD(EBR, part_mount,  0),
+        DISK_FIELD(EBR, part_fit,    1),
+        DISK_FIELD(EBR, part_start,  2),
+        DISK_FIELD(EBR, part_s,     10),
+        DISK_FIELD(EBR, part_next,  18),
+        DISK_FIELD(EBR, part_name,  26),
+    };
+};
+static_assert(diskLayoutMatches<EBR>(42), "EBR no coincide con su formato en disco");
+
+#pragma pack(pop)
+
 // =============================================
 // CONTENT (parte del bloque carpeta)
 // =============================================
 struct Content {
-    char b_name[12];
-    int  b_inodo;
+    char    b_name[12];
+    int32_t b_inodo;
 
     Content() {
         memset(b_name, 0, 12);
@@ -81,57 +155,50 @@ struct Content {
     }
 };
 
-// =============================================
-// BLOQUE CARPETA
-// =============================================
-struct FolderBlock {
-    Content b_content[4];
-
-    FolderBlock() {
-        for(int i = 0; i < 4; i++) {
-            memset(b_content[i].b_name, 0, 12);
-            b_content[i].b_inodo = -1;
-        }
-    }
+template<> struct DiskLayout<Content> {
+    static constexpr DiskField FIELDS[] = {
+        DISK_FIELD(Content, b_name,   0),
+        DISK_FIELD(Content, b_inodo, 12),
+    };
 };
+static_assert(diskLayoutMatches<Content>(16), "Content no coincide con su formato en disco");
 
 // =============================================
-// BLOQUE ARCHIVO
+// BLOQUES
+// Miden s_block_s bytes (uno de BLOCK_SIZES, lo elige mkfs -bs) y su
+// contenido se arma en tiempo de ejecución según ese tamaño:
+//   carpeta      -> s_block_s / 16 Content ("." y ".." en las casillas
+//                   0 y 1 del primer bloque)
+//   archivo      -> s_block_s bytes de contenido
+//   apuntadores  -> s_block_s / 4 números de bloque (int32, -1 = libre)
+// Ver PartitionView::folder() y PartitionView::words().
 // =============================================
-struct FileBlock {
-    char b_content[64];
-
-    FileBlock() {
-        memset(b_content, 0, 64);
-    }
-};
+#define BLOCK_SIZE_MIN     64
+#define BLOCK_SIZE_DEFAULT 64
 
-// =============================================
-// BLOQUE APUNTADORES
-// =============================================
-struct PointerBlock {
-    int b_pointers[16];
+constexpr int BLOCK_SIZES[] = {64, 512, 1024, 4096};
 
-    PointerBlock() {
-        for(int i = 0; i < 16; i++) b_pointers[i] = -1;
-    }
-};
+inline bool validBlockSize(int size) {
+    for(int bs : BLOCK_SIZES) if(bs == size) return true;
+    return false;
+}
 
 // =============================================
 // INODO
 // (definido ANTES del SuperBloque para que
 //  sizeof(Inode) funcione correctamente)
+// 100 bytes: las fechas (alineación 1) ya no dejan relleno
 // =============================================
 struct Inode {
-    int    i_uid;
-    int    i_gid;
-    int    i_s;
-    time_t i_atime;
-    time_t i_ctime;
-    time_t i_mtime;
-    int    i_block[15];
-    char   i_type;
-    char   i_perm[3];
+    int32_t  i_uid;
+    int32_t  i_gid;
+    int32_t  i_s;
+    DiskTime i_atime;
+    DiskTime i_ctime;
+    DiskTime i_mtime;
+    int32_t  i_block[15];
+    char     i_type;
+    char     i_perm[3];
 
     Inode() {
         i_uid   = -1;
@@ -148,29 +215,45 @@ struct Inode {
     }
 };
 
+template<> struct DiskLayout<Inode> {
+    static constexpr DiskField FIELDS[] = {
+        DISK_FIELD(Inode, i_uid,     0),
+        DISK_FIELD(Inode, i_gid,     4),
+        DISK_FIELD(Inode, i_s,       8),
+        DISK_FIELD(Inode, i_atime,  12),
+        DISK_FIELD(Inode, i_ctime,  20),
+        DISK_FIELD(Inode, i_mtime,  28),
+        DISK_FIELD(Inode, i_block,  36),
+        DISK_FIELD(Inode, i_type,   96),
+        DISK_FIELD(Inode, i_perm,   97),
+    };
+};
+static_assert(diskLayoutMatches<Inode>(100), "Inode no coincide con su formato en disco");
+
 // =============================================
 // SUPERBLOQUE
 // (definido DESPUÉS de Inode para poder usar
 //  sizeof(Inode) sin problemas)
 // =============================================
 struct SuperBloque {
-    int    s_filesystem_type;
-    int    s_inodes_count;
-    int    s_blocks_count;
-    int    s_free_blocks_count;
-    int    s_free_inodes_count;
-    time_t s_mtime;
-    time_t s_umtime;
-    int    s_mnt_count;
-    int    s_magic;
-    int    s_inode_s;
-    int    s_block_s;
-    int    s_firts_ino;
-    int    s_first_blo;
-    int    s_bm_inode_start;
-    int    s_bm_block_start;
-    int    s_inode_start;
-    int    s_block_start;
+    int32_t  s_filesystem_type;
+    int32_t  s_inodes_count;
+    int32_t  s_blocks_count;
+    int32_t  s_free_blocks_count;
+    int32_t  s_free_inodes_count;
+    DiskTime s_mtime;
+    DiskTime s_umtime;
+    int32_t  s_mnt_count;
+    int32_t  s_magic;
+    int32_t  s_version;
+    int32_t  s_inode_s;
+    int32_t  s_block_s;
+    int64_t  s_firts_ino;
+    int64_t  s_first_blo;
+    int64_t  s_bm_inode_start;
+    int64_t  s_bm_block_start;
+    int64_t  s_inode_start;
+    int64_t  s_block_start;
 
     SuperBloque() {
         s_filesystem_type   = 2;
@@ -182,8 +265,9 @@ struct SuperBloque {
         s_umtime            = 0;
         s_mnt_count         = 0;
         s_magic             = 0xEF53;
+        s_version           = DISK_FORMAT_VERSION;
         s_inode_s           = sizeof(Inode);  // ✓ Ahora Inode ya existe
-        s_block_s           = 64;
+        s_block_s           = BLOCK_SIZE_DEFAULT;
         s_firts_ino         = 0;
         s_first_blo         = 0;
         s_bm_inode_start    = 0;
@@ -193,4 +277,28 @@ struct SuperBloque {
     }
 };
 
+template<> struct DiskLayout<SuperBloque> {
+    static constexpr DiskField FIELDS[] = {
+        DISK_FIELD(SuperBloque, s_filesystem_type,    0),
+        DISK_FIELD(SuperBloque, s_inodes_count,       4),
+        DISK_FIELD(SuperBloque, s_blocks_count,       8),
+        DISK_FIELD(SuperBloque, s_free_blocks_count, 12),
+        DISK_FIELD(SuperBloque, s_free_inodes_count, 16),
+        DISK_FIELD(SuperBloque, s_mtime,             20),
+        DISK_FIELD(SuperBloque, s_umtime,            28),
+        DISK_FIELD(SuperBloque, s_mnt_count,         36),
+        DISK_FIELD(SuperBloque, s_magic,             40),
+        DISK_FIELD(SuperBloque, s_version,           44),
+        DISK_FIELD(SuperBloque, s_inode_s,           48),
+        DISK_FIELD(SuperBloque, s_block_s,           52),
+        DISK_FIELD(SuperBloque, s_firts_ino,         56),
+        DISK_FIELD(SuperBloque, s_first_blo,         64),
+        DISK_FIELD(SuperBloque, s_bm_inode_start,    72),
+        DISK_FIELD(SuperBloque, s_bm_block_start,    80),
+        DISK_FIELD(SuperBloque, s_inode_start,       88),
+        DISK_FIELD(SuperBloque, s_block_start,       96),
+    };
+};
+static_assert(diskLayoutMatches<SuperBloque>(104), "SuperBloque no coincide con su formato en disco");
+
 #endif // STRUCTS_H
\ No newline at end of file
@@ -0,0 +1,311 @@
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include "DiskView.h"
+
+// =============================================
+// BITMAP
+// Un bit por inodo/bloque empaquetado en palabras de 64 bits
+// (1 = ocupado). Las búsquedas recorren palabra por palabra y usan
+// ctz/popcount, así una palabra llena se descarta con una comparación.
+// Además se recuerda una pista: todo lo anterior a 'hint' está ocupado,
+// así reservar de forma repetida no vuelve a recorrer el inicio lleno.
+// En disco se sigue guardando un byte ASCII '0'/'1' por elemento.
+// =============================================
+class Bitmap {
+public:
+    Bitmap() {}
+    explicit Bitmap(size_t n) : bits(n), words((n + 63) / 64, 0), freeBits(n) {}
+
+    size_t size()      const { return bits; }
+    size_t freeCount() const { return freeBits; }
+
+    bool test(size_t i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+
+    void set(size_t i) {
+        uint64_t mask = 1ULL << (i & 63);
+        if(!(words[i >> 6] & mask)) { words[i >> 6] |= mask; freeBits--; }
+    }
+
+    void clear(size_t i) {
+        uint64_t mask = 1ULL << (i & 63);
+        if(words[i >> 6] & mask) { words[i >> 6] &= ~mask; freeBits++; }
+        hint = std::min(hint, i);
+    }
+
+    // Primer bit libre desde 'from', o -1
+    long long findFree(size_t from = 0) const {
+        bool fromStart = (from <= hint);
+        if(fromStart) from = hint;
+        long long r = scanFree(from);
+        if(fromStart) hint = (r < 0) ? bits : (size_t)r;
+        return r;
+    }
+
+    // Primer bit ocupado desde 'from', o size()
+    size_t findUsed(size_t from) const {
+        if(from >= bits) return bits;
+        size_t   w    = from >> 6;
+        uint64_t used = words[w] & (~0ULL << (from & 63));
+        while(true) {
+            if(used != 0) {
+                size_t i = (w << 6) + __builtin_ctzll(used);
+                return (i < bits) ? i : bits;
+            }
+            if(++w >= words.size()) return bits;
+            used = words[w];
+        }
+    }
+
+    // Primera racha de 'n' bits libres consecutivos, o -1
+    long long findFreeRun(size_t n, size_t from = 0) const {
+        if(n == 0 || n > freeBits) return -1;
+        long long start = findFree(from);
+        while(start >= 0) {
+            size_t end = findUsed((size_t)start);
+            if(end - (size_t)start >= n) return start;
+            if(end >= bits) return -1;
+            start = findFree(end);
+        }
+        return -1;
+    }
+
+    // Marca [start, start+n) como ocupado (o libre) de palabra en palabra
+    void setRange(size_t start, size_t n, bool used) {
+        size_t end = start + n;
+        while(start < end) {
+            size_t   w     = start >> 6;
+            size_t   lo    = start & 63;
+            size_t   hi    = std::min<size_t>(64, lo + (end - start));
+            uint64_t mask  = (hi - lo == 64) ? ~0ULL : (((1ULL << (hi - lo)) - 1) << lo);
+            size_t   before = __builtin_popcountll(words[w] & mask);
+            if(used) { words[w] |= mask;  freeBits -= (hi - lo) - before; }
+            else     { words[w] &= ~mask; freeBits += before; hint = std::min(hint, start); }
+            start += hi - lo;
+        }
+    }
+
+    // -----------------------------------------------
+    // Conversión desde/hacia el formato ASCII del disco
+    // Se procesan 8 bytes por iteración: cada byte '1' se vuelve un bit
+    // (y viceversa) con máscaras y una multiplicación. Cualquier byte
+    // distinto de '1' (incluido '\0' de un disco sin formato) es libre.
+    // -----------------------------------------------
+    static Bitmap fromAscii(const char* data, size_t n) {
+        Bitmap bm(n);
+        size_t used = 0;
+        size_t i    = 0;
+        for(; i + 8 <= n; i += 8) {
+            uint64_t x;
+            std::memcpy(&x, data + i, 8);
+            uint64_t y    = x ^ 0x3131313131313131ULL; // byte 0 donde había '1'
+            uint64_t zero = ~(((y & 0x7f7f7f7f7f7f7f7fULL) + 0x7f7f7f7f7f7f7f7fULL) |
+                              y | 0x7f7f7f7f7f7f7f7fULL);
+            uint64_t byte = (((zero >> 7) * 0x0102040810204080ULL) >> 56);
+            bm.words[i >> 6] |= byte << (i & 63);
+            used += __builtin_popcountll(byte);
+        }
+        for(; i < n; i++) {
+            if(data[i] == '1') { bm.words[i >> 6] |= 1ULL << (i & 63); used++; }
+        }
+        bm.freeBits = n - used;
+        return bm;
+    }
+
+    // Escribe los bits [start, start+n) como '0'/'1' en 'out'
+    void toAscii(char* out, size_t start, size_t n) const {
+        size_t i = start, end = start + n;
+        for(; i < end && (i & 7); i++) *out++ = test(i) ? '1' : '0';
+        for(; i + 8 <= end; i += 8) {
+            uint64_t byte = (words[i >> 6] >> (i & 63)) & 0xff;
+            uint64_t x    = (byte * 0x0101010101010101ULL) & 0x8040201008040201ULL;
+            x = (((x + 0x7f7f7f7f7f7f7f7fULL) & 0x8080808080808080ULL) >> 7) |
+                0x3030303030303030ULL;
+            std::memcpy(out, &x, 8);
+            out += 8;
+        }
+        for(; i < end; i++) *out++ = test(i) ? '1' : '0';
+    }
+
+    void toAscii(char* out) const { toAscii(out, 0, bits); }
+
+    // Palabra 'w' (bits [64w, 64w+64)); para comparar bitmaps de a 64
+    size_t   wordCount()      const { return words.size(); }
+    uint64_t word(size_t w)   const { return words[w]; }
+
+private:
+    size_t                bits     = 0;
+    std::vector<uint64_t> words;
+    size_t                freeBits = 0;
+    mutable size_t        hint     = 0;
+
+    long long scanFree(size_t from) const {
+        if(from >= bits) return -1;
+        size_t   w    = from >> 6;
+        uint64_t free = ~words[w] & (~0ULL << (from & 63));
+        while(true) {
+            if(free != 0) {
+                size_t i = (w << 6) + __builtin_ctzll(free);
+                return (i < bits) ? (long long)i : -1;
+            }
+            if(++w >= words.size()) return -1;
+            free = ~words[w];
+        }
+    }
+};
+
+// Bitmaps de una partición formateada, en memoria
+struct PartitionBitmaps {
+    Bitmap inodes;
+    Bitmap blocks;
+};
+
+// =============================================
+// BITMAP CACHE
+// Bitmaps empaquetados por partición (ruta + inicio), para no volver a
+// leer y convertir los bytes ASCII en cada comando. mkfs (o cualquier
+// cambio que no pase por BitmapAllocator) debe invalidar la entrada.
+// =============================================
+class BitmapCache {
+public:
+    static std::shared_ptr<PartitionBitmaps> find(const std::string& path, long long start) {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = entries.find(key(path, start));
+        return (it == entries.end()) ? nullptr : it->second;
+    }
+
+    static void put(const std::string& path, long long start,
+                    std::shared_ptr<PartitionBitmaps> bitmaps) {
+        std::lock_guard<std::mutex> lock(mtx);
+        entries[key(path, start)] = std::move(bitmaps);
+    }
+
+    // Olvida todas las particiones de un disco
+    static void invalidate(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::string prefix = path + "@";
+        for(auto it = entries.begin(); it != entries.end(); ) {
+            if(it->first.compare(0, prefix.size(), prefix) == 0) it = entries.erase(it);
+            else ++it;
+        }
+    }
+
+private:
+    static std::mutex mtx;
+    static std::unordered_map<std::string, std::shared_ptr<PartitionBitmaps>> entries;
+
+    static std::string key(const std::string& path, long long start) {
+        return path + "@" + std::to_string(start);
+    }
+};
+
+// Definiciones estáticas
+std::mutex BitmapCache::mtx;
+std::unordered_map<std::string, std::shared_ptr<PartitionBitmaps>> BitmapCache::entries;
+
+// =============================================
+// BITMAP ALLOCATOR
+// Reserva y libera inodos/bloques de una partición. Al hacer commit()
+// escribe solo el rango de bytes ASCII que cambió y deja
+// s_free_inodes_count, s_free_blocks_count, s_firts_ino y s_first_blo
+// del superbloque en sincronía con los bitmaps.
+// Requiere el candado exclusivo del disco.
+// =============================================
+class BitmapAllocator {
+public:
+    explicit BitmapAllocator(PartitionView& fs, const std::string& path, long long start)
+        : fs(fs) {
+        bm = BitmapCache::find(path, start);
+        if(!bm) {
+            bm = std::make_shared<PartitionBitmaps>();
+            bm->inodes = Bitmap::fromAscii(fs.inodeBitmap(), fs.sb().s_inodes_count);
+            bm->blocks = Bitmap::fromAscii(fs.blockBitmap(), fs.sb().s_blocks_count);
+            BitmapCache::put(path, start, bm);
+        }
+    }
+
+    ~BitmapAllocator() { commit(); }
+
+    const Bitmap& inodes() const { return bm->inodes; }
+    const Bitmap& blocks() const { return bm->blocks; }
+
+    // Retornan el número reservado o -1 si no hay espacio
+    int allocInode() { return alloc(bm->inodes, inodeDirty, 1); }
+    int allocBlock() { return alloc(bm->blocks, blockDirty, 1); }
+
+    // 'n' bloques contiguos; retorna el primero
+    int allocBlocks(int n) { return alloc(bm->blocks, blockDirty, n); }
+
+    void freeInode(int n) { release(bm->inodes, inodeDirty, n, 1); }
+    void freeBlock(int n) { release(bm->blocks, blockDirty, n, 1); }
+    void freeBlocks(int n, int count) { release(bm->blocks, blockDirty, n, count); }
+
+    // Persiste los rangos modificados y actualiza el superbloque
+    void commit() {
+        if(!inodeDirty.any() && !blockDirty.any()) return;
+        SuperBloque& sb = fs.sbMut();
+
+        if(inodeDirty.any()) {
+            char* out = fs.bytesMut(sb.s_bm_inode_start + inodeDirty.lo, inodeDirty.len());
+            bm->inodes.toAscii(out, inodeDirty.lo, inodeDirty.len());
+        }
+        if(blockDirty.any()) {
+            char* out = fs.bytesMut(sb.s_bm_block_start + blockDirty.lo, blockDirty.len());
+            bm->blocks.toAscii(out, blockDirty.lo, blockDirty.len());
+        }
+        syncSuperblock(sb, *bm);
+        inodeDirty = Range();
+        blockDirty = Range();
+    }
+
+    // Contadores y primeros libres del superbloque a partir de los bitmaps
+    static void syncSuperblock(SuperBloque& sb, const PartitionBitmaps& bm) {
+        sb.s_free_inodes_count = (int)bm.inodes.freeCount();
+        sb.s_free_blocks_count = (int)bm.blocks.freeCount();
+        long long ino = bm.inodes.findFree();
+        long long blo = bm.blocks.findFree();
+        // Igual que mkfs: byte donde está el primer inodo/bloque libre
+        sb.s_firts_ino = (ino < 0) ? -1 : sb.s_inode_start + ino * sb.s_inode_s;
+        sb.s_first_blo = (blo < 0) ? -1 : sb.s_block_start + blo * sb.s_block_s;
+    }
+
+private:
+    struct Range {
+        size_t lo = SIZE_MAX, hi = 0;
+        bool   any() const { return lo < hi; }
+        size_t len() const { return hi - lo; }
+        void   add(size_t start, size_t n) {
+            lo = std::min(lo, start);
+            hi = std::max(hi, start + n);
+        }
+    };
+
+    PartitionView&                    fs;
+    std::shared_ptr<PartitionBitmaps> bm;
+    Range                             inodeDirty;
+    Range                             blockDirty;
+
+    int alloc(Bitmap& map, Range& dirty, int n) {
+        long long start = (n == 1) ? map.findFree() : map.findFreeRun(n);
+        if(start < 0) return -1;
+        map.setRange((size_t)start, n, true);
+        dirty.add((size_t)start, n);
+        return (int)start;
+    }
+
+    void release(Bitmap& map, Range& dirty, int start, int n) {
+        if(start < 0 || (size_t)start + n > map.size()) return;
+        map.setRange(start, n, false);
+        dirty.add(start, n);
+    }
+};
+
+#endif // BITMAP_H
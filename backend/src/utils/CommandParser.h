@@ -0,0 +1,255 @@
+#ifndef COMMANDPARSER_H
+#define COMMANDPARSER_H
+
+#include <string>
+#include <string_view>
+#include <array>
+#include <cstdint>
+#include <charconv>
+
+// Máximo de parámetros por línea (ningún comando usa más de 6)
+#define MAX_PARAMS 16
+
+// -----------------------------------------------
+// Utilidades sobre string_view (sin copias)
+// -----------------------------------------------
+constexpr char lowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+// Comparación sin distinguir mayúsculas
+constexpr bool iequals(std::string_view a, std::string_view b) {
+    if(a.size() != b.size()) return false;
+    for(size_t i = 0; i < a.size(); i++)
+        if(lowerAscii(a[i]) != lowerAscii(b[i])) return false;
+    return true;
+}
+
+inline std::string_view trimView(std::string_view s) {
+    size_t start = s.find_first_not_of(" \t\r\n");
+    if(start == std::string_view::npos) return {};
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(start, end - start + 1);
+}
+
+// =============================================
+// COMMAND LINE
+// Una línea ya separada en nombre y parámetros -clave=valor. Todas las
+// partes son vistas sobre el texto original (el script del request),
+// así que la línea debe seguir viva mientras se use.
+// =============================================
+struct Param {
+    std::string_view key;
+    std::string_view value;
+
+    bool is(std::string_view name) const { return iequals(key, name); }
+};
+
+class CommandLine {
+public:
+    std::string_view name;
+
+    const Param* begin() const { return params.data(); }
+    const Param* end()   const { return params.data() + count; }
+    size_t       size()  const { return count; }
+
+    // true si la línea traía más de MAX_PARAMS parámetros
+    bool overflow() const { return tooMany; }
+
+    // Separa "cmd -a=1 -b="con espacios" -c" sin reservar memoria.
+    // La línea ya debe venir sin espacios al inicio ni al final.
+    static CommandLine parse(std::string_view line) {
+        CommandLine out;
+        size_t space = line.find(' ');
+        out.name = line.substr(0, space);
+        if(space == std::string_view::npos) return out;
+
+        size_t i = space + 1, n = line.size();
+        while(i < n) {
+            while(i < n && line[i] == ' ') i++;
+            if(i >= n) break;
+            if(line[i] != '-') { i++; continue; }
+
+            size_t keyStart = ++i;
+            while(i < n && line[i] != '=' && line[i] != ' ') i++;
+            Param p;
+            p.key = line.substr(keyStart, i - keyStart);
+
+            if(i < n && line[i] == '=') {
+                i++;
+                if(i < n && line[i] == '"') {
+                    size_t valStart = ++i;
+                    while(i < n && line[i] != '"') i++;
+                    p.value = line.substr(valStart, i - valStart);
+                    if(i < n) i++; // comilla final
+                } else {
+                    size_t valStart = i;
+                    while(i < n && line[i] != ' ') i++;
+                    p.value = line.substr(valStart, i - valStart);
+                }
+            }
+
+            if(out.count == MAX_PARAMS) { out.tooMany = true; break; }
+            out.params[out.count++] = p;
+        }
+        return out;
+    }
+
+private:
+    std::array<Param, MAX_PARAMS> params;
+    size_t                        count   = 0;
+    bool                          tooMany = false;
+};
+
+// -----------------------------------------------
+// Parámetros tipados: se validan una sola vez al leerlos
+// -----------------------------------------------
+inline bool parseInt(std::string_view s, int& out) {
+    const char* first = s.data();
+    const char* last  = s.data() + s.size();
+    if(first != last && *first == '+') first++;
+    auto r = std::from_chars(first, last, out);
+    return r.ec == std::errc() && r.ptr == last && first != last;
+}
+
+template<typename E>
+struct EnumName {
+    std::string_view name;
+    E                value;
+};
+
+// Busca 's' (sin distinguir mayúsculas) en una tabla de nombres
+template<typename E, size_t N>
+bool parseEnum(std::string_view s, const EnumName<E> (&table)[N], E& out) {
+    for(const auto& entry : table) {
+        if(iequals(s, entry.name)) { out = entry.value; return true; }
+    }
+    return false;
+}
+
+enum class Unit     { B, K, M };
+enum class Fit      { BF, FF, WF };
+enum class PartType { PRIMARY, EXTENDED, LOGICAL };
+
+constexpr EnumName<Unit>     UNIT_NAMES[] = {{"b", Unit::B}, {"k", Unit::K}, {"m", Unit::M}};
+constexpr EnumName<Fit>      FIT_NAMES[]  = {{"bf", Fit::BF}, {"ff", Fit::FF}, {"wf", Fit::WF}};
+constexpr EnumName<PartType> TYPE_NAMES[] = {{"p", PartType::PRIMARY},
+                                             {"e", PartType::EXTENDED},
+                                             {"l", PartType::LOGICAL}};
+
+// Carácter que se guarda en MBR/EBR para cada ajuste
+constexpr char fitChar(Fit fit) {
+    return (fit == Fit::BF) ? 'B' : (fit == Fit::FF) ? 'F' : 'W';
+}
+
+constexpr long long unitBytes(Unit unit) {
+    return (unit == Unit::B) ? 1LL : (unit == Unit::K) ? 1024LL : 1024LL * 1024;
+}
+
+// Mensaje estándar para un valor que no se pudo convertir
+inline std::string invalidValue(const Param& p) {
+    return "Error: Valor inválido para -" + std::string(p.key) + " -> " + std::string(p.value);
+}
+
+inline std::string unknownParam(const Param& p) {
+    return "Error: Parámetro no reconocido -> " + std::string(p.key);
+}
+
+// =============================================
+// TABLA DE COMANDOS
+// Hash perfecto calculado en compilación: se busca la primera semilla
+// con la que cada nombre cae en una casilla distinta de COMMAND_SLOTS,
+// así que identificar un comando es un hash + una comparación.
+// Para agregar un comando basta con sumarlo a CommandId y COMMAND_NAMES
+// (en el mismo orden); si no hubiera semilla falla el static_assert.
+// =============================================
+enum CommandId {
+    CMD_UNKNOWN = 0,
+    CMD_MKDISK,
+    CMD_RMDISK,
+    CMD_FDISK,
+    CMD_MOUNT,
+    CMD_MOUNTED,
+    CMD_UNMOUNT,
+    CMD_MKFS,
+    CMD_LOGIN,
+    CMD_LOGOUT,
+    CMD_SYNC,
+    CMD_FREESPACE,
+    CMD_FSCK,
+    CMD_REP,
+    CMD_CONVERT,
+};
+
+constexpr EnumName<CommandId> COMMAND_NAMES[] = {
+    {"mkdisk",    CMD_MKDISK},
+    {"rmdisk",    CMD_RMDISK},
+    {"fdisk",     CMD_FDISK},
+    {"mount",     CMD_MOUNT},
+    {"mounted",   CMD_MOUNTED},
+    {"unmount",   CMD_UNMOUNT},
+    {"mkfs",      CMD_MKFS},
+    {"login",     CMD_LOGIN},
+    {"logout",    CMD_LOGOUT},
+    {"sync",      CMD_SYNC},
+    {"freespace", CMD_FREESPACE},
+    {"fsck",      CMD_FSCK},
+    {"rep",       CMD_REP},
+    {"convert",   CMD_CONVERT},
+};
+
+constexpr size_t COMMAND_COUNT = sizeof(COMMAND_NAMES) / sizeof(COMMAND_NAMES[0]);
+constexpr size_t COMMAND_SLOTS = 64;
+
+// FNV-1a sobre el nombre en minúsculas
+constexpr uint32_t commandHash(std::string_view s, uint32_t seed) {
+    uint32_t h = 2166136261u ^ (seed * 0x9e3779b9u);
+    for(char c : s) {
+        h ^= (unsigned char)lowerAscii(c);
+        h *= 16777619u;
+    }
+    return (h ^ (h >> 15)) % COMMAND_SLOTS;
+}
+
+constexpr bool isPerfectSeed(uint32_t seed) {
+    bool used[COMMAND_SLOTS] = {};
+    for(const auto& entry : COMMAND_NAMES) {
+        uint32_t slot = commandHash(entry.name, seed);
+        if(used[slot]) return false;
+        used[slot] = true;
+    }
+    return true;
+}
+
+constexpr uint32_t findCommandSeed() {
+    for(uint32_t seed = 0; seed < 4096; seed++)
+        if(isPerfectSeed(seed)) return seed;
+    return UINT32_MAX;
+}
+
+constexpr uint32_t COMMAND_SEED = findCommandSeed();
+static_assert(COMMAND_SEED != UINT32_MAX, "no hay semilla de hash perfecto para COMMAND_NAMES");
+
+constexpr bool commandNamesInOrder() {
+    // lookupCommand usa COMMAND_NAMES[id - 1]
+    for(size_t i = 0; i < COMMAND_COUNT; i++)
+        if(COMMAND_NAMES[i].value != (CommandId)(i + 1)) return false;
+    return true;
+}
+static_assert(commandNamesInOrder(), "COMMAND_NAMES debe seguir el orden de CommandId");
+
+constexpr std::array<CommandId, COMMAND_SLOTS> buildCommandTable() {
+    std::array<CommandId, COMMAND_SLOTS> table{};
+    for(const auto& entry : COMMAND_NAMES) table[commandHash(entry.name, COMMAND_SEED)] = entry.value;
+    return table;
+}
+
+constexpr std::array<CommandId, COMMAND_SLOTS> COMMAND_TABLE = buildCommandTable();
+
+inline CommandId lookupCommand(std::string_view name) {
+    CommandId id = COMMAND_TABLE[commandHash(name, COMMAND_SEED)];
+    if(id == CMD_UNKNOWN) return CMD_UNKNOWN;
+    return iequals(name, COMMAND_NAMES[id - 1].name) ? id : CMD_UNKNOWN;
+}
+
+#endif // COMMANDPARSER_H
@@ -0,0 +1,569 @@
+#ifndef DIRINDEX_H
+#define DIRINDEX_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include "../structs/Structs.h"
+#include "DiskView.h"
+#include "InodeBlocks.h"
+#include "Bitmap.h"
+#include "FileIO.h"
+
+// Largo máximo de un nombre en Content::b_name
+#define MAX_NAME_LEN 12
+
+// Entrada oculta (casilla 2 del primer bloque) que apunta al índice
+#define DIRINDEX_NAME  ".htree"
+#define DIRINDEX_MAGIC 0x48545245   // "HTRE"
+
+// Una carpeta sin índice que pasa de estos bloques se indexa al agregar
+#define DIRINDEX_MIN_BLOCKS 8
+
+// Tope de niveles de nodos (más es un índice dañado)
+#define HTREE_MAX_LEVELS 32
+
+// Encabezado del índice (bloque lógico 0 de su inodo)
+struct DirIndexHeader {
+    int32_t magic;
+    int32_t root;     // bloque del nodo raíz
+    int32_t levels;   // niveles sobre los nodos de nivel 0
+    int32_t blocks;   // bloques lógicos de la carpeta (el siguiente va al final)
+    int32_t nodes;    // bloques lógicos del inodo índice
+    int32_t reserved[11];
+
+    DirIndexHeader() : magic(DIRINDEX_MAGIC), root(-1), levels(0), blocks(0), nodes(0) {
+        for(int i = 0; i < 11; i++) reserved[i] = 0;
+    }
+};
+
+// Hijo de un nodo: todo lo que tiene hash >= 'hash' (hasta el siguiente)
+struct HTreeEntry {
+    uint32_t hash;
+    int32_t  block;
+};
+
+// Nodo: en nivel 0 los hijos son hojas (bloques carpeta de la carpeta);
+// en los demás, otros nodos. En disco ocupa un bloque completo como
+// enteros de 32 bits: count, level y un par (hash, bloque) por hijo,
+// así que entran (s_block_s / 4 - 2) / 2 hijos (7 en bloques de 64).
+struct HTreeNode {
+    int32_t                 count = 0;
+    int32_t                 level = 0;
+    std::vector<HTreeEntry> entries;
+};
+
+template<> struct DiskLayout<DirIndexHeader> {
+    static constexpr DiskField FIELDS[] = {
+        DISK_FIELD(DirIndexHeader, magic,     0),
+        DISK_FIELD(DirIndexHeader, root,      4),
+        DISK_FIELD(DirIndexHeader, levels,    8),
+        DISK_FIELD(DirIndexHeader, blocks,   12),
+        DISK_FIELD(DirIndexHeader, nodes,    16),
+        DISK_FIELD(DirIndexHeader, reserved, 20),
+    };
+};
+
+// El encabezado ocupa el inicio de un bloque (el resto queda en cero)
+static_assert(diskLayoutMatches<DirIndexHeader>(BLOCK_SIZE_MIN), "DirIndexHeader no coincide con su formato en disco");
+
+// =============================================
+// DIR INDEX
+// Índice opcional para carpetas grandes, al estilo del htree de ext3:
+// un árbol B+ ordenado por el hash del nombre cuyas hojas son los
+// bloques carpeta de la carpeta. Buscar baja un nodo por nivel hasta la
+// única hoja que puede tener el nombre; agregar a una hoja llena la
+// divide por el hash del medio y sube el corte al nodo padre (que se
+// divide a su vez si está lleno).
+//
+// El índice es un inodo archivo enlazado como ".htree" en la casilla 2
+// del primer bloque (junto a "." y ".."), con el encabezado en su
+// bloque 0 y los nodos en los siguientes. Las hojas siguen siendo
+// bloques carpeta normales: sin el índice, el recorrido lineal
+// encuentra todo, y fsck ve los bloques del índice como los de un
+// archivo.
+//
+// Modificar requiere el candado exclusivo del disco; buscar, el
+// compartido. El hash queda guardado en disco: no debe cambiar.
+// =============================================
+class DirIndex {
+public:
+    // FNV-1a con mezcla final
+    static uint32_t hash(std::string_view name) {
+        uint32_t h = 2166136261u;
+        for(char c : name) {
+            h ^= (unsigned char)c;
+            h *= 16777619u;
+        }
+        h ^= h >> 16; h *= 0x85ebca6bu;
+        h ^= h >> 13; h *= 0xc2b2ae35u;
+        h ^= h >> 16;
+        return h;
+    }
+
+    // Nombre que puede tener una entrada creada por el usuario
+    static bool validName(std::string_view name) {
+        return !name.empty() && name.size() <= MAX_NAME_LEN &&
+               name != "." && name != ".." && name != DIRINDEX_NAME;
+    }
+
+    // Inodo del índice de la carpeta, o -1 si no tiene (o no es válido)
+    static int indexOf(PartitionView& fs, const Inode& dir) {
+        if(dir.i_type != '0' || !validBlock(fs, dir.i_block[0])) return -1;
+        const Content& c = fs.folder(dir.i_block[0])[2];
+        if(c.b_inodo < 0 || c.b_inodo >= fs.sb().s_inodes_count || entryName(c) != DIRINDEX_NAME)
+            return -1;
+        const Inode& idx = fs.inode(c.b_inodo);
+        if(idx.i_type != '1' || !validBlock(fs, idx.i_block[0])) return -1;
+        const DirIndexHeader& hdr = fs.block<DirIndexHeader>(idx.i_block[0]);
+        if(hdr.magic != DIRINDEX_MAGIC || !validBlock(fs, hdr.root) ||
+           hdr.levels < 0 || hdr.levels > HTREE_MAX_LEVELS)
+            return -1;
+        return c.b_inodo;
+    }
+
+    // Inodo de 'name' dentro de la carpeta 'dir'; -1 si no existe
+    static int find(PartitionView& fs, int dir, std::string_view name) {
+        const Inode& inode = fs.inode(dir);
+        if(inode.i_type != '0' || name.empty() || name.size() > MAX_NAME_LEN || name == DIRINDEX_NAME)
+            return -1;
+
+        // "." y ".." están en el primer bloque, que no es una hoja
+        int idx  = validName(name) ? indexOf(fs, inode) : -1;
+        int leaf = (idx < 0) ? -1 : descend(fs, header(fs, idx), hash(name), nullptr);
+        if(leaf < 0) return scanFind(fs, inode, name);
+
+        const Content* entries = fs.folder(leaf);
+        for(int k = 0; k < fs.folderEntries(); k++)
+            if(entries[k].b_inodo != -1 && entryName(entries[k]) == name) return entries[k].b_inodo;
+        return -1;
+    }
+
+    // Agrega la entrada 'name' -> 'child'. Una carpeta sin índice que
+    // pasa de DIRINDEX_MIN_BLOCKS se indexa; si el índice no puede
+    // crecer más se descarta y la carpeta vuelve a ser lineal.
+    static bool add(PartitionView& fs, BitmapAllocator& alloc, int dir,
+                    std::string_view name, int child, std::string& error) {
+        if(!validName(name)) { error = "nombre inválido: " + std::string(name); return false; }
+        if(fs.inode(dir).i_type != '0') { error = "no es una carpeta"; return false; }
+
+        int idx = indexOf(fs, fs.inode(dir));
+        if(idx >= 0) {
+            if(find(fs, dir, name) != -1) { error = "ya existe: " + std::string(name); return false; }
+            if(insert(fs, alloc, dir, idx, name, child, nullptr)) return true;
+            drop(fs, alloc, dir);
+        }
+
+        long long blocks = 0;
+        if(!linearAdd(fs, alloc, dir, name, child, blocks, error)) return false;
+        // Cerca del máximo de bloques de un inodo ya no conviene indexar:
+        // las hojas a medio llenar no alcanzarían
+        if(idx < 0 && blocks > DIRINDEX_MIN_BLOCKS && blocks < InodeBlocks::maxBlocks(fs) / 2)
+            build(fs, alloc, dir);
+        return true;
+    }
+
+    // Quita la entrada 'name' (el bloque queda en la carpeta)
+    static bool remove(PartitionView& fs, int dir, std::string_view name) {
+        if(!validName(name)) return false;
+        const Inode& inode = fs.inode(dir);
+        int idx  = indexOf(fs, inode);
+        int leaf = (idx < 0) ? -1 : descend(fs, header(fs, idx), hash(name), nullptr);
+
+        bool removed = false;
+        auto clear = [&](long long, int blockNo) {
+            const Content* entries = fs.folder(blockNo);
+            for(int k = 0; k < fs.folderEntries(); k++) {
+                if(entries[k].b_inodo == -1 || entryName(entries[k]) != name) continue;
+                fs.folderMut(blockNo)[k] = Content();
+                removed = true;
+                return false;
+            }
+            return true;
+        };
+        if(leaf >= 0) clear(0, leaf);
+        else          InodeBlocks::forEach(fs, inode, clear);
+        return removed;
+    }
+
+    // Arma el índice de una carpeta que no lo tiene: vacía sus bloques
+    // (menos el primero) y vuelve a agregar las entradas por el árbol,
+    // usando esos bloques como hojas antes de pedir nuevos. false si la
+    // carpeta no tiene la forma esperada ("." y ".." al inicio) o no
+    // hubo espacio.
+    static bool build(PartitionView& fs, BitmapAllocator& alloc, int dir) {
+        const Inode inode = fs.inode(dir);
+        if(inode.i_type != '0' || !validBlock(fs, inode.i_block[0]) || indexOf(fs, inode) >= 0) return false;
+        const Content* first = fs.folder(inode.i_block[0]);
+        if(entryName(first[0]) != "." || entryName(first[1]) != "..") return false;
+
+        std::vector<Content> entries;
+        std::vector<int>     leaves;
+        long long            last = 0;
+        InodeBlocks::forEach(fs, inode, [&](long long logical, int blockNo) {
+            last = logical;
+            const Content* fb = fs.folder(blockNo);
+            for(int k = (logical == 0) ? 2 : 0; k < fs.folderEntries(); k++)
+                if(fb[k].b_inodo != -1) entries.push_back(fb[k]);
+            if(logical > 0) leaves.push_back(blockNo);
+            return true;
+        });
+
+        DirIndexHeader hdr;
+        hdr.blocks = (int)(last + 1);
+        if(leaves.empty()) {
+            int leaf = alloc.allocBlock();
+            if(leaf < 0) return false;
+            if(!FileIO::attach(fs, alloc, dir, hdr.blocks, leaf)) { alloc.freeBlock(leaf); return false; }
+            leaves.push_back(leaf);
+            hdr.blocks++;
+        }
+
+        int idx = alloc.allocInode();
+        if(idx < 0) return false;
+        Inode index;
+        index.i_uid  = inode.i_uid;
+        index.i_gid  = inode.i_gid;
+        index.i_type = '1';
+        fs.inodeMut(idx) = index;
+
+        // Bloque 0: encabezado; bloque 1: la raíz, con la primera hoja
+        std::vector<int> blocks;
+        if(!reserve(alloc, 2, blocks) || !attachAll(fs, alloc, idx, 0, blocks)) {
+            FileIO::release(fs, alloc, fs.inodeMut(idx));
+            alloc.freeInode(idx);
+            return false;
+        }
+        HTreeNode root = emptyNode(fs);
+        root.count      = 1;
+        root.entries[0] = {0, leaves[0]};
+        storeNode(fs, blocks[1], root);
+        hdr.root  = blocks[1];
+        hdr.nodes = 2;
+        fs.inodeMut(idx).i_s = hdr.nodes * fs.blockSize();
+        fs.blockMut<DirIndexHeader>(blocks[0]) = hdr;
+
+        for(int leaf : leaves) fs.clearFolder(leaf);
+        Content* head = fs.folderMut(inode.i_block[0]);
+        std::fill(head + 2, head + fs.folderEntries(), Content());
+        std::strncpy(head[2].b_name, DIRINDEX_NAME, MAX_NAME_LEN);
+        head[2].b_inodo = idx;
+
+        // Los demás bloques viejos son las próximas hojas, en orden
+        std::vector<int> spare(leaves.rbegin(), leaves.rend() - 1);
+        for(size_t i = 0; i < entries.size(); i++) {
+            if(insert(fs, alloc, dir, idx, entryName(entries[i]), entries[i].b_inodo, &spare)) continue;
+            // No se pudo: la carpeta queda lineal con lo que ya se repartió
+            drop(fs, alloc, dir);
+            std::string error;
+            for(size_t j = i; j < entries.size(); j++) {
+                long long ignored;
+                linearAdd(fs, alloc, dir, entryName(entries[j]), entries[j].b_inodo, ignored, error);
+            }
+            return false;
+        }
+        return true;
+    }
+
+    // Quita el índice (libera su inodo y sus bloques); la carpeta sigue
+    // completa para el recorrido lineal
+    static void drop(PartitionView& fs, BitmapAllocator& alloc, int dir) {
+        int idx = indexOf(fs, fs.inode(dir));
+        if(idx < 0) return;
+        FileIO::release(fs, alloc, fs.inodeMut(idx));
+        alloc.freeInode(idx);
+        fs.folderMut(fs.inode(dir).i_block[0])[2] = Content();
+    }
+
+private:
+    // Nodo visitado al bajar y posición del hijo que se tomó
+    struct Step {
+        int node;
+        int pos;
+    };
+
+    static std::string_view entryName(const Content& c) {
+        return std::string_view(c.b_name, strnlen(c.b_name, MAX_NAME_LEN));
+    }
+
+    static bool validBlock(PartitionView& fs, int blockNo) {
+        return blockNo >= 0 && blockNo < fs.sb().s_blocks_count;
+    }
+
+    static DirIndexHeader header(PartitionView& fs, int idx) {
+        return fs.block<DirIndexHeader>(fs.inode(idx).i_block[0]);
+    }
+
+    static void setHeader(PartitionView& fs, int idx, const DirIndexHeader& hdr) {
+        fs.blockMut<DirIndexHeader>(fs.inode(idx).i_block[0]) = hdr;
+        fs.inodeMut(idx).i_s = hdr.nodes * fs.blockSize();
+    }
+
+    // Hijos que entran en un nodo
+    static int fanout(PartitionView& fs) {
+        return (fs.blockWords() - 2) / 2;
+    }
+
+    static HTreeNode emptyNode(PartitionView& fs) {
+        HTreeNode node;
+        node.entries.assign(fanout(fs), {0, -1});
+        return node;
+    }
+
+    static HTreeNode loadNode(PartitionView& fs, int blockNo) {
+        const int32_t* w = fs.words(blockNo);
+        HTreeNode node = emptyNode(fs);
+        node.count = w[0];
+        node.level = w[1];
+        for(size_t k = 0; k < node.entries.size(); k++)
+            node.entries[k] = {(uint32_t)w[2 + 2 * k], w[3 + 2 * k]};
+        return node;
+    }
+
+    static void storeNode(PartitionView& fs, int blockNo, const HTreeNode& node) {
+        int32_t* w = fs.wordsMut(blockNo);
+        w[0] = node.count;
+        w[1] = node.level;
+        for(size_t k = 0; k < node.entries.size(); k++) {
+            w[2 + 2 * k] = (int32_t)node.entries[k].hash;
+            w[3 + 2 * k] = node.entries[k].block;
+        }
+    }
+
+    // Hoja que corresponde al hash 'h' (-1 si el árbol está dañado);
+    // 'path' queda con los nodos de la raíz hacia abajo
+    static int descend(PartitionView& fs, const DirIndexHeader& hdr, uint32_t h, std::vector<Step>* path) {
+        int blockNo = hdr.root;
+        for(int level = hdr.levels; level >= 0; level--) {
+            if(!validBlock(fs, blockNo)) return -1;
+            // Se lee el nodo en el lugar: count, level y pares (hash, bloque)
+            const int32_t* w = fs.words(blockNo);
+            int count = w[0];
+            if(count < 1 || count > fanout(fs) || w[1] != level) return -1;
+            // Último hijo con hash <= h (los hijos están ordenados por hash)
+            int lo = 0, hi = count - 1;
+            while(lo < hi) {
+                int mid = (lo + hi + 1) / 2;
+                if((uint32_t)w[2 + 2 * mid] <= h) lo = mid;
+                else                              hi = mid - 1;
+            }
+            if(path) path->push_back({blockNo, lo});
+            blockNo = w[3 + 2 * lo];
+        }
+        return validBlock(fs, blockNo) ? blockNo : -1;
+    }
+
+    // Pide 'n' bloques; si no hay tantos no se queda con ninguno
+    static bool reserve(BitmapAllocator& alloc, int n, std::vector<int>& out) {
+        for(int i = 0; i < n; i++) {
+            int blockNo = alloc.allocBlock();
+            if(blockNo < 0) {
+                for(int got : out) alloc.freeBlock(got);
+                out.clear();
+                return false;
+            }
+            out.push_back(blockNo);
+        }
+        return true;
+    }
+
+    // Enlaza 'blocks' al inodo desde el bloque lógico 'from'; los que no
+    // se pudieron enlazar se liberan
+    static bool attachAll(PartitionView& fs, BitmapAllocator& alloc, int inodeNo,
+                          long long from, const std::vector<int>& blocks) {
+        for(size_t i = 0; i < blocks.size(); i++) {
+            if(FileIO::attach(fs, alloc, inodeNo, from + (long long)i, blocks[i])) continue;
+            for(size_t j = i; j < blocks.size(); j++) alloc.freeBlock(blocks[j]);
+            return false;
+        }
+        return true;
+    }
+
+    // Agrega con el índice; false si no se pudo (nombres con el mismo
+    // hash que no se pueden separar, carpeta o índice sin lugar para
+    // otro bloque, o sin bloques libres). Los bloques se piden antes de
+    // tocar el árbol, así un false lo deja como estaba.
+    static bool insert(PartitionView& fs, BitmapAllocator& alloc, int dir, int idx,
+                       std::string_view name, int child, std::vector<int>* spare) {
+        uint32_t          h   = hash(name);
+        DirIndexHeader    hdr = header(fs, idx);
+        std::vector<Step> path;
+        int leaf = descend(fs, hdr, h, &path);
+        if(leaf < 0) return false;
+
+        Content entry;
+        std::memcpy(entry.b_name, name.data(), name.size());
+        entry.b_inodo = child;
+
+        int slots = fs.folderEntries();
+        const Content* current = fs.folder(leaf);
+        for(int k = 0; k < slots; k++) {
+            if(current[k].b_inodo != -1) continue;
+            fs.folderMut(leaf)[k] = entry;
+            return true;
+        }
+
+        // Hoja llena: sus entradas y la nueva por hash, cortando donde el
+        // hash cambia lo más cerca posible del medio
+        std::vector<std::pair<uint32_t, Content>> all;
+        for(int k = 0; k < slots; k++) all.push_back({hash(entryName(current[k])), current[k]});
+        all.push_back({h, entry});
+        std::stable_sort(all.begin(), all.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+        int total = (int)all.size(), mid = total / 2, cut = -1;
+        for(int d = 0; d < total && cut < 0; d++) {
+            int m = (d % 2 == 0) ? mid - d / 2 : mid + (d + 1) / 2;
+            if(m >= 1 && m < total && all[m - 1].first != all[m].first) cut = m;
+        }
+        if(cut < 0) return false;
+
+        // Los nodos llenos desde abajo se dividen todos; si también lo
+        // está la raíz, hace falta una raíz nueva
+        int fan  = fanout(fs);
+        int full = 0;
+        while(full < (int)path.size() &&
+              fs.words(path[path.size() - 1 - full].node)[0] == fan) full++;
+        int newNodes = full + (full == (int)path.size() ? 1 : 0);
+        long long maxBlocks = InodeBlocks::maxBlocks(fs);
+        if(hdr.levels + (full == (int)path.size() ? 1 : 0) > HTREE_MAX_LEVELS) return false;
+        if(hdr.nodes + newNodes > maxBlocks) return false;
+
+        bool useSpare = spare && !spare->empty();
+        if(!useSpare && hdr.blocks >= maxBlocks) return false;
+        std::vector<int> fresh;
+        if(!reserve(alloc, newNodes + (useSpare ? 0 : 1), fresh)) return false;
+        int newLeaf;
+        if(useSpare) {
+            newLeaf = spare->back();
+            spare->pop_back();
+        } else {
+            newLeaf = fresh.back();
+            fresh.pop_back();
+            // Queda en la carpeta aunque falle lo que sigue: sin basura
+            fs.clearFolder(newLeaf);
+            if(!FileIO::attach(fs, alloc, dir, hdr.blocks, newLeaf)) {
+                alloc.freeBlock(newLeaf);
+                for(int b : fresh) alloc.freeBlock(b);
+                return false;
+            }
+            hdr.blocks++;
+        }
+        if(!attachAll(fs, alloc, idx, hdr.nodes, fresh)) {
+            setHeader(fs, idx, hdr);
+            return false;
+        }
+        hdr.nodes += (int)fresh.size();
+
+        std::vector<Content> left(slots), right(slots);
+        for(int i = 0; i < total; i++) {
+            if(i < cut) left[i]        = all[i].second;
+            else        right[i - cut] = all[i].second;
+        }
+        std::copy(left.begin(),  left.end(),  fs.folderMut(leaf));
+        std::copy(right.begin(), right.end(), fs.folderMut(newLeaf));
+
+        // Sube el corte: (hash, bloque) va a la derecha del hijo tomado
+        HTreeEntry up   = {all[cut].first, newLeaf};
+        size_t     next = 0;
+        for(int i = (int)path.size() - 1; i >= 0; i--) {
+            HTreeNode node = loadNode(fs, path[i].node);
+            int pos = path[i].pos + 1;
+            if(node.count < fan) {
+                for(int k = node.count; k > pos; k--) node.entries[k] = node.entries[k - 1];
+                node.entries[pos] = up;
+                node.count++;
+                storeNode(fs, path[i].node, node);
+                setHeader(fs, idx, hdr);
+                return true;
+            }
+            std::vector<HTreeEntry> merged(fan + 1);
+            for(int k = 0, j = 0; k <= fan; k++)
+                merged[k] = (k == pos) ? up : node.entries[j++];
+            HTreeNode left = emptyNode(fs), right = emptyNode(fs);
+            left.level  = right.level = node.level;
+            left.count  = (fan + 1) / 2;
+            right.count = fan + 1 - left.count;
+            for(int k = 0; k < left.count;  k++) left.entries[k]  = merged[k];
+            for(int k = 0; k < right.count; k++) right.entries[k] = merged[left.count + k];
+            int sibling = fresh[next++];
+            storeNode(fs, path[i].node, left);
+            storeNode(fs, sibling,      right);
+            up = {right.entries[0].hash, sibling};
+        }
+
+        // Se dividió la raíz: la nueva tiene las dos mitades
+        HTreeNode root = emptyNode(fs);
+        root.level      = hdr.levels + 1;
+        root.count      = 2;
+        root.entries[0] = {0, hdr.root};
+        root.entries[1] = up;
+        hdr.root = fresh[next];
+        hdr.levels++;
+        storeNode(fs, hdr.root, root);
+        setHeader(fs, idx, hdr);
+        return true;
+    }
+
+    // Recorrido lineal (carpetas sin índice)
+    static int scanFind(PartitionView& fs, const Inode& inode, std::string_view name) {
+        int found = -1;
+        InodeBlocks::forEach(fs, inode, [&](long long, int blockNo) {
+            const Content* entries = fs.folder(blockNo);
+            for(int k = 0; k < fs.folderEntries(); k++) {
+                const Content& c = entries[k];
+                if(c.b_inodo != -1 && entryName(c) == name) { found = c.b_inodo; return false; }
+            }
+            return true;
+        });
+        return found;
+    }
+
+    // Primera casilla libre de la carpeta (o un bloque nuevo al final);
+    // 'blocks' queda con los bloques lógicos de la carpeta
+    static bool linearAdd(PartitionView& fs, BitmapAllocator& alloc, int dir, std::string_view name,
+                          int child, long long& blocks, std::string& error) {
+        const Inode inode = fs.inode(dir);
+        long long last = -1;
+        int  freeBlock = -1, freeSlot = -1;
+        bool exists    = false;
+        InodeBlocks::forEach(fs, inode, [&](long long logical, int blockNo) {
+            last = logical;
+            const Content* entries = fs.folder(blockNo);
+            for(int k = 0; k < fs.folderEntries(); k++) {
+                const Content& c = entries[k];
+                if(c.b_inodo == -1) {
+                    if(freeBlock < 0) { freeBlock = blockNo; freeSlot = k; }
+                } else if(entryName(c) == name) {
+                    exists = true;
+                    return false;
+                }
+            }
+            return true;
+        });
+        blocks = last + 1;
+        if(exists) { error = "ya existe: " + std::string(name); return false; }
+
+        if(freeBlock < 0) {
+            freeBlock = alloc.allocBlock();
+            if(freeBlock < 0) { error = "no hay bloques libres"; return false; }
+            fs.clearFolder(freeBlock);
+            if(!FileIO::attach(fs, alloc, dir, blocks, freeBlock)) {
+                alloc.freeBlock(freeBlock);
+                error = "la carpeta está llena";
+                return false;
+            }
+            freeSlot = 0;
+            blocks++;
+        }
+        Content& c = fs.folderMut(freeBlock)[freeSlot];
+        c = Content();
+        std::memcpy(c.b_name, name.data(), name.size());
+        c.b_inodo = child;
+        return true;
+    }
+};
+
+#endif // DIRINDEX_H
@@ -0,0 +1,64 @@
+#ifndef DISKLOCKS_H
+#define DISKLOCKS_H
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <cstdio>
+#include "DiskManager.h"
+
+// Candado exclusivo de un disco. Al soltarlo se confirma la transacción
+// de lo que se escribió mientras se tenía (ver CachedDisk::commit), así
+// cada comando queda en el journal como una sola transacción.
+class ExclusiveLock {
+public:
+    ExclusiveLock(const std::string& path, std::shared_mutex& mtx)
+        : path(path), lock(mtx) {}
+
+    ~ExclusiveLock() {
+        if(!DiskManager::commit(path))
+            fprintf(stderr, "Journal: no se pudo confirmar la transacción de %s\n", path.c_str());
+    }
+
+    ExclusiveLock(const ExclusiveLock&)            = delete;
+    ExclusiveLock& operator=(const ExclusiveLock&) = delete;
+
+private:
+    std::string                         path;
+    std::unique_lock<std::shared_mutex> lock;   // se suelta después del commit
+};
+
+// Un candado lector/escritor por ruta de disco.
+// Los comandos que modifican un disco toman el candado exclusivo;
+// los que solo leen (login) toman el compartido. Así dos discos
+// distintos se procesan en paralelo sin mezclar escrituras.
+// Todo lo que se escribe a un disco se hace con su candado exclusivo.
+class DiskLocks {
+public:
+    static std::shared_mutex& get(const std::string& path) {
+        std::lock_guard<std::mutex> lock(tableMutex);
+        auto& slot = table[path];
+        if(!slot) slot = std::make_unique<std::shared_mutex>();
+        return *slot;
+    }
+
+    static ExclusiveLock exclusive(const std::string& path) {
+        return ExclusiveLock(path, get(path));
+    }
+
+    static std::shared_lock<std::shared_mutex> shared(const std::string& path) {
+        return std::shared_lock<std::shared_mutex>(get(path));
+    }
+
+private:
+    static std::mutex tableMutex;
+    static std::unordered_map<std::string, std::unique_ptr<std::shared_mutex>> table;
+};
+
+// Definiciones estáticas
+std::mutex DiskLocks::tableMutex;
+std::unordered_map<std::string, std::unique_ptr<std::shared_mutex>> DiskLocks::table;
+
+#endif // DISKLOCKS_H
@@ -0,0 +1,898 @@
+#ifndef DISKMANAGER_H
+#define DISKMANAGER_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <cstring>
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <climits>
+#include <cstdio>
+#include "../structs/Layout.h"
+
+// Tamaño de página del caché (bytes)
+#define DISK_PAGE_SIZE 4096
+// Bytes de ceros por segmento cuando zero() no puede hacer hueco
+#define DISK_ZERO_CHUNK (1024 * 1024)
+// Al pasar este tamaño el journal hace checkpoint y vuelve a cero
+#define JOURNAL_MAX_BYTES (8LL * 1024 * 1024)
+
+// Estadísticas de un disco abierto
+struct DiskStats {
+    std::string path;
+    std::string backend;
+    long long   hits   = 0;
+    long long   misses = 0;
+    size_t      cached = 0; // páginas en memoria
+    size_t      dirty  = 0; // páginas modificadas sin escribir
+    long long   commits = 0; // transacciones en el journal (-1 = sin journal)
+    long long   fsyncs  = 0; // fsync/fdatasync hechos por el journal
+};
+
+// pwritev completo (reintenta escrituras parciales y EINTR)
+inline bool pwritevAll(int fd, std::vector<iovec> iov, long long offset) {
+    size_t first = 0;
+    while(first < iov.size()) {
+        int     count = (int)std::min<size_t>(iov.size() - first, IOV_MAX);
+        ssize_t n     = pwritev(fd, iov.data() + first, count, offset);
+        if(n < 0 && errno == EINTR) continue;
+        if(n <= 0) return false;
+        offset += n;
+        // Avanzar sobre los segmentos ya escritos (escritura parcial)
+        while(n > 0 && first < iov.size()) {
+            if((size_t)n >= iov[first].iov_len) {
+                n -= iov[first].iov_len;
+                first++;
+            } else {
+                iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + n;
+                iov[first].iov_len -= n;
+                n = 0;
+            }
+        }
+        while(first < iov.size() && iov[first].iov_len == 0) first++;
+    }
+    return true;
+}
+
+// =============================================
+// JOURNAL
+// Bitácora de rehacer, estilo EXT3, en un archivo al lado del disco
+// ("disco.mia.journal"). Cada transacción se agrega con una sola
+// escritura vectorizada y un solo fdatasync:
+//   JournalHeader | (número de página, 4096 bytes) x N | JournalCommit
+// Una transacción cuenta solo si su JournalCommit está completo y el
+// checksum coincide; replay() aplica en orden las transacciones
+// completas y se detiene en la primera cortada (caída a la mitad).
+// =============================================
+class Journal {
+public:
+    // Página completa que entra en una transacción
+    struct PageImage {
+        long long   no;
+        const char* data;
+    };
+
+    explicit Journal(const std::string& diskPath)
+        : path(diskPath + ".journal") {
+        fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if(fd >= 0) end = lseek(fd, 0, SEEK_END);
+    }
+
+    ~Journal() { if(fd >= 0) close(fd); }
+
+    Journal(const Journal&)            = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    bool ok() const { return fd >= 0; }
+    long long size() const { return end; }
+    long long syncs() const { return fsyncs; }
+
+    // Agrega una transacción y la deja en el medio físico
+    bool append(const std::vector<PageImage>& pages) {
+        if(fd < 0 || pages.empty()) return false;
+        JournalHeader header;
+        header.magic = HEADER_MAGIC;
+        header.pages = (uint32_t)pages.size();
+        header.seq   = ++seq;
+
+        JournalCommit commit;
+        commit.magic    = COMMIT_MAGIC;
+        commit.pages    = header.pages;
+        commit.seq      = header.seq;
+        commit.checksum = FNV_OFFSET;
+
+        std::vector<uint64_t> numbers(pages.size());
+        std::vector<iovec> iov;
+        iov.reserve(pages.size() * 2 + 2);
+        iov.push_back({&header, sizeof(header)});
+        for(size_t i = 0; i < pages.size(); i++) {
+            numbers[i] = (uint64_t)pages[i].no;
+            commit.checksum = fnv(commit.checksum, &numbers[i], sizeof(uint64_t));
+            commit.checksum = fnv(commit.checksum, pages[i].data, DISK_PAGE_SIZE);
+            iov.push_back({&numbers[i], sizeof(uint64_t)});
+            iov.push_back({const_cast<char*>(pages[i].data), DISK_PAGE_SIZE});
+        }
+        iov.push_back({&commit, sizeof(commit)});
+
+        if(!pwritevAll(fd, iov, end)) {
+            // Lo escrito a medias queda detrás de 'end': se sobrescribe
+            // con la siguiente transacción y replay() lo ignora
+            return false;
+        }
+        for(const auto& v : iov) end += (long long)v.iov_len;
+        fsyncs++;
+        return fdatasync(fd) == 0;
+    }
+
+    // Aplica las transacciones completas sobre 'diskFd' (de 'diskSize'
+    // bytes) y deja el disco sincronizado. Retorna cuántas aplicó.
+    int replay(int diskFd, long long diskSize) {
+        if(fd < 0) return 0;
+        int       applied = 0;
+        long long pos     = 0;
+        std::vector<char> body;
+        while(true) {
+            JournalHeader header;
+            if(!readAll(&header, sizeof(header), pos) || header.magic != HEADER_MAGIC) break;
+            size_t recordLen = sizeof(uint64_t) + DISK_PAGE_SIZE;
+            if(header.pages == 0 || header.pages > INT_MAX / recordLen) break;
+            body.resize(header.pages * recordLen);
+            if(!readAll(body.data(), body.size(), pos + sizeof(header))) break;
+
+            JournalCommit commit;
+            long long commitPos = pos + (long long)sizeof(header) + (long long)body.size();
+            if(!readAll(&commit, sizeof(commit), commitPos) ||
+               commit.magic != COMMIT_MAGIC || commit.seq != header.seq ||
+               commit.pages != header.pages ||
+               fnv(FNV_OFFSET, body.data(), body.size()) != commit.checksum) break;
+
+            for(uint32_t i = 0; i < header.pages; i++) {
+                const char* record = body.data() + i * recordLen;
+                uint64_t no;
+                std::memcpy(&no, record, sizeof(no));
+                long long offset = (long long)no * DISK_PAGE_SIZE;
+                if(offset >= diskSize) continue;
+                size_t len = (size_t)std::min<long long>(DISK_PAGE_SIZE, diskSize - offset);
+                if(pwrite(diskFd, record + sizeof(uint64_t), len, offset) != (ssize_t)len) return applied;
+            }
+            applied++;
+            seq = header.seq;
+            pos = commitPos + (long long)sizeof(commit);
+        }
+        if(applied > 0 && fsync(diskFd) != 0) return applied;
+        reset();
+        return applied;
+    }
+
+    // Checkpoint: el disco ya tiene todo lo del journal en el medio físico
+    bool reset() {
+        if(fd < 0) return false;
+        end = 0;
+        fsyncs++;
+        return ftruncate(fd, 0) == 0 && fsync(fd) == 0;
+    }
+
+    // Borra el journal de un disco que se recrea o elimina
+    static void remove(const std::string& diskPath) {
+        unlink((diskPath + ".journal").c_str());
+    }
+
+private:
+    static constexpr uint32_t HEADER_MAGIC = 0x4E58544A; // "JTXN"
+    static constexpr uint32_t COMMIT_MAGIC = 0x544D434A; // "JCMT"
+    static constexpr uint64_t FNV_OFFSET   = 1469598103934665603ULL;
+
+    struct JournalHeader {
+        uint32_t magic;
+        uint32_t pages;
+        uint64_t seq;
+    };
+
+    struct JournalCommit {
+        uint32_t magic;
+        uint32_t pages;
+        uint64_t seq;
+        uint64_t checksum;   // FNV-1a de los registros de página
+    };
+
+    std::string path;
+    int         fd     = -1;
+    long long   end    = 0;
+    uint64_t    seq    = 0;
+    long long   fsyncs = 0;
+
+    static uint64_t fnv(uint64_t h, const void* data, size_t len) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for(size_t i = 0; i < len; i++) {
+            h ^= p[i];
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    bool readAll(void* dst, size_t len, long long offset) {
+        char*  out  = static_cast<char*>(dst);
+        size_t done = 0;
+        while(done < len) {
+            ssize_t n = pread(fd, out + done, len - done, offset + done);
+            if(n < 0 && errno == EINTR) continue;
+            if(n <= 0) return false;
+            done += n;
+        }
+        return true;
+    }
+};
+
+// =============================================
+// DISK
+// Interfaz común de los backends de disco. Los comandos leen y
+// escriben structs por offset absoluto dentro del archivo .mia.
+// =============================================
+class Disk {
+public:
+    Disk(const std::string& path, int fd, long long size)
+        : diskPath(path), fd(fd), fileSize(size) {}
+
+    virtual ~Disk() { close(fd); }
+
+    Disk(const Disk&)            = delete;
+    Disk& operator=(const Disk&) = delete;
+
+    const std::string& path() const { return diskPath; }
+    long long size() const { return fileSize; }
+
+    virtual bool read(long long offset, void* dst, size_t len)        = 0;
+    virtual bool write(long long offset, const void* src, size_t len) = 0;
+    virtual bool flush()     = 0; // escribe lo pendiente al archivo
+    virtual void discard()   = 0; // olvida lo pendiente sin escribirlo
+    virtual DiskStats stats() = 0;
+
+    // Cierra la transacción del comando que tiene el candado exclusivo
+    // (ver DiskLocks); sin journal no hay nada que hacer
+    virtual bool commit() { return true; }
+
+    // flush + fsync: los cambios quedan en el medio físico
+    virtual bool sync() {
+        if(!flush()) return false;
+        return fsync(fd) == 0;
+    }
+
+    // Imagen mapeada en memoria, o nullptr si el backend no la tiene
+    virtual char* mapped() { return nullptr; }
+
+    // Lectura masiva sin pasar por el caché de páginas (fsck, reportes).
+    // Puede llamarse desde varios hilos a la vez; lo sucio del caché
+    // debe escribirse antes con flush().
+    virtual bool readDirect(long long offset, void* dst, size_t len) {
+        if(offset < 0 || offset + (long long)len > fileSize) return false;
+        char*  out  = static_cast<char*>(dst);
+        size_t done = 0;
+        while(done < len) {
+            ssize_t n = pread(fd, out + done, len - done, offset + done);
+            if(n < 0 && errno == EINTR) continue;
+            if(n <= 0) return false;
+            done += n;
+        }
+        return true;
+    }
+
+    // Escritura vectorizada de una región contigua que empieza en 'offset'
+    // (una sola llamada pwritev por cada IOV_MAX segmentos). Pensada para
+    // escrituras masivas como mkfs; no pasa por el caché de páginas.
+    virtual bool writev(long long offset, const std::vector<iovec>& iov) {
+        size_t total = 0;
+        for(const auto& v : iov) total += v.iov_len;
+        if(offset < 0 || offset + (long long)total > fileSize) return false;
+        return pwritevAll(fd, iov, offset);
+    }
+
+    // Rellena [offset, offset+len) con el byte 'value'
+    bool fill(long long offset, char value, size_t len) {
+        char buf[DISK_PAGE_SIZE];
+        std::memset(buf, value, sizeof(buf));
+        while(len > 0) {
+            size_t chunk = std::min(len, sizeof(buf));
+            if(!write(offset, buf, chunk)) return false;
+            offset += chunk; len -= chunk;
+        }
+        return true;
+    }
+
+    // Pone en cero [offset, offset+len). Las páginas completas se sueltan
+    // con fallocate(PUNCH_HOLE): el archivo queda disperso ahí y se lee
+    // como ceros sin escribir nada. Si el sistema de archivos no lo
+    // permite se escriben ceros en segmentos de DISK_ZERO_CHUNK con
+    // writev (fuera del caché). Los bordes se escriben con fill().
+    bool zero(long long offset, long long len) {
+        if(offset < 0 || len < 0 || offset + len > fileSize) return false;
+        long long first = (offset + DISK_PAGE_SIZE - 1) / DISK_PAGE_SIZE * DISK_PAGE_SIZE;
+        long long last  = (offset + len) / DISK_PAGE_SIZE * DISK_PAGE_SIZE;
+        if(last <= first) return fill(offset, 0, (size_t)len);
+
+        if(!fill(offset, 0, (size_t)(first - offset)) ||
+           !fill(last, 0, (size_t)(offset + len - last))) return false;
+        if(punchHole(first, last - first)) return true;
+
+        static const std::vector<char> zeros(DISK_ZERO_CHUNK, 0);
+        std::vector<iovec> iov;
+        for(long long pos = first; pos < last; ) {
+            size_t chunk = (size_t)std::min<long long>(last - pos, DISK_ZERO_CHUNK);
+            iov.push_back({const_cast<char*>(zeros.data()), chunk});
+            pos += chunk;
+        }
+        return writev(first, iov);
+    }
+
+    // Structs y escalares en el formato del disco (ver Layout.h)
+    template<typename T>
+    bool read(long long offset, T& out) {
+        if(!read(offset, &out, sizeof(T))) return false;
+        diskOrder<T>(&out);
+        return true;
+    }
+
+    template<typename T>
+    bool write(long long offset, const T& in) {
+        char raw[sizeof(T)];
+        diskEncode(in, raw);
+        return write(offset, raw, sizeof(T));
+    }
+
+protected:
+    std::string diskPath;
+    int         fd;
+    long long   fileSize;
+
+    // Libera [offset, offset+len) (alineado a página) del archivo
+    virtual bool punchHole(long long offset, long long len) {
+        return fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, len) == 0;
+    }
+};
+
+// =============================================
+// CACHED DISK (backend "stream")
+// pread/pwrite con un caché de páginas de DISK_PAGE_SIZE bytes y
+// reemplazo LRU. Las escrituras quedan en memoria (páginas sucias)
+// hasta flush(), hasta que la página es desalojada o hasta sync().
+// Con journal, lo que escribe un comando mientras tiene el candado
+// exclusivo es una transacción: esas páginas quedan fijas en el caché
+// (no se desalojan ni se escriben) hasta commit(), que las agrega al
+// journal con un solo fdatasync. Lo que va directo al archivo (writev,
+// zero) es dato en el sentido de EXT3 "ordered": se sincroniza antes
+// del commit, y antes de escribirlo se hace checkpoint para que el
+// replay no pise esa región con una imagen vieja.
+// =============================================
+class CachedDisk : public Disk {
+public:
+    CachedDisk(const std::string& path, int fd, long long size, size_t capacity,
+               bool journaled = false)
+        : Disk(path, fd, size), capacity(capacity == 0 ? 1 : capacity) {
+        if(!journaled) return;
+        journal.reset(new Journal(path));
+        if(!journal->ok()) { journal.reset(); return; }
+        // Una caída dejó transacciones sin pasar al disco: se aplican
+        // antes de leer nada
+        int applied = journal->replay(fd, size);
+        if(applied > 0)
+            fprintf(stderr, "Journal: %d transacciones aplicadas en %s\n", applied, path.c_str());
+    }
+
+    ~CachedDisk() override {
+        std::lock_guard<std::mutex> lock(mtx);
+        if(journal) checkpoint();
+        else        flushUnpinned();
+    }
+
+    using Disk::read;
+    using Disk::write;
+
+    bool read(long long offset, void* dst, size_t len) override {
+        if(offset < 0 || offset + (long long)len > fileSize) return false;
+        std::lock_guard<std::mutex> lock(mtx);
+        char* out = static_cast<char*>(dst);
+        while(len > 0) {
+            long long pageNo = offset / DISK_PAGE_SIZE;
+            size_t    inPage = offset % DISK_PAGE_SIZE;
+            size_t    chunk  = std::min(len, (size_t)DISK_PAGE_SIZE - inPage);
+            Page* page = fetch(pageNo, false);
+            if(page == nullptr) return false;
+            std::memcpy(out, page->data.get() + inPage, chunk);
+            out += chunk; offset += chunk; len -= chunk;
+        }
+        return true;
+    }
+
+    bool write(long long offset, const void* src, size_t len) override {
+        if(offset < 0 || offset + (long long)len > fileSize) return false;
+        std::lock_guard<std::mutex> lock(mtx);
+        const char* in = static_cast<const char*>(src);
+        while(len > 0) {
+            long long pageNo = offset / DISK_PAGE_SIZE;
+            size_t    inPage = offset % DISK_PAGE_SIZE;
+            size_t    chunk  = std::min(len, (size_t)DISK_PAGE_SIZE - inPage);
+            // Si se sobrescribe la página completa no hace falta leerla del disco
+            Page* page = fetch(pageNo, chunk == DISK_PAGE_SIZE);
+            if(page == nullptr || !pin(*page)) return false;
+            std::memcpy(page->data.get() + inPage, in, chunk);
+            page->dirty = true;
+            in += chunk; offset += chunk; len -= chunk;
+        }
+        return true;
+    }
+
+    // Escribe las páginas sucias al archivo (sin fsync); las de la
+    // transacción en curso esperan a su commit
+    bool flush() override {
+        std::lock_guard<std::mutex> lock(mtx);
+        return flushUnpinned();
+    }
+
+    bool sync() override {
+        std::lock_guard<std::mutex> lock(mtx);
+        if(journal) return checkpoint();
+        return flushUnpinned() && fsync(fd) == 0;
+    }
+
+    // Las páginas en caché que toca la región se escriben (si están
+    // sucias) y se descartan antes de la escritura directa. Si alguna
+    // es de la transacción en curso, todo pasa por el caché (y el journal).
+    bool writev(long long offset, const std::vector<iovec>& iov) override {
+        size_t total = 0;
+        for(const auto& v : iov) total += v.iov_len;
+        if(offset < 0 || offset + (long long)total > fileSize) return false;
+        if(total == 0) return true;
+
+        std::unique_lock<std::mutex> lock(mtx);
+        long long firstPage = offset / DISK_PAGE_SIZE;
+        long long lastPage  = (offset + (long long)total - 1) / DISK_PAGE_SIZE;
+        if(pinnedIn(firstPage, lastPage)) {
+            lock.unlock();
+            for(const auto& v : iov) {
+                if(!write(offset, v.iov_base, v.iov_len)) return false;
+                offset += (long long)v.iov_len;
+            }
+            return true;
+        }
+        if(!beforeDirect()) return false;
+        for(auto it = lru.begin(); it != lru.end(); ) {
+            if(it->no < firstPage || it->no > lastPage) { ++it; continue; }
+            if(it->dirty && !writeBack(*it)) return false;
+            index.erase(it->no);
+            it = lru.erase(it);
+        }
+        return pwritevAll(fd, iov, offset);
+    }
+
+    // Agrega al journal las páginas de la transacción (una escritura y
+    // un fdatasync) y las libera para que vayan al disco cuando toque
+    bool commit() override {
+        std::lock_guard<std::mutex> lock(mtx);
+        if(!journal || (txPages.empty() && !txDirect)) return true;
+
+        bool ok = true;
+        if(txDirect) {
+            fsyncs++;
+            if(fdatasync(fd) != 0) ok = false;
+        }
+        std::vector<Journal::PageImage> images;
+        images.reserve(txPages.size());
+        for(long long no : txPages) {
+            auto it = index.find(no);
+            if(it == index.end()) continue;
+            it->second->pinned = false;
+            if(it->second->dirty) images.push_back({no, it->second->data.get()});
+        }
+        std::sort(images.begin(), images.end(),
+                  [](const Journal::PageImage& a, const Journal::PageImage& b) { return a.no < b.no; });
+        if(ok && !images.empty()) {
+            if(journal->append(images)) commits++;
+            else                        ok = false;
+        }
+        txPages.clear();
+        txDirect = false;
+
+        // Sin journal confiable lo más seguro es dejar todo en el disco ya
+        if(!ok) { checkpoint(); return false; }
+        if(journal->size() > JOURNAL_MAX_BYTES) return checkpoint();
+        return true;
+    }
+
+    // Descarta el caché sin escribirlo (el archivo será recreado o borrado)
+    void discard() override {
+        std::lock_guard<std::mutex> lock(mtx);
+        index.clear();
+        lru.clear();
+        txPages.clear();
+        txDirect = false;
+    }
+
+    DiskStats stats() override {
+        std::lock_guard<std::mutex> lock(mtx);
+        DiskStats st;
+        st.path    = diskPath;
+        st.backend = "stream";
+        st.hits   = hits;
+        st.misses = misses;
+        st.cached = lru.size();
+        for(const auto& page : lru) if(page.dirty) st.dirty++;
+        st.commits = journal ? commits : -1;
+        st.fsyncs  = journal ? fsyncs + journal->syncs() : 0;
+        return st;
+    }
+
+protected:
+    // Las páginas en caché dentro del hueco ya no valen: se descartan
+    // (sucias o no) antes de soltarlas del archivo
+    bool punchHole(long long offset, long long len) override {
+        std::lock_guard<std::mutex> lock(mtx);
+        if(!beforeDirect()) return false;
+        long long firstPage = offset / DISK_PAGE_SIZE;
+        long long lastPage  = (offset + len - 1) / DISK_PAGE_SIZE;
+        for(auto it = lru.begin(); it != lru.end(); ) {
+            if(it->no < firstPage || it->no > lastPage) { ++it; continue; }
+            if(it->pinned) txPages.erase(std::find(txPages.begin(), txPages.end(), it->no));
+            index.erase(it->no);
+            it = lru.erase(it);
+        }
+        return Disk::punchHole(offset, len);
+    }
+
+private:
+    struct Page {
+        long long               no;
+        bool                    dirty  = false;
+        bool                    pinned = false; // de la transacción en curso
+        std::unique_ptr<char[]> data;
+    };
+
+    size_t      capacity;
+    std::mutex  mtx;
+
+    // Frente = más reciente
+    std::list<Page>                                        lru;
+    std::unordered_map<long long, std::list<Page>::iterator> index;
+    long long hits   = 0;
+    long long misses = 0;
+
+    // Journal (nullptr si está desactivado) y transacción en curso
+    std::unique_ptr<Journal> journal;
+    std::vector<long long>   txPages;
+    bool                     txDirect = false;
+    long long                commits  = 0;
+    long long                fsyncs   = 0;
+
+    // Requiere 'mtx'. Trae la página al caché (y al frente del LRU).
+    Page* fetch(long long pageNo, bool overwrite) {
+        auto it = index.find(pageNo);
+        if(it != index.end()) {
+            hits++;
+            lru.splice(lru.begin(), lru, it->second);
+            return &lru.front();
+        }
+        misses++;
+
+        // Reutilizar el buffer de la página menos usada si el caché está
+        // lleno (las fijas no se tocan; si todas lo son, el caché crece)
+        Page page;
+        auto victim = lru.end();
+        if(lru.size() >= capacity) {
+            for(auto rit = lru.rbegin(); rit != lru.rend(); ++rit) {
+                if(!rit->pinned) { victim = std::prev(rit.base()); break; }
+            }
+        }
+        if(victim != lru.end()) {
+            if(victim->dirty && !writeBack(*victim)) return nullptr;
+            index.erase(victim->no);
+            page.data = std::move(victim->data);
+            lru.erase(victim);
+        } else {
+            page.data.reset(new char[DISK_PAGE_SIZE]);
+        }
+        page.no    = pageNo;
+        page.dirty = false;
+
+        if(!overwrite) {
+            long long pos   = pageNo * DISK_PAGE_SIZE;
+            size_t    want  = (size_t)std::min<long long>(DISK_PAGE_SIZE, fileSize - pos);
+            size_t    got   = 0;
+            while(got < want) {
+                ssize_t n = pread(fd, page.data.get() + got, want - got, pos + got);
+                if(n < 0 && errno == EINTR) continue;
+                if(n <= 0) break;
+                got += n;
+            }
+            if(got < DISK_PAGE_SIZE) std::memset(page.data.get() + got, 0, DISK_PAGE_SIZE - got);
+        }
+
+        lru.push_front(std::move(page));
+        index[pageNo] = lru.begin();
+        return &lru.front();
+    }
+
+    // Requiere 'mtx'. Suma la página a la transacción. Si ya estaba sucia
+    // por un commit anterior, ese contenido se escribe antes: así el
+    // archivo siempre tiene lo último confirmado y checkpoint() no espera
+    // a la transacción en curso.
+    bool pin(Page& page) {
+        if(!journal || page.pinned) return true;
+        if(page.dirty && !writeBack(page)) return false;
+        page.pinned = true;
+        txPages.push_back(page.no);
+        return true;
+    }
+
+    // Requiere 'mtx'
+    bool pinnedIn(long long firstPage, long long lastPage) const {
+        for(long long no : txPages)
+            if(no >= firstPage && no <= lastPage) return true;
+        return false;
+    }
+
+    // Requiere 'mtx'. Preparar una escritura directa al archivo.
+    bool beforeDirect() {
+        if(!journal) return true;
+        txDirect = true;
+        return journal->size() == 0 || checkpoint();
+    }
+
+    // Requiere 'mtx'. Todo lo confirmado queda en el medio físico y el
+    // journal vuelve a cero.
+    bool checkpoint() {
+        if(!flushUnpinned()) return false;
+        fsyncs++;
+        if(fsync(fd) != 0) return false;
+        return !journal || journal->reset();
+    }
+
+    // Requiere 'mtx'
+    bool flushUnpinned() {
+        bool ok = true;
+        for(auto& page : lru) {
+            if(page.dirty && !page.pinned && !writeBack(page)) ok = false;
+        }
+        return ok;
+    }
+
+    // Requiere 'mtx'
+    bool writeBack(Page& page) {
+        long long pos  = page.no * DISK_PAGE_SIZE;
+        size_t    want = (size_t)std::min<long long>(DISK_PAGE_SIZE, fileSize - pos);
+        size_t    done = 0;
+        while(done < want) {
+            ssize_t n = pwrite(fd, page.data.get() + done, want - done, pos + done);
+            if(n < 0 && errno == EINTR) continue;
+            if(n <= 0) return false;
+            done += n;
+        }
+        page.dirty = false;
+        return true;
+    }
+};
+
+// =============================================
+// MAPPED DISK (backend "mmap")
+// La imagen completa se mapea con MAP_SHARED: leer o escribir un
+// struct es un memcpy y las vistas (ver DiskView.h) pueden devolver
+// referencias directas. msync solo corre en flush()/sync(), es decir
+// al final de cada comando o script, y solo si hubo escrituras.
+// =============================================
+class MappedDisk : public Disk {
+public:
+    MappedDisk(const std::string& path, int fd, long long size)
+        : Disk(path, fd, size) {
+        if(size <= 0) return;
+        void* p = mmap(nullptr, (size_t)size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if(p != MAP_FAILED) base = static_cast<char*>(p);
+    }
+
+    ~MappedDisk() override {
+        if(base == nullptr) return;
+        flush();
+        munmap(base, (size_t)fileSize);
+    }
+
+    using Disk::read;
+    using Disk::write;
+
+    bool isMapped() const { return base != nullptr; }
+
+    char* mapped() override { return base; }
+
+    // Marca el rango como modificado (las vistas escriben directo en el mapa)
+    void touch() { dirty.store(true, std::memory_order_relaxed); }
+
+    bool read(long long offset, void* dst, size_t len) override {
+        if(offset < 0 || offset + (long long)len > fileSize) return false;
+        std::memcpy(dst, base + offset, len);
+        accesses.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool readDirect(long long offset, void* dst, size_t len) override {
+        return read(offset, dst, len);
+    }
+
+    bool write(long long offset, const void* src, size_t len) override {
+        if(offset < 0 || offset + (long long)len > fileSize) return false;
+        std::memcpy(base + offset, src, len);
+        accesses.fetch_add(1, std::memory_order_relaxed);
+        touch();
+        return true;
+    }
+
+    bool writev(long long offset, const std::vector<iovec>& iov) override {
+        size_t total = 0;
+        for(const auto& v : iov) total += v.iov_len;
+        if(offset < 0 || offset + (long long)total > fileSize) return false;
+        char* out = base + offset;
+        for(const auto& v : iov) {
+            std::memcpy(out, v.iov_base, v.iov_len);
+            out += v.iov_len;
+        }
+        touch();
+        return true;
+    }
+
+    bool flush() override {
+        if(!dirty.exchange(false)) return true;
+        return msync(base, (size_t)fileSize, MS_SYNC) == 0;
+    }
+
+    void discard() override {
+        // Las páginas de un mapa compartido ya son del archivo: no hay
+        // nada que descartar, solo se evita el msync
+        dirty.store(false);
+    }
+
+    DiskStats stats() override {
+        DiskStats st;
+        st.path    = diskPath;
+        st.backend = "mmap";
+        st.hits    = accesses.load();
+        st.misses  = 0;
+        st.cached  = (size_t)((fileSize + DISK_PAGE_SIZE - 1) / DISK_PAGE_SIZE);
+        st.dirty   = dirty.load() ? 1 : 0;
+        st.commits = -1;   // sin journal: el kernel escribe el mapa cuando quiere
+        return st;
+    }
+
+private:
+    char*                  base = nullptr;
+    std::atomic<bool>      dirty{false};
+    std::atomic<long long> accesses{0};
+};
+
+// =============================================
+// DISK MANAGER
+// Registro global: un Disk por ruta, compartido por todos los comandos.
+// =============================================
+class DiskManager {
+public:
+    enum Backend { STREAM, MMAP };
+
+    // Backend para los discos que se abran (configurable con -backend=stream|mmap)
+    static Backend backend;
+
+    // Páginas en caché por disco en el backend stream (configurable con -cache=MB)
+    static size_t pagesPerDisk;
+
+    // Journal de transacciones en el backend stream (configurable con -journal=on|off)
+    static bool journaling;
+
+    // Retorna el disco abierto (lo abre la primera vez) o nullptr
+    static std::shared_ptr<Disk> get(const std::string& path) {
+        std::lock_guard<std::mutex> lock(tableMutex);
+        auto it = disks.find(path);
+        if(it != disks.end()) return it->second;
+
+        int fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+        if(fd < 0) return nullptr;
+        struct stat st;
+        if(fstat(fd, &st) != 0) { close(fd); return nullptr; }
+
+        std::shared_ptr<Disk> disk;
+        // El mapeo expone los bytes tal como están en el disco: solo se
+        // puede usar si el host ya es little-endian
+        if(backend == MMAP && DISK_LITTLE_ENDIAN) {
+            auto mappedDisk = std::make_shared<MappedDisk>(path, fd, (long long)st.st_size);
+            if(!mappedDisk->isMapped()) return nullptr; // el destructor cierra fd
+            disk = mappedDisk;
+        } else {
+            disk = std::make_shared<CachedDisk>(path, fd, (long long)st.st_size, pagesPerDisk, journaling);
+        }
+        disks[path] = disk;
+        return disk;
+    }
+
+    // Saca el disco del registro. Si 'discard' es true las páginas sucias
+    // se pierden (el archivo se va a recrear o eliminar).
+    static void drop(const std::string& path, bool discard) {
+        // Un journal viejo no debe aplicarse sobre el archivo nuevo
+        if(discard) Journal::remove(path);
+        std::shared_ptr<Disk> disk;
+        {
+            std::lock_guard<std::mutex> lock(tableMutex);
+            auto it = disks.find(path);
+            if(it == disks.end()) return;
+            disk = it->second;
+            disks.erase(it);
+        }
+        if(discard) disk->discard();
+    }
+
+    // Cierra la transacción del disco (si está abierto); lo llama
+    // DiskLocks al soltar el candado exclusivo
+    static bool commit(const std::string& path) {
+        std::shared_ptr<Disk> disk;
+        {
+            std::lock_guard<std::mutex> lock(tableMutex);
+            auto it = disks.find(path);
+            if(it == disks.end()) return true;
+            disk = it->second;
+        }
+        return disk->commit();
+    }
+
+    // Punto de flush: se llama al terminar cada script
+    static void flushAll() {
+        for(auto& disk : all()) disk->flush();
+    }
+
+    // Rutas de los discos abiertos (para recorrerlos tomando el candado
+    // de cada uno)
+    static std::vector<std::string> openPaths() {
+        std::lock_guard<std::mutex> lock(tableMutex);
+        std::vector<std::string> result;
+        for(auto& entry : disks) result.push_back(entry.first);
+        return result;
+    }
+
+    // Escribe al disco físico el caché del disco (si sigue abierto).
+    // Requiere el candado del disco.
+    static bool sync(const std::string& path) {
+        std::shared_ptr<Disk> disk;
+        {
+            std::lock_guard<std::mutex> lock(tableMutex);
+            auto it = disks.find(path);
+            if(it == disks.end()) return true;
+            disk = it->second;
+        }
+        return disk->sync();
+    }
+
+    static std::vector<DiskStats> stats() {
+        std::vector<DiskStats> result;
+        for(auto& disk : all()) result.push_back(disk->stats());
+        return result;
+    }
+
+private:
+    static std::mutex tableMutex;
+    static std::unordered_map<std::string, std::shared_ptr<Disk>> disks;
+
+    static std::vector<std::shared_ptr<Disk>> all() {
+        std::lock_guard<std::mutex> lock(tableMutex);
+        std::vector<std::shared_ptr<Disk>> result;
+        for(auto& entry : disks) result.push_back(entry.second);
+        return result;
+    }
+};
+
+// Definiciones estáticas
+DiskManager::Backend DiskManager::backend = DiskManager::STREAM;
+size_t DiskManager::pagesPerDisk = 1024; // 4 MB
+bool   DiskManager::journaling   = true;
+std::mutex DiskManager::tableMutex;
+std::unordered_map<std::string, std::shared_ptr<Disk>> DiskManager::disks;
+
+#endif // DISKMANAGER_H
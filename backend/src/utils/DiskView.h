@@ -0,0 +1,313 @@
+#ifndef DISKVIEW_H
+#define DISKVIEW_H
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include "../structs/Structs.h"
+#include "DiskManager.h"
+
+// =============================================
+// DISK VIEW
+// Acceso tipado y con verificación de límites a los structs de un disco.
+// Con el backend mmap las referencias apuntan directo a la imagen
+// mapeada (cero copias). Con el backend stream se leen una vez a una
+// copia propia de la vista y las modificadas se escriben en commit()
+// (o al destruir la vista). Un acceso fuera de rango lanza
+// std::out_of_range, que processCommand reporta como error del comando.
+//
+// Debe usarse con el candado del disco tomado (ver DiskLocks.h).
+// =============================================
+class DiskView {
+public:
+    explicit DiskView(Disk& disk)
+        : disk(disk), base(disk.mapped()), lo(0), hi(disk.size()) {}
+
+    virtual ~DiskView() { commit(); }
+
+    DiskView(const DiskView&)            = delete;
+    DiskView& operator=(const DiskView&) = delete;
+
+    const MBR& mbr()    { return at<MBR>(0, false); }
+    MBR&       mbrMut() { return at<MBR>(0, true); }
+
+    const EBR& ebr(long long pos)    { return at<EBR>(pos, false); }
+    EBR&       ebrMut(long long pos) { return at<EBR>(pos, true); }
+
+    // Rango crudo de bytes (bitmaps)
+    const char* bytes(long long pos, size_t len)    { return range(pos, len, false); }
+    char*       bytesMut(long long pos, size_t len) { return range(pos, len, true); }
+
+    // Escribe al disco lo modificado a través de la vista
+    bool commit() {
+        if(base != nullptr) {
+            if(touched) static_cast<MappedDisk&>(disk).touch();
+            touched = false;
+            return true;
+        }
+        bool ok = true;
+        for(auto& entry : shadows) {
+            Shadow& sh = entry.second;
+            if(!sh.dirty) continue;
+            if(!writeShadow(entry.first, sh)) ok = false;
+            sh.dirty = false;
+        }
+        return ok;
+    }
+
+    bool zeroCopy() const { return base != nullptr; }
+
+protected:
+    Disk&     disk;
+    char*     base;
+    long long lo;   // límites válidos [lo, hi) para esta vista
+    long long hi;
+
+    template<typename T>
+    T& at(long long pos, bool forWrite) {
+        return *array<T>(pos, 1, forWrite);
+    }
+
+    // 'count' elementos T seguidos (el largo depende del disco, como un
+    // bloque de s_block_s bytes)
+    template<typename T>
+    T* array(long long pos, size_t count, bool forWrite) {
+        DiskSwapFn order = DISK_LITTLE_ENDIAN ? nullptr : &orderOf<T>;
+        return reinterpret_cast<T*>(range(pos, count * sizeof(T), forWrite, order, sizeof(T)));
+    }
+
+    // 'order' convierte la copia entre el orden del disco y el del host
+    // (solo en hosts big-endian; ver Layout.h), de a 'stride' bytes
+    char* range(long long pos, size_t len, bool forWrite,
+                DiskSwapFn order = nullptr, size_t stride = 0) {
+        if(pos < lo || pos + (long long)len > hi)
+            throw std::out_of_range("acceso fuera de rango en " + disk.path() +
+                                    " (byte " + std::to_string(pos) + ")");
+        if(base != nullptr) {
+            if(forWrite) touched = true;
+            return base + pos;
+        }
+        return shadow(pos, len, forWrite, order, stride);
+    }
+
+    // Coherencia con los accesos directos al disco (sin copia) sobre
+    // 'count' tramos de 'stride' bytes desde 'pos', con las copias
+    // tomadas en el inicio de cada tramo. flushShadows escribe antes de
+    // leer lo modificado en RAM; reloadShadows, después de escribir,
+    // descarta lo pendiente y vuelve a leer en el mismo buffer (las
+    // referencias ya entregadas siguen valiendo).
+    bool flushShadows(long long pos, long long count, size_t stride) {
+        if(base != nullptr || shadows.empty()) return true;
+        bool ok = true;
+        for(long long i = 0; i < count; i++) {
+            auto it = shadows.find(pos + i * (long long)stride);
+            if(it == shadows.end() || !it->second.dirty) continue;
+            it->second.dirty = false;
+            if(!writeShadow(it->first, it->second)) ok = false;
+        }
+        return ok;
+    }
+
+    bool reloadShadows(long long pos, long long count, size_t stride) {
+        if(base != nullptr || shadows.empty()) return true;
+        bool ok = true;
+        for(long long i = 0; i < count; i++) {
+            auto it = shadows.find(pos + i * (long long)stride);
+            if(it == shadows.end()) continue;
+            Shadow& sh = it->second;
+            sh.dirty = false;
+            if(!disk.read(it->first, sh.data.get(), sh.len)) ok = false;
+            else applyOrder(sh, sh.data.get());
+        }
+        return ok;
+    }
+
+private:
+    struct Shadow {
+        std::unique_ptr<char[]> data;
+        size_t                  len   = 0;
+        bool                    dirty  = false;
+        DiskSwapFn              order  = nullptr;
+        size_t                  stride = 0;     // bytes de cada elemento que convierte 'order'
+    };
+
+    std::unordered_map<long long, Shadow> shadows;
+    std::vector<std::unique_ptr<char[]>>  retired;  // buffers reemplazados (ver shadow)
+    bool                                  touched = false;
+
+    template<typename T>
+    static void orderOf(char* p) { diskOrder<T>(p); }
+
+    char* shadow(long long pos, size_t len, bool forWrite, DiskSwapFn order, size_t stride) {
+        Shadow& sh = shadows[pos];
+        if(sh.len < len) {
+            // Primera vez (o se pide un rango más grande en el mismo offset).
+            // Las referencias ya entregadas apuntan al buffer anterior: se
+            // retira en vez de liberarse y vive hasta que muere la vista.
+            if(sh.dirty) writeShadow(pos, sh);
+            if(sh.data) retired.push_back(std::move(sh.data));
+            sh.data.reset(new char[len]);
+            sh.len   = len;
+            sh.dirty = false;
+            sh.order  = order;
+            sh.stride = stride;
+            if(!disk.read(pos, sh.data.get(), len))
+                throw std::out_of_range("no se pudo leer " + disk.path() +
+                                        " (byte " + std::to_string(pos) + ")");
+            applyOrder(sh, sh.data.get());
+        }
+        if(forWrite) sh.dirty = true;
+        return sh.data.get();
+    }
+
+    bool writeShadow(long long pos, const Shadow& sh) {
+        if(sh.order == nullptr) return disk.write(pos, sh.data.get(), sh.len);
+        std::unique_ptr<char[]> raw(new char[sh.len]);
+        std::memcpy(raw.get(), sh.data.get(), sh.len);
+        applyOrder(sh, raw.get());
+        return disk.write(pos, raw.get(), sh.len);
+    }
+
+    static void applyOrder(const Shadow& sh, char* p) {
+        if(sh.order == nullptr) return;
+        for(size_t off = 0; off + sh.stride <= sh.len; off += sh.stride) sh.order(p + off);
+    }
+};
+
+// =============================================
+// PARTITION VIEW
+// Vista de una partición EXT2: superbloque, inodos, bloques y bitmaps
+// indexados por número, limitados a los bytes de la partición.
+// =============================================
+class PartitionView : public DiskView {
+public:
+    PartitionView(Disk& disk, long long start, long long size)
+        : DiskView(disk), start(start) {
+        lo = start;
+        hi = std::min(start + size, disk.size());
+    }
+
+    // Lee el superbloque. false si la partición no tiene EXT2.
+    bool load() {
+        if(start < lo || start + (long long)sizeof(SuperBloque) > hi) return false;
+        superblock = &at<SuperBloque>(start, false);
+        return superblock->s_magic == 0xEF53 && superblock->s_version == DISK_FORMAT_VERSION &&
+               validBlockSize(superblock->s_block_s);
+    }
+
+    const SuperBloque& sb() { return *superblock; }
+    SuperBloque&       sbMut() { return at<SuperBloque>(start, true); }
+
+    const Inode& inode(int n)    { return at<Inode>(inodePos(n), false); }
+    Inode&       inodeMut(int n) { return at<Inode>(inodePos(n), true); }
+
+    // Geometría de los bloques (ver Structs.h)
+    int blockSize()     { return superblock->s_block_s; }
+    int folderEntries() { return superblock->s_block_s / (int)sizeof(Content); }
+    int blockWords()    { return superblock->s_block_s / (int)sizeof(int32_t); }
+
+    // Bloque carpeta: folderEntries() casillas
+    const Content* folder(int n)    { return array<Content>(blockPos(n), folderEntries(), false); }
+    Content*       folderMut(int n) { return array<Content>(blockPos(n), folderEntries(), true); }
+
+    // Bloque como blockWords() enteros de 32 bits (apuntadores o nodos
+    // del índice de carpetas)
+    const int32_t* words(int n)    { return array<int32_t>(blockPos(n), blockWords(), false); }
+    int32_t*       wordsMut(int n) { return array<int32_t>(blockPos(n), blockWords(), true); }
+
+    // Bloque archivo: blockSize() bytes de contenido
+    const char* fileBlock(int n) { return bytes(blockPos(n), blockSize()); }
+
+    // Deja un bloque carpeta con todas las casillas libres
+    void clearFolder(int n) {
+        Content* c = folderMut(n);
+        std::fill(c, c + folderEntries(), Content());
+    }
+
+    // Deja un bloque de apuntadores con todos en -1
+    void clearPointers(int n) {
+        int32_t* w = wordsMut(n);
+        std::fill(w, w + blockWords(), -1);
+    }
+
+    // Struct de tamaño fijo al inicio de un bloque (cabe en el bloque
+    // más chico). Se toma el bloque completo, así un words() o folder()
+    // posterior del mismo bloque usa la misma copia en vez de agrandarla.
+    template<typename T>
+    const T& block(int n) {
+        static_assert(BLOCK_SIZE_MIN % sizeof(T) == 0, "T debe dividir el bloque más chico");
+        return *array<T>(blockPos(n), blockSize() / sizeof(T), false);
+    }
+
+    template<typename T>
+    T& blockMut(int n) {
+        static_assert(BLOCK_SIZE_MIN % sizeof(T) == 0, "T debe dividir el bloque más chico");
+        return *array<T>(blockPos(n), blockSize() / sizeof(T), true);
+    }
+
+    // Bitmaps (un byte '0'/'1' por inodo o bloque)
+    const char* inodeBitmap() { return bytes(superblock->s_bm_inode_start, superblock->s_inodes_count); }
+    const char* blockBitmap() { return bytes(superblock->s_bm_block_start, superblock->s_blocks_count); }
+    char* inodeBitmapMut() { return bytesMut(superblock->s_bm_inode_start, superblock->s_inodes_count); }
+    char* blockBitmapMut() { return bytesMut(superblock->s_bm_block_start, superblock->s_blocks_count); }
+
+    // Contenido de los bloques consecutivos que empiezan en 'first': una
+    // sola lectura/escritura al disco, sin pasar por las copias de la
+    // vista. Un bloque liberado y vuelto a pedir en la misma vista puede
+    // tener copia (de apuntadores o carpeta): se escribe antes de leer y
+    // se vuelve a leer después de escribir, así nunca pisa el contenido.
+    bool readBlocks(int first, size_t len, char* dst) {
+        long long pos = blockRun(first, len);
+        if(!flushShadows(pos, blockCount(len), superblock->s_block_s)) return false;
+        return disk.read(pos, dst, len);
+    }
+
+    // Escribe 'len' bytes y rellena con ceros hasta el final del último bloque
+    bool writeBlocks(int first, size_t len, const char* src) {
+        long long pos  = blockRun(first, len);
+        size_t    bs   = superblock->s_block_s;
+        size_t    tail = (bs - len % bs) % bs;
+        if(len > 0 && !disk.write(pos, src, len)) return false;
+        if(tail != 0 && !disk.fill(pos + (long long)len, 0, tail)) return false;
+        return reloadShadows(pos, blockCount(len), bs);
+    }
+
+private:
+    long long          start;
+    const SuperBloque* superblock = nullptr;
+
+    long long inodePos(int n) {
+        if(n < 0 || n >= superblock->s_inodes_count)
+            throw std::out_of_range("inodo fuera de rango: " + std::to_string(n));
+        return superblock->s_inode_start + (long long)n * superblock->s_inode_s;
+    }
+
+    // Byte inicial de los bloques que ocupan 'len' bytes desde 'first'
+    long long blockCount(size_t len) {
+        return ((long long)len + superblock->s_block_s - 1) / superblock->s_block_s;
+    }
+
+    long long blockRun(int first, size_t len) {
+        long long count = blockCount(len);
+        if(first < 0 || first + count > superblock->s_blocks_count)
+            throw std::out_of_range("bloques fuera de rango: " + std::to_string(first) +
+                                    " + " + std::to_string(count));
+        long long pos = superblock->s_block_start + (long long)first * superblock->s_block_s;
+        if(pos < lo || pos + count * superblock->s_block_s > hi)
+            throw std::out_of_range("acceso fuera de rango en " + disk.path() +
+                                    " (byte " + std::to_string(pos) + ")");
+        return pos;
+    }
+
+    long long blockPos(int n) {
+        if(n < 0 || n >= superblock->s_blocks_count)
+            throw std::out_of_range("bloque fuera de rango: " + std::to_string(n));
+        return superblock->s_block_start + (long long)n * superblock->s_block_s;
+    }
+};
+
+#endif // DISKVIEW_H
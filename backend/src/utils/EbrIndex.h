@@ -0,0 +1,246 @@
+#ifndef EBRINDEX_H
+#define EBRINDEX_H
+
+#include <string>
+#include <map>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "../structs/Structs.h"
+#include "DiskManager.h"
+#include "DiskView.h"
+#include "FreeExtents.h"
+
+// =============================================
+// EBR CHAIN
+// Copia en RAM de la lista de EBRs de una partición extendida:
+//   posición -> EBR (en orden, el último es la cola de la lista),
+//   nombre -> posición, y los huecos libres (FreeExtents).
+// Se arma recorriendo la lista una sola vez; después buscar una lógica,
+// encontrar la cola o un hueco no lee el disco, y crear o borrar una
+// lógica escribe solo su EBR y el anterior.
+// Quien la use o la modifique debe tener el candado exclusivo del disco.
+// =============================================
+class EbrChain {
+public:
+    EbrChain(long long extStart, long long extSize)
+        : extStart(extStart), extEnd(extStart + extSize) {}
+
+    long long start() const { return extStart; }
+    long long end()   const { return extEnd; }
+
+    // Recorre la lista desde el primer EBR. Un part_next que no avance o
+    // que se salga de la extendida corta la lista (disco dañado).
+    void load(Disk& disk) {
+        DiskView view(disk);
+        long long pos = extStart;
+        while(pos >= extStart && pos + (long long)sizeof(EBR) <= extEnd) {
+            const EBR& ebr = view.ebr(pos);
+            if(pos == extStart) head = ebr;
+            if(ebr.part_s != -1) add(pos, ebr);
+            if(ebr.part_next <= pos) break;
+            pos = ebr.part_next;
+        }
+        rebuildGaps();
+    }
+
+    // EBR de la lógica 'name' (nullptr si no existe); 'pos' es su posición
+    const EBR* find(const std::string& name, long long& pos) const {
+        auto it = byName.find(name);
+        if(it == byName.end()) return nullptr;
+        pos = it->second;
+        return &byPos.at(pos);
+    }
+
+    // Posición para el EBR de una lógica de 'size' bytes según el ajuste
+    // ('F', 'B' o 'W'); -1 si no cabe en ningún hueco
+    long long place(long long size, char fit) const {
+        return gaps.find((long long)sizeof(EBR) + size, fit);
+    }
+
+    // Escribe el EBR de una lógica nueva en 'pos' (obtenida con place())
+    // y enlaza la lista; solo toca el EBR nuevo y su anterior
+    bool insert(Disk& disk, long long pos, EBR ebr) {
+        if(pos == extStart) {
+            // Reutiliza el primer EBR (vacío): conserva su siguiente
+            ebr.part_next = head.part_next;
+        } else {
+            auto next = byPos.upper_bound(pos);
+            ebr.part_next = (next == byPos.end()) ? -1 : next->first;
+            if(!relink(disk, pos, pos)) return false;
+        }
+        if(!disk.write(pos, ebr)) return false;
+
+        if(pos == extStart) head = ebr;
+        add(pos, ebr);
+        gaps.reserve(pos, extent(pos, ebr));
+        return true;
+    }
+
+    // Quita la lógica en 'pos': su anterior pasa a apuntar a su siguiente
+    // (el primer EBR no se mueve, solo se vacía) y su espacio vuelve a
+    // los huecos, unido con los vecinos
+    bool remove(Disk& disk, long long pos) {
+        auto it = byPos.find(pos);
+        if(it == byPos.end()) return false;
+        EBR gone = it->second;
+        if(pos == extStart) {
+            EBR empty;
+            empty.part_next = gone.part_next;
+            if(!disk.write(pos, empty)) return false;
+            head = empty;
+        } else if(!relink(disk, pos, gone.part_next)) {
+            return false;
+        }
+
+        byName.erase(std::string(gone.part_name));
+        byPos.erase(it);
+        gaps.release(pos, extent(pos, gone));
+        return true;
+    }
+
+    // Cambia el tamaño de la lógica en 'pos'; crecer requiere que los
+    // bytes que siguen a su final estén libres
+    bool resize(Disk& disk, long long pos, long long newSize) {
+        auto it = byPos.find(pos);
+        if(it == byPos.end() || newSize <= 0) return false;
+        EBR ebr = it->second;
+        long long end;
+        if(!addOffset(ebr.part_start, ebr.part_s, end)) return false;
+        if(newSize > ebr.part_s && !gaps.reserve(end, newSize - ebr.part_s)) return false;
+
+        long long oldSize = ebr.part_s;
+        ebr.part_s = newSize;
+        if(!update(disk, pos, ebr)) {
+            if(newSize > oldSize) gaps.release(end, newSize - oldSize);
+            return false;
+        }
+        if(newSize < oldSize) gaps.release(ebr.part_start + newSize, oldSize - newSize);
+        return true;
+    }
+
+    // Mueve el final de la extendida (fdisk -add sobre ella); achicar
+    // solo se permite sobre espacio libre
+    bool setEnd(long long newEnd) {
+        if(newEnd > extEnd) gaps.release(extEnd, newEnd - extEnd);
+        else if(newEnd < extEnd && !gaps.reserve(newEnd, extEnd - newEnd)) return false;
+        extEnd = newEnd;
+        return true;
+    }
+
+    // Reescribe el EBR de una lógica existente (p. ej. part_mount)
+    bool update(Disk& disk, long long pos, const EBR& ebr) {
+        auto it = byPos.find(pos);
+        if(it == byPos.end() || !disk.write(pos, ebr)) return false;
+        it->second = ebr;
+        if(pos == extStart) head = ebr;
+        return true;
+    }
+
+    size_t count() const { return byPos.size(); }
+
+    // fn(posición, EBR) por cada lógica, en orden de la lista
+    template<typename Fn>
+    void forEach(Fn&& fn) const {
+        for(const auto& entry : byPos) fn(entry.first, entry.second);
+    }
+
+    // Huecos libres de la extendida
+    const FreeExtents& freeSpace() const { return gaps; }
+
+private:
+    long long extStart, extEnd;
+    EBR       head;    // primer EBR (vacío mientras no haya lógicas en él)
+    std::map<long long, EBR>                   byPos;
+    std::unordered_map<std::string, long long> byName;
+    FreeExtents                                gaps;
+
+    // Hace que el EBR anterior a 'pos' (la lógica previa o, si no hay, el
+    // primer EBR vacío) apunte a 'next'
+    bool relink(Disk& disk, long long pos, long long next) {
+        auto prev = byPos.lower_bound(pos);
+        long long beforePos = (prev == byPos.begin()) ? extStart : std::prev(prev)->first;
+        EBR& before         = (prev == byPos.begin()) ? head     : std::prev(prev)->second;
+        EBR updated = before;
+        updated.part_next = next;
+        if(!disk.write(beforePos, updated)) return false;
+        before = updated;
+        if(beforePos == extStart) head = updated;
+        return true;
+    }
+
+    void add(long long pos, const EBR& ebr) {
+        byPos[pos] = ebr;
+        byName.emplace(std::string(ebr.part_name), pos);
+    }
+
+    // Bytes desde el EBR hasta el final de sus datos. Los datos empiezan
+    // en part_start, que en un disco convertido desde v1 queda unos bytes
+    // después del final del EBR (el EBR v1 era más grande).
+    // -1 si los valores del EBR no tienen sentido (disco dañado).
+    static long long extent(long long pos, const EBR& ebr) {
+        long long end;
+        if(!addOffset(ebr.part_start, ebr.part_s, end) || end < pos) return -1;
+        return end - pos;
+    }
+
+    // Cada lógica ocupa su EBR más sus datos; lo demás está libre
+    void rebuildGaps() {
+        gaps = FreeExtents();
+        gaps.release(extStart, extEnd - extStart);
+        for(const auto& entry : byPos)
+            gaps.reserve(entry.first, extent(entry.first, entry.second));
+    }
+};
+
+// =============================================
+// EBR INDEX
+// EbrChain por disco. get() la arma la primera vez (o si la extendida
+// del MBR ya no es la misma); mkdisk, rmdisk y fdisk -type=E llaman a
+// invalidate() porque cambian la extendida por completo.
+// =============================================
+class EbrIndex {
+public:
+    // Requiere el candado exclusivo del disco
+    static std::shared_ptr<EbrChain> get(Disk& disk, const std::string& path,
+                                         long long extStart, long long extSize) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            auto it = chains.find(path);
+            if(it != chains.end() && it->second->start() == extStart &&
+               it->second->end() == extStart + extSize)
+                return it->second;
+        }
+        auto chain = std::make_shared<EbrChain>(extStart, extSize);
+        chain->load(disk);
+        std::lock_guard<std::mutex> lock(mtx);
+        chains[path] = chain;
+        return chain;
+    }
+
+    // Cadena de la extendida del MBR (nullptr si no hay extendida)
+    static std::shared_ptr<EbrChain> get(Disk& disk, const std::string& path, const MBR& mbr) {
+        for(int i = 0; i < 4; i++) {
+            const Partition& part = mbr.mbr_partitions[i];
+            if(part.part_start != -1 && part.part_type == 'E')
+                return get(disk, path, part.part_start, part.part_s);
+        }
+        return nullptr;
+    }
+
+    static void invalidate(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mtx);
+        chains.erase(path);
+    }
+
+private:
+    static std::mutex mtx;
+    static std::unordered_map<std::string, std::shared_ptr<EbrChain>> chains;
+};
+
+// Definiciones estáticas
+std::mutex EbrIndex::mtx;
+std::unordered_map<std::string, std::shared_ptr<EbrChain>> EbrIndex::chains;
+
+#endif // EBRINDEX_H
@@ -0,0 +1,234 @@
+#ifndef FILEIO_H
+#define FILEIO_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <ctime>
+#include "../structs/Structs.h"
+#include "DiskView.h"
+#include "InodeBlocks.h"
+#include "Bitmap.h"
+
+// =============================================
+// FILE IO
+// Lectura y escritura del contenido completo de un inodo archivo,
+// con el direccionamiento 12 + P + P² + P³ de InodeBlocks (P depende
+// del tamaño de bloque). Los bloques físicamente consecutivos (que
+// además son consecutivos en el archivo) se agrupan en una sola
+// lectura/escritura al disco, así un archivo contiguo de cientos de KB
+// cuesta unas pocas operaciones en lugar de una por bloque.
+// Leer requiere el candado compartido del disco; escribir el exclusivo.
+// =============================================
+class FileIO {
+public:
+    // Bytes máximos de un archivo
+    static long long maxSize(PartitionView& fs) {
+        return InodeBlocks::maxBytes(fs);
+    }
+
+    // Deja en 'out' los i_s bytes del archivo (los huecos se leen como ceros)
+    static bool read(PartitionView& fs, const Inode& inode, std::string& out) {
+        long long bs   = fs.sb().s_block_s;
+        long long size = inode.i_s;
+        out.assign((size_t)std::max(0LL, size), '\0'); // una sola reserva
+
+        bool ok = true;
+        forEachRun(fs, inode, size, [&](long long logical, int first, long long count) {
+            long long offset = logical * bs;
+            long long len    = std::min(count * bs, size - offset);
+            if(len > 0 && !fs.readBlocks(first, (size_t)len, &out[(size_t)offset])) ok = false;
+            return ok;
+        });
+        return ok;
+    }
+
+    // Reemplaza el contenido del archivo 'inodeNo' por 'data'. Los bloques
+    // anteriores se liberan y los nuevos se piden como una racha contigua
+    // (si no la hay, de uno en uno). Actualiza i_block, i_s e i_mtime.
+    static bool write(PartitionView& fs, BitmapAllocator& alloc, int inodeNo,
+                      std::string_view data, std::string& error) {
+        long long bs = fs.sb().s_block_s;
+        if((long long)data.size() > maxSize(fs)) {
+            error = "el archivo excede el máximo de " + std::to_string(maxSize(fs)) + " bytes";
+            return false;
+        }
+
+        Inode& inode = fs.inodeMut(inodeNo);
+        release(fs, alloc, inode);
+
+        long long blocks = ((long long)data.size() + bs - 1) / bs;
+        std::vector<int> dataBlocks, pointerBlocks;
+        if(!reserve(alloc, blocks, dataBlocks) ||
+           !reserve(alloc, pointersNeeded(fs, blocks), pointerBlocks)) {
+            for(int b : dataBlocks)    alloc.freeBlock(b);
+            for(int b : pointerBlocks) alloc.freeBlock(b);
+            inode.i_s = 0;
+            error = "no hay bloques libres suficientes";
+            return false;
+        }
+
+        // Contenido: una escritura por racha de bloques consecutivos
+        for(size_t i = 0; i < dataBlocks.size(); ) {
+            size_t j = i + 1;
+            while(j < dataBlocks.size() && dataBlocks[j] == dataBlocks[j-1] + 1) j++;
+            size_t offset = i * bs;
+            size_t len    = std::min(data.size() - offset, (j - i) * (size_t)bs);
+            if(!fs.writeBlocks(dataBlocks[i], len, data.data() + offset)) {
+                error = "no se pudo escribir el contenido";
+                return false;
+            }
+            i = j;
+        }
+
+        // Apuntadores: directos y luego los árboles indirectos
+        size_t next = 0, usedPointers = 0;
+        for(int i = 0; i < DIRECT_BLOCKS; i++)
+            inode.i_block[i] = (next < dataBlocks.size()) ? dataBlocks[next++] : -1;
+        for(int level = 1; level <= 3; level++) {
+            int& slot = inode.i_block[DIRECT_BLOCKS + level - 1];
+            slot = -1;
+            if(next >= dataBlocks.size()) continue;
+            size_t count = (size_t)std::min<long long>(dataBlocks.size() - next, InodeBlocks::span(fs, level));
+            slot = buildTree(fs, level, &dataBlocks[next], count, pointerBlocks, usedPointers);
+            next += count;
+        }
+
+        inode.i_s     = (int)data.size();
+        inode.i_mtime = time(nullptr);
+        return true;
+    }
+
+    // Libera todos los bloques (contenido y apuntadores) del inodo
+    static void release(PartitionView& fs, BitmapAllocator& alloc, Inode& inode) {
+        for(int i = 0; i < DIRECT_BLOCKS; i++) {
+            if(inode.i_block[i] != -1) alloc.freeBlock(inode.i_block[i]);
+            inode.i_block[i] = -1;
+        }
+        for(int level = 1; level <= 3; level++) {
+            int& slot = inode.i_block[DIRECT_BLOCKS + level - 1];
+            if(slot != -1) releaseTree(fs, alloc, slot, level);
+            slot = -1;
+        }
+        inode.i_s = 0;
+    }
+
+    // Pone 'physical' como bloque lógico 'logical' del inodo, creando los
+    // bloques de apuntadores que falten (crecer una carpeta de a un bloque).
+    // false si 'logical' no cabe en el inodo o no hay bloques libres.
+    static bool attach(PartitionView& fs, BitmapAllocator& alloc, int inodeNo,
+                       long long logical, int physical) {
+        if(logical < 0 || logical >= InodeBlocks::maxBlocks(fs)) return false;
+        Inode& inode = fs.inodeMut(inodeNo);
+        if(logical < DIRECT_BLOCKS) {
+            inode.i_block[logical] = physical;
+            return true;
+        }
+        long long rest  = logical - DIRECT_BLOCKS;
+        int       level = 1;
+        while(rest >= InodeBlocks::span(fs, level)) rest -= InodeBlocks::span(fs, level++);
+
+        int* slot = &inode.i_block[DIRECT_BLOCKS + level - 1];
+        for(int l = level; l >= 1; l--) {
+            if(*slot == -1) {
+                int ptr = alloc.allocBlock();
+                if(ptr < 0) return false;
+                fs.clearPointers(ptr);
+                *slot = ptr;
+            }
+            long long step = InodeBlocks::span(fs, l - 1);
+            slot = &fs.wordsMut(*slot)[rest / step];
+            rest %= step;
+        }
+        *slot = physical;
+        return true;
+    }
+
+    // Bloques de apuntadores que necesita un archivo de 'blocks' bloques
+    static long long pointersNeeded(PartitionView& fs, long long blocks) {
+        long long total = 0;
+        long long rest  = blocks - DIRECT_BLOCKS;
+        for(int level = 1; level <= 3 && rest > 0; level++) {
+            long long here = std::min(rest, InodeBlocks::span(fs, level));
+            // Un bloque por cada grupo de span(l) bloques en cada nivel del árbol
+            for(int l = 1; l <= level; l++)
+                total += (here + InodeBlocks::span(fs, l) - 1) / InodeBlocks::span(fs, l);
+            rest -= here;
+        }
+        return total;
+    }
+
+private:
+    // fn(logico, primerFisico, cantidad) por cada racha contigua dentro
+    // de los primeros 'size' bytes
+    template<typename Fn>
+    static void forEachRun(PartitionView& fs, const Inode& inode, long long size, Fn&& fn) {
+        long long bs    = fs.sb().s_block_s;
+        long long limit = (size + bs - 1) / bs;
+        long long runLogical = -1, runCount = 0;
+        int       runFirst   = -1;
+        bool      more       = true;
+
+        InodeBlocks::forEach(fs, inode, [&](long long logical, int physical) {
+            if(logical >= limit) return false;
+            if(runCount > 0 && logical == runLogical + runCount && physical == runFirst + runCount) {
+                runCount++;
+                return true;
+            }
+            if(runCount > 0 && !(more = fn(runLogical, runFirst, runCount))) return false;
+            runLogical = logical;
+            runFirst   = physical;
+            runCount   = 1;
+            return true;
+        });
+        if(more && runCount > 0) fn(runLogical, runFirst, runCount);
+    }
+
+    static bool reserve(BitmapAllocator& alloc, long long n, std::vector<int>& out) {
+        if(n <= 0) return true;
+        out.reserve((size_t)n);
+        int first = alloc.allocBlocks((int)n);
+        if(first >= 0) {
+            for(long long i = 0; i < n; i++) out.push_back(first + (int)i);
+            return true;
+        }
+        // Sin racha contigua: bloques sueltos (siguen en orden ascendente,
+        // así los que queden juntos se escriben igual en una sola operación)
+        for(long long i = 0; i < n; i++) {
+            int b = alloc.allocBlock();
+            if(b < 0) return false;
+            out.push_back(b);
+        }
+        return true;
+    }
+
+    // Arma el bloque de apuntadores de un nivel para 'count' bloques de
+    // contenido; retorna su número
+    static int buildTree(PartitionView& fs, int level, const int* data, size_t count,
+                         const std::vector<int>& pool, size_t& used) {
+        int self = pool[used++];
+        std::vector<int32_t> pointers(fs.blockWords(), -1);
+        size_t step = (size_t)InodeBlocks::span(fs, level - 1);
+        for(size_t i = 0; i < pointers.size() && i * step < count; i++) {
+            size_t here = std::min(step, count - i * step);
+            pointers[i] = (level == 1) ? data[i]
+                                       : buildTree(fs, level - 1, data + i * step, here, pool, used);
+        }
+        std::copy(pointers.begin(), pointers.end(), fs.wordsMut(self));
+        return self;
+    }
+
+    static void releaseTree(PartitionView& fs, BitmapAllocator& alloc, int ptr, int level) {
+        const int32_t* words = fs.words(ptr);
+        std::vector<int32_t> pointers(words, words + fs.blockWords());
+        for(int child : pointers) {
+            if(child == -1) continue;
+            if(level == 1) alloc.freeBlock(child);
+            else           releaseTree(fs, alloc, child, level - 1);
+        }
+        alloc.freeBlock(ptr);
+    }
+};
+
+#endif // FILEIO_H
@@ -0,0 +1,210 @@
+#ifndef FREEEXTENTS_H
+#define FREEEXTENTS_H
+
+#include <string>
+#include <set>
+#include <memory>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include "../structs/Structs.h"
+
+// =============================================
+// FREE EXTENTS
+// Huecos libres (inicio, tamaño) de un rango de bytes, compartido por
+// el nivel del MBR y el de los EBR de la extendida. Dos índices:
+//   - un treap por inicio donde cada nodo guarda el mayor hueco de su
+//     subárbol: First Fit baja por él en O(log n);
+//   - un set ordenado por (tamaño, inicio): Best Fit es un lower_bound
+//     y Worst Fit el último, también O(log n).
+// release() une el hueco con sus vecinos, así lo que deja una partición
+// borrada vuelve a estar disponible como un solo hueco.
+// =============================================
+class FreeExtents {
+public:
+    FreeExtents() = default;
+    FreeExtents(FreeExtents&&) = default;
+    FreeExtents& operator=(FreeExtents&&) = default;
+
+    // Marca [start, start+len) como libre, uniéndolo con los huecos vecinos
+    void release(long long start, long long len) {
+        if(len <= 0) return;
+        const Node* prev = floor(start);
+        if(prev && prev->start + prev->len == start) {
+            start = prev->start;
+            len  += prev->len;
+            erase(prev->start);
+        }
+        const Node* next = ceil(start + len);
+        if(next && next->start == start + len) {
+            len += next->len;
+            erase(next->start);
+        }
+        insert(start, len);
+    }
+
+    // Ocupa [start, start+len); debe estar dentro de un solo hueco
+    bool reserve(long long start, long long len) {
+        const Node* gap = floor(start);
+        long long   end;
+        if(!gap || len <= 0 || !addOffset(start, len, end) || end > gap->start + gap->len) return false;
+        long long gapStart = gap->start, gapEnd = gap->start + gap->len;
+        erase(gapStart);
+        if(start > gapStart)     insert(gapStart, start - gapStart);
+        if(start + len < gapEnd) insert(start + len, gapEnd - (start + len));
+        return true;
+    }
+
+    // Inicio del hueco elegido para 'size' bytes según el ajuste
+    // ('F' First, 'B' Best, otro Worst, igual que part_fit); -1 si no cabe
+    long long find(long long size, char fit) const {
+        if(fit == 'F') {
+            const Node* n = root.get();
+            if(!n || n->maxLen < size) return -1;
+            while(true) {
+                if(n->left && n->left->maxLen >= size) n = n->left.get();
+                else if(n->len >= size)                return n->start;
+                else                                   n = n->right.get();
+            }
+        }
+        if(fit == 'B') {
+            auto it = bySize.lower_bound({size, -1});
+            return (it == bySize.end()) ? -1 : it->second;
+        }
+        if(bySize.empty() || bySize.rbegin()->first < size) return -1;
+        // Entre los más grandes, el de menor inicio (igual que antes)
+        return bySize.lower_bound({bySize.rbegin()->first, -1})->second;
+    }
+
+    size_t    count()   const { return bySize.size(); }
+    long long total()   const { return freeBytes; }
+    long long largest() const { return bySize.empty() ? 0 : bySize.rbegin()->first; }
+
+    // Fragmentación externa: 1 - mayor/total (0 = todo en un hueco)
+    double fragmentation() const {
+        return freeBytes == 0 ? 0.0 : 1.0 - (double)largest() / (double)freeBytes;
+    }
+
+    // fn(inicio, tamaño) en orden de inicio
+    template<typename Fn>
+    void forEach(Fn&& fn) const { walk(root.get(), fn); }
+
+private:
+    struct Node {
+        long long start, len, maxLen;
+        uint32_t  prio;
+        std::unique_ptr<Node> left, right;
+    };
+
+    std::unique_ptr<Node> root;
+    std::set<std::pair<long long, long long>> bySize;   // (tamaño, inicio)
+    long long freeBytes = 0;
+    uint32_t  seed      = 2463534242u;
+
+    uint32_t nextPrio() {
+        // xorshift32: prioridades del treap, deterministas
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        return seed;
+    }
+
+    static void update(Node* n) {
+        n->maxLen = n->len;
+        if(n->left)  n->maxLen = std::max(n->maxLen, n->left->maxLen);
+        if(n->right) n->maxLen = std::max(n->maxLen, n->right->maxLen);
+    }
+
+    // Separa 't' en inicio < key (l) e inicio >= key (r)
+    static void split(std::unique_ptr<Node> t, long long key,
+                      std::unique_ptr<Node>& l, std::unique_ptr<Node>& r) {
+        if(!t) { l.reset(); r.reset(); return; }
+        if(t->start < key) {
+            split(std::move(t->right), key, t->right, r);
+            update(t.get());
+            l = std::move(t);
+        } else {
+            split(std::move(t->left), key, l, t->left);
+            update(t.get());
+            r = std::move(t);
+        }
+    }
+
+    static std::unique_ptr<Node> merge(std::unique_ptr<Node> l, std::unique_ptr<Node> r) {
+        if(!l) return r;
+        if(!r) return l;
+        if(l->prio > r->prio) {
+            l->right = merge(std::move(l->right), std::move(r));
+            update(l.get());
+            return l;
+        }
+        r->left = merge(std::move(l), std::move(r->left));
+        update(r.get());
+        return r;
+    }
+
+    void insert(long long start, long long len) {
+        auto n = std::make_unique<Node>();
+        n->start = start;
+        n->len   = len;
+        n->prio  = nextPrio();
+        update(n.get());
+        std::unique_ptr<Node> l, r;
+        split(std::move(root), start, l, r);
+        root = merge(merge(std::move(l), std::move(n)), std::move(r));
+        bySize.insert({len, start});
+        freeBytes += len;
+    }
+
+    void erase(long long start) {
+        std::unique_ptr<Node> l, mid, r;
+        split(std::move(root), start, l, r);
+        split(std::move(r), start + 1, mid, r);
+        if(mid) {
+            bySize.erase({mid->len, mid->start});
+            freeBytes -= mid->len;
+        }
+        root = merge(std::move(l), std::move(r));
+    }
+
+    // Hueco con el mayor inicio <= key
+    const Node* floor(long long key) const {
+        const Node* n = root.get();
+        const Node* best = nullptr;
+        while(n) {
+            if(n->start <= key) { best = n; n = n->right.get(); }
+            else                n = n->left.get();
+        }
+        return best;
+    }
+
+    // Hueco con el menor inicio >= key
+    const Node* ceil(long long key) const {
+        const Node* n = root.get();
+        const Node* best = nullptr;
+        while(n) {
+            if(n->start >= key) { best = n; n = n->left.get(); }
+            else                n = n->right.get();
+        }
+        return best;
+    }
+
+    template<typename Fn>
+    static void walk(const Node* n, Fn& fn) {
+        if(!n) return;
+        walk(n->left.get(), fn);
+        fn(n->start, n->len);
+        walk(n->right.get(), fn);
+    }
+};
+
+// Huecos del disco fuera del MBR y de las 4 particiones
+inline FreeExtents mbrFreeSpace(const MBR& mbr) {
+    FreeExtents free;
+    free.release((long long)sizeof(MBR), (long long)mbr.mbr_tamano - (long long)sizeof(MBR));
+    for(int i = 0; i < 4; i++) {
+        const Partition& part = mbr.mbr_partitions[i];
+        if(part.part_start != -1) free.reserve(part.part_start, part.part_s);
+    }
+    return free;
+}
+
+#endif // FREEEXTENTS_H
@@ -0,0 +1,139 @@
+#ifndef HTTPPARSER_H
+#define HTTPPARSER_H
+
+#include <string>
+#include <unordered_map>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <algorithm>
+#include "Utils.h"
+
+// Límite para la línea de petición + encabezados (el body no tiene límite)
+#define MAX_HEADER_SIZE 65536
+// Máximo que se reserva por adelantado para el body; más allá crece al leer
+#define MAX_BODY_RESERVE (64 * 1024 * 1024)
+
+// Petición HTTP ya completa
+struct HttpRequest {
+    std::string method;
+    std::string path;
+    std::string version;
+    std::unordered_map<std::string, std::string> headers; // claves en minúsculas
+    std::string body;
+    bool        keepAlive = false;
+
+    std::string header(const std::string& name) const {
+        auto it = headers.find(name);
+        return (it == headers.end()) ? "" : it->second;
+    }
+};
+
+// Parser incremental: se le entregan los bytes según llegan del socket
+// y consume del buffer solo cuando una petición está completa.
+// Recuerda hasta dónde buscó "\r\n\r\n" para no re-escanear en cada lectura.
+class HttpParser {
+public:
+    enum Result { NEED_MORE, COMPLETE, BAD_REQUEST, TOO_LARGE, NOT_IMPLEMENTED };
+
+    // Intenta extraer una petición del inicio de 'buf'.
+    // Si retorna COMPLETE, 'out' tiene la petición y sus bytes se eliminan de 'buf'.
+    Result feed(std::string& buf, HttpRequest& out) {
+        if(!headersDone) {
+            // Tolerar CRLF sueltos entre peticiones encadenadas
+            size_t skip = 0;
+            while(skip + 1 < buf.size() && buf[skip] == '\r' && buf[skip+1] == '\n') skip += 2;
+            if(skip > 0) { buf.erase(0, skip); scanPos = 0; }
+
+            size_t from = (scanPos >= 3) ? scanPos - 3 : 0;
+            size_t end  = buf.find("\r\n\r\n", from);
+            if(end == std::string::npos) {
+                scanPos = buf.size();
+                return (buf.size() > MAX_HEADER_SIZE) ? TOO_LARGE : NEED_MORE;
+            }
+            if(end > MAX_HEADER_SIZE) return TOO_LARGE;
+
+            Result r = parseHead(buf, end, current);
+            if(r != COMPLETE) return r;
+
+            headerLen   = end + 4;
+            headersDone = true;
+
+            // Reservar de una vez el espacio del body (acotado: un
+            // Content-Length falso no debe reservar gigas por adelantado)
+            size_t want = headerLen + std::min<size_t>(contentLength, MAX_BODY_RESERVE);
+            if(buf.capacity() < want) buf.reserve(want);
+        }
+
+        if(buf.size() - headerLen < contentLength) return NEED_MORE;
+
+        current.body.assign(buf, headerLen, contentLength);
+        buf.erase(0, headerLen + contentLength);
+        out = std::move(current);
+        reset();
+        return COMPLETE;
+    }
+
+private:
+    HttpRequest current;
+    bool        headersDone   = false;
+    size_t      scanPos       = 0;
+    size_t      headerLen     = 0;
+    size_t      contentLength = 0;
+
+    void reset() {
+        current       = HttpRequest();
+        headersDone   = false;
+        scanPos       = 0;
+        headerLen     = 0;
+        contentLength = 0;
+    }
+
+    Result parseHead(const std::string& buf, size_t end, HttpRequest& req) {
+        // Línea de petición: METODO RUTA VERSION
+        size_t lineEnd = buf.find("\r\n");
+        size_t sp1     = buf.find(' ');
+        if(sp1 == std::string::npos || sp1 > lineEnd) return BAD_REQUEST;
+        size_t sp2     = buf.find(' ', sp1 + 1);
+        if(sp2 == std::string::npos || sp2 > lineEnd) return BAD_REQUEST;
+
+        req.method  = buf.substr(0, sp1);
+        req.path    = buf.substr(sp1 + 1, sp2 - sp1 - 1);
+        req.version = buf.substr(sp2 + 1, lineEnd - sp2 - 1);
+        if(req.version != "HTTP/1.1" && req.version != "HTTP/1.0") return BAD_REQUEST;
+
+        // Encabezados
+        size_t pos = lineEnd + 2;
+        while(pos < end) {
+            size_t eol   = buf.find("\r\n", pos);
+            if(eol == std::string::npos || eol > end) eol = end;
+            size_t colon = buf.find(':', pos);
+            if(colon == std::string::npos || colon > eol) return BAD_REQUEST;
+            std::string key = toLower(buf.substr(pos, colon - pos));
+            std::string val = trim(buf.substr(colon + 1, eol - colon - 1));
+            req.headers[key] = val;
+            pos = eol + 2;
+        }
+
+        if(!req.header("transfer-encoding").empty()) return NOT_IMPLEMENTED;
+
+        contentLength = 0;
+        std::string cl = req.header("content-length");
+        if(!cl.empty()) {
+            if(cl.find_first_not_of("0123456789") != std::string::npos) return BAD_REQUEST;
+            errno = 0;
+            unsigned long long n = std::strtoull(cl.c_str(), nullptr, 10);
+            if(errno == ERANGE) return TOO_LARGE;
+            contentLength = (size_t)n;
+        }
+
+        // HTTP/1.1 mantiene la conexión salvo "Connection: close";
+        // HTTP/1.0 la cierra salvo "Connection: keep-alive"
+        std::string conn = toLower(req.header("connection"));
+        if(req.version == "HTTP/1.1") req.keepAlive = (conn != "close");
+        else                          req.keepAlive = (conn == "keep-alive");
+        return COMPLETE;
+    }
+};
+
+#endif // HTTPPARSER_H
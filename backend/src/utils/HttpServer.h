@@ -0,0 +1,457 @@
+#ifndef HTTPSERVER_H
+#define HTTPSERVER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <mutex>
+#include <memory>
+#include <condition_variable>
+#include <chrono>
+#include <ctime>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "HttpParser.h"
+#include "ThreadPool.h"
+
+// Tamaño de cada lectura del socket
+#define READ_CHUNK 65536
+#define MAX_EVENTS 256
+// Bytes de una respuesta en streaming que pueden estar pendientes de
+// envío antes de que el hilo trabajador espere al cliente
+#define MAX_STREAM_PENDING (256 * 1024)
+
+// Servidor HTTP/1.1 sobre epoll (reactor no bloqueante).
+// Un solo hilo hace accept/read/write de todas las conexiones; cada
+// petición completa se ejecuta en el ThreadPool y la respuesta vuelve
+// al reactor por una cola + eventfd. Las conexiones se mantienen
+// abiertas (keep-alive) mientras el cliente no pida cerrarlas.
+//
+// Un handler puede además enviar partes de la respuesta antes de
+// terminar (streaming) con ResponseStream::write; el hilo trabajador
+// se bloquea si el cliente no consume, así la memoria queda acotada.
+// Si pasan keepAliveSecs sin que el cliente reciba nada, write() se
+// rinde y el reactor cierra la conexión (ver closeIdle).
+class HttpServer {
+public:
+    class ResponseStream;
+
+    // Construye la respuesta (o lo que falte de ella si ya se envió una
+    // parte por 'stream') para una petición
+    using Handler      = std::function<std::string(const HttpRequest&, ResponseStream&)>;
+    // Construye una respuesta de error: (status, json, keepAlive)
+    using ErrorBuilder = std::function<std::string(const std::string&, const std::string&, bool)>;
+
+    HttpServer(ThreadPool& pool, Handler handler, ErrorBuilder errorBuilder)
+        : pool(pool), handler(std::move(handler)), errorBuilder(std::move(errorBuilder)) {}
+
+    ~HttpServer() {
+        for(auto& c : conns) close(c.second.fd);
+        if(listenFd >= 0) close(listenFd);
+        if(wakeFd   >= 0) close(wakeFd);
+        if(epollFd  >= 0) close(epollFd);
+    }
+
+    HttpServer(const HttpServer&)            = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    bool start(int port, int backlog, int keepAliveSecs, std::string& error) {
+        keepAliveTimeout = keepAliveSecs;
+
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if(listenFd < 0) { error = "Error creando socket"; return false; }
+
+        // Permitir reutilizar el puerto
+        int opt = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family      = AF_INET;
+        address.sin_addr.s_addr = INADDR_ANY;
+        address.sin_port        = htons(port);
+
+        if(bind(listenFd, (sockaddr*)&address, sizeof(address)) < 0) {
+            error = "Error en bind"; return false;
+        }
+        if(listen(listenFd, backlog) < 0) {
+            error = "Error en listen"; return false;
+        }
+
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if(epollFd < 0 || wakeFd < 0) { error = "Error creando epoll"; return false; }
+
+        addToEpoll(listenFd, LISTEN_ID, EPOLLIN);
+        addToEpoll(wakeFd,   WAKE_ID,   EPOLLIN);
+        return true;
+    }
+
+    // Bucle principal del reactor (no retorna)
+    void run() {
+        epoll_event events[MAX_EVENTS];
+        time_t lastSweep = time(nullptr);
+
+        while(true) {
+            int n = epoll_wait(epollFd, events, MAX_EVENTS, 1000);
+            if(n < 0 && errno != EINTR) return;
+
+            for(int i = 0; i < n; i++) {
+                uint64_t id = events[i].data.u64;
+                uint32_t ev = events[i].events;
+
+                if(id == LISTEN_ID)     acceptAll();
+                else if(id == WAKE_ID)  drainCompletions();
+                else {
+                    // Sin datos por leer y el socket caído: no hay a quién responder
+                    if((ev & (EPOLLHUP | EPOLLERR)) && !(ev & EPOLLIN)) {
+                        closeConnection(id);
+                        continue;
+                    }
+                    if(ev & EPOLLIN) {
+                        if(!onReadable(id)) continue;
+                    }
+                    if(ev & EPOLLOUT) flush(id);
+                }
+            }
+
+            time_t now = time(nullptr);
+            if(now != lastSweep) {
+                closeIdle(now);
+                lastSweep = now;
+            }
+        }
+    }
+
+    size_t connectionCount() const { return openConnections; }
+
+    // Estado compartido entre el reactor y el hilo que hace streaming
+    struct StreamState {
+        std::mutex              mtx;
+        std::condition_variable cv;
+        size_t                  pending = 0; // bytes entregados y aún no enviados
+        bool                    closed  = false;
+    };
+
+    class ResponseStream {
+    public:
+        ResponseStream(HttpServer& server, uint64_t id, std::shared_ptr<StreamState> state)
+            : server(server), id(id), state(std::move(state)) {}
+
+        // Envía bytes crudos al cliente ya (encabezados o chunks).
+        // Retorna false si el cliente se desconectó o no consumió nada
+        // durante keepAliveTimeout (la conexión se da por perdida).
+        bool write(std::string bytes) {
+            {
+                std::unique_lock<std::mutex> lock(state->mtx);
+                bool ready = state->cv.wait_for(lock, std::chrono::seconds(server.keepAliveTimeout), [this] {
+                    return state->closed || state->pending < MAX_STREAM_PENDING;
+                });
+                if(!ready) state->closed = true;
+                if(state->closed) return false;
+                state->pending += bytes.size();
+            }
+            server.post(id, std::move(bytes), false, false);
+            return true;
+        }
+
+    private:
+        HttpServer&                  server;
+        uint64_t                     id;
+        std::shared_ptr<StreamState> state;
+    };
+
+private:
+    static const uint64_t LISTEN_ID = 0;
+    static const uint64_t WAKE_ID   = 1;
+
+    struct Connection {
+        int         fd;
+        std::string in;
+        std::string out;
+        size_t      outPos          = 0;
+        HttpParser  parser;
+        bool        busy            = false; // petición en ejecución en el pool
+        bool        closeAfterWrite = false;
+        bool        reading         = true;
+        bool        writing         = false;
+        time_t      lastActive      = 0;
+        time_t      lastSent        = 0;     // último avance del envío de 'out'
+        std::shared_ptr<StreamState> stream; // de la petición en ejecución
+    };
+
+    // Respuesta producida por un hilo trabajador
+    struct Completion {
+        uint64_t    conn;
+        std::string data;
+        bool        close;
+        bool        final; // false = parte de una respuesta en streaming
+    };
+
+    ThreadPool&  pool;
+    Handler      handler;
+    ErrorBuilder errorBuilder;
+
+    int listenFd         = -1;
+    int epollFd          = -1;
+    int wakeFd           = -1;
+    int keepAliveTimeout = 15;
+
+    std::unordered_map<uint64_t, Connection> conns;
+    uint64_t                                 nextId = 2;
+    size_t                                   openConnections = 0;
+
+    std::mutex              doneMutex;
+    std::vector<Completion> done;
+
+    void addToEpoll(int fd, uint64_t id, uint32_t events) {
+        epoll_event ev;
+        ev.events   = events;
+        ev.data.u64 = id;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    void updateEvents(uint64_t id, Connection& c) {
+        uint32_t events = 0;
+        if(c.reading) events |= EPOLLIN;
+        if(c.writing) events |= EPOLLOUT;
+        epoll_event ev;
+        ev.events   = events;
+        ev.data.u64 = id;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, c.fd, &ev);
+    }
+
+    void closeConnection(uint64_t id) {
+        auto it = conns.find(id);
+        if(it == conns.end()) return;
+        releaseStream(it->second, true);
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, it->second.fd, nullptr);
+        close(it->second.fd);
+        conns.erase(it);
+        openConnections--;
+    }
+
+    void acceptAll() {
+        while(true) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if(fd < 0) return; // EAGAIN u otro error: se reintenta en el próximo evento
+
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+            uint64_t id = nextId++;
+            Connection& c = conns[id];
+            c.fd         = fd;
+            c.lastActive = time(nullptr);
+            openConnections++;
+            addToEpoll(fd, id, EPOLLIN);
+        }
+    }
+
+    // Lee todo lo disponible. Retorna false si la conexión se cerró.
+    bool onReadable(uint64_t id) {
+        auto it = conns.find(id);
+        if(it == conns.end()) return false;
+        Connection& c = it->second;
+
+        char buf[READ_CHUNK];
+        while(true) {
+            ssize_t n = read(c.fd, buf, sizeof(buf));
+            if(n > 0) {
+                c.in.append(buf, n);
+                continue;
+            }
+            if(n == 0) {
+                // El cliente cerró su lado: terminar lo pendiente y cerrar
+                c.reading         = false;
+                c.closeAfterWrite = true;
+                updateEvents(id, c);
+                break;
+            }
+            if(errno == EINTR) continue;
+            if(errno == EAGAIN || errno == EWOULDBLOCK) break;
+            closeConnection(id);
+            return false;
+        }
+
+        c.lastActive = time(nullptr);
+        return processInput(id);
+    }
+
+    // Extrae peticiones completas del buffer de entrada y las despacha.
+    // Solo hay una petición en ejecución por conexión para respetar el orden.
+    bool processInput(uint64_t id) {
+        auto it = conns.find(id);
+        if(it == conns.end()) return false;
+        Connection& c = it->second;
+
+        while(!c.busy) {
+            HttpRequest req;
+            HttpParser::Result r = c.parser.feed(c.in, req);
+
+            if(r == HttpParser::NEED_MORE) break;
+
+            if(r != HttpParser::COMPLETE) {
+                std::string status =
+                    (r == HttpParser::TOO_LARGE)       ? "431 Request Header Fields Too Large" :
+                    (r == HttpParser::NOT_IMPLEMENTED) ? "501 Not Implemented" :
+                                                         "400 Bad Request";
+                queueOut(c, errorBuilder(status, "{\"error\":\"Petición inválida\"}", false));
+                c.closeAfterWrite = true;
+                c.reading         = false;
+                c.in.clear();
+                updateEvents(id, c);
+                break;
+            }
+
+            bool keepAlive = req.keepAlive && !c.closeAfterWrite;
+            if(!keepAlive) {
+                c.closeAfterWrite = true;
+                c.reading         = false;
+                updateEvents(id, c);
+            }
+
+            c.busy   = true;
+            c.stream = std::make_shared<StreamState>();
+            bool queued = pool.trySubmit([this, id, state = c.stream, req = std::move(req)] {
+                ResponseStream stream(*this, id, state);
+                std::string response = handler(req, stream);
+                post(id, std::move(response), !req.keepAlive, true);
+            });
+
+            if(!queued) {
+                c.busy   = false;
+                c.stream = nullptr;
+                queueOut(c, errorBuilder("503 Service Unavailable",
+                                         "{\"error\":\"Servidor ocupado, intente de nuevo\"}",
+                                         keepAlive));
+            }
+            if(!keepAlive) break;
+        }
+
+        return flush(id);
+    }
+
+    // Agrega al envío pendiente; si estaba vacío, la espera del cliente
+    // se cuenta desde ahora
+    void queueOut(Connection& c, const std::string& data) {
+        if(c.out.empty()) c.lastSent = time(nullptr);
+        c.out += data;
+    }
+
+    // Escribe lo pendiente. Retorna false si la conexión se cerró.
+    bool flush(uint64_t id) {
+        auto it = conns.find(id);
+        if(it == conns.end()) return false;
+        Connection& c = it->second;
+
+        while(c.outPos < c.out.size()) {
+            ssize_t n = send(c.fd, c.out.data() + c.outPos,
+                             c.out.size() - c.outPos, MSG_NOSIGNAL);
+            if(n > 0) {
+                c.outPos += n;
+                c.lastSent = time(nullptr);
+                if(c.stream) {
+                    std::lock_guard<std::mutex> lock(c.stream->mtx);
+                    c.stream->pending -= std::min<size_t>(c.stream->pending, n);
+                    c.stream->cv.notify_all();
+                }
+                continue;
+            }
+            if(n < 0 && errno == EINTR) continue;
+            if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                if(!c.writing) { c.writing = true; updateEvents(id, c); }
+                return true;
+            }
+            closeConnection(id);
+            return false;
+        }
+
+        c.out.clear();
+        c.outPos = 0;
+        if(c.writing) { c.writing = false; updateEvents(id, c); }
+
+        if(c.closeAfterWrite && !c.busy) {
+            closeConnection(id);
+            return false;
+        }
+        return true;
+    }
+
+    // Llamado desde los hilos trabajadores
+    void post(uint64_t id, std::string data, bool closeAfter, bool final) {
+        {
+            std::lock_guard<std::mutex> lock(doneMutex);
+            done.push_back({id, std::move(data), closeAfter, final});
+        }
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    void drainCompletions() {
+        uint64_t counter;
+        while(read(wakeFd, &counter, sizeof(counter)) > 0) {}
+
+        std::vector<Completion> batch;
+        {
+            std::lock_guard<std::mutex> lock(doneMutex);
+            batch.swap(done);
+        }
+
+        for(auto& comp : batch) {
+            auto it = conns.find(comp.conn);
+            if(it == conns.end()) continue; // el cliente ya se fue
+            Connection& c = it->second;
+            c.lastActive = time(nullptr);
+            queueOut(c, comp.data);
+            if(!comp.final) {
+                flush(comp.conn);
+                continue;
+            }
+            c.busy = false;
+            releaseStream(c, false);
+            if(comp.close) c.closeAfterWrite = true;
+
+            // Atender peticiones encadenadas que llegaron mientras tanto
+            processInput(comp.conn);
+        }
+    }
+
+    // Despierta a un hilo que espera para escribir en esta conexión
+    void releaseStream(Connection& c, bool closed) {
+        if(!c.stream) return;
+        {
+            std::lock_guard<std::mutex> lock(c.stream->mtx);
+            if(closed) c.stream->closed = true;
+            c.stream->cv.notify_all();
+        }
+        c.stream = nullptr;
+    }
+
+    // Cierra las conexiones inactivas y las que tienen respuesta
+    // pendiente que el cliente no recibe hace keepAliveTimeout, aunque
+    // estén en ejecución: closeConnection despierta al hilo que espera
+    // en ResponseStream::write para que no quede tomado del pool.
+    void closeIdle(time_t now) {
+        std::vector<uint64_t> idle;
+        for(const auto& entry : conns) {
+            const Connection& c = entry.second;
+            bool inactive = !c.busy && c.out.empty() && now - c.lastActive >= keepAliveTimeout;
+            bool stalled  = !c.out.empty() && now - c.lastSent >= keepAliveTimeout;
+            if(inactive || stalled) idle.push_back(entry.first);
+        }
+        for(uint64_t id : idle) closeConnection(id);
+    }
+};
+
+#endif // HTTPSERVER_H
@@ -0,0 +1,76 @@
+#ifndef INODEBLOCKS_H
+#define INODEBLOCKS_H
+
+#include <climits>
+#include <algorithm>
+#include "../structs/Structs.h"
+#include "DiskView.h"
+
+// Apuntadores de un inodo: 12 directos + indirecto simple, doble y triple
+#define DIRECT_BLOCKS 12
+
+// =============================================
+// INODE BLOCKS
+// Recorre los bloques de datos de un inodo en orden lógico. Con P
+// apuntadores por bloque (s_block_s / 4; 16 en bloques de 64 bytes):
+//   i_block[0..11] directos            -> lógicos 0..11
+//   i_block[12]    indirecto simple    -> P bloques
+//   i_block[13]    indirecto doble     -> P² bloques
+//   i_block[14]    indirecto triple    -> P³ bloques
+// Un apuntador en -1 es un hueco: se salta junto con todo lo que
+// habría debajo de él, pero los índices lógicos se respetan.
+// =============================================
+class InodeBlocks {
+public:
+    // Bloques lógicos que alcanza un inodo (12 + P + P² + P³)
+    static long long maxBlocks(PartitionView& fs) {
+        return DIRECT_BLOCKS + span(fs, 1) + span(fs, 2) + span(fs, 3);
+    }
+
+    // Bytes que puede tener un archivo: lo que alcanzan sus bloques,
+    // limitado por i_s (32 bits)
+    static long long maxBytes(PartitionView& fs) {
+        return std::min<long long>(maxBlocks(fs) * fs.blockSize(), INT_MAX);
+    }
+
+    // fn(long long logico, int fisico) -> bool (false = detenerse).
+    // Retorna false si fn pidió detenerse.
+    template<typename Fn>
+    static bool forEach(PartitionView& fs, const Inode& inode, Fn&& fn) {
+        for(int i = 0; i < DIRECT_BLOCKS; i++) {
+            if(inode.i_block[i] != -1 && !fn((long long)i, inode.i_block[i])) return false;
+        }
+        long long base = DIRECT_BLOCKS;
+        for(int level = 1; level <= 3; level++) {
+            int ptr = inode.i_block[DIRECT_BLOCKS + level - 1];
+            if(ptr != -1 && !walk(fs, ptr, level, base, fn)) return false;
+            base += span(fs, level);
+        }
+        return true;
+    }
+
+    // Bloques lógicos que cubre un apuntador del nivel dado (P^nivel)
+    static long long span(PartitionView& fs, int level) {
+        long long n = 1;
+        for(int i = 0; i < level; i++) n *= fs.blockWords();
+        return n;
+    }
+
+private:
+    template<typename Fn>
+    static bool walk(PartitionView& fs, int ptr, int level, long long base, Fn& fn) {
+        const int32_t* pointers = fs.words(ptr);
+        long long step = span(fs, level - 1);
+        for(int i = 0; i < fs.blockWords(); i++) {
+            int child = pointers[i];
+            if(child == -1) continue;
+            long long logical = base + i * step;
+            bool more = (level == 1) ? fn(logical, child)
+                                     : walk(fs, child, level - 1, logical, fn);
+            if(!more) return false;
+        }
+        return true;
+    }
+};
+
+#endif // INODEBLOCKS_H
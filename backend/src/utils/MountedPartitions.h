@@ -3,79 +3,161 @@
 
 #include <string>
 #include <vector>
-#include <map>
+#include <memory>
+#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
 
 // Información de una partición montada en RAM
 struct MountedPartition {
     std::string id;       // Ej: 111A
     std::string path;     // Ruta del disco
     std::string name;     // Nombre de la partición
-    int         start;    // Byte de inicio en el disco
-    int         size;     // Tamaño en bytes
+    long long   start;    // Byte de inicio en el disco
+    long long   size;     // Tamaño en bytes
+    long long   order = 0; // orden de montaje (para listarlas)
 };
 
+// =============================================
+// MOUNTED PARTITIONS
+// Registro de particiones montadas indexado por hash:
+//   ID -> entrada, (disco, nombre) -> ID
+// y por disco la letra asignada y el siguiente correlativo, que se
+// mantienen al montar (sin recorrer lo ya montado). Las entradas son
+// shared_ptr inmutables: una referencia obtenida con get() sigue siendo
+// válida aunque después se monte o desmonte cualquier partición.
+// =============================================
 class MountedPartitions {
 public:
-    // Lista global de particiones montadas (en RAM)
-    static std::vector<MountedPartition> mounted;
+    // Protege los índices: búsquedas con el candado compartido,
+    // mount/unmount con el exclusivo
+    static std::shared_mutex mtx;
 
     // Carnet: últimos 2 dígitos = "11"
     static const std::string CARNET_SUFFIX;
 
-    static std::string getNextID(const std::string& diskPath) {
-        // Buscar si ya hay particiones de este disco montadas
-        char letter = 'A';
-        int  number = 1;
-
-        // Buscar la letra actual según discos ya montados
-        std::map<std::string, char> diskLetters;
-        for(const auto& mp : mounted) {
-            if(diskLetters.find(mp.path) == diskLetters.end()) {
-                diskLetters[mp.path] = letter++;
-            }
+    // Registra la partición de forma atómica (verificar + generar ID + agregar).
+    // Retorna false (con el motivo en 'error') si ya estaba montada o si
+    // ya no quedan letras para un disco nuevo. En 'out' queda la entrada
+    // final y en 'correlativo' su número dentro del disco.
+    static bool tryMount(const std::string& path, const std::string& name,
+                         long long start, long long size,
+                         MountedPartition& out, int& correlativo, std::string& error) {
+        std::unique_lock<std::shared_mutex> lock(mtx);
+        std::string key = pathNameKey(path, name);
+        if(byPathName.count(key)) {
+            error = "La partición ya está montada";
+            return false;
         }
 
-        // Ver si este disco ya tiene letra
-        if(diskLetters.find(diskPath) != diskLetters.end()) {
-            // Contar particiones de este disco
-            char myLetter = diskLetters[diskPath];
-            int  count    = 0;
-            for(const auto& mp : mounted) {
-                if(mp.path == diskPath) count++;
-            }
-            return CARNET_SUFFIX + std::to_string(count + 1) + myLetter;
-        } else {
-            // Nuevo disco, nueva letra
-            char newLetter = 'A';
-            // La letra es la siguiente a todas las ya usadas
-            std::vector<char> usedLetters;
-            for(const auto& dl : diskLetters) usedLetters.push_back(dl.second);
-            if(!usedLetters.empty()) {
-                std::sort(usedLetters.begin(), usedLetters.end());
-                newLetter = usedLetters.back() + 1;
+        // El disco recibe su letra la primera vez que se monta algo de él;
+        // el número no se reutiliza al desmontar (los IDs no se repiten)
+        auto disk = disks.find(path);
+        if(disk == disks.end()) {
+            if(nextLetter > 'Z') {
+                error = "No quedan letras para montar otro disco (A-Z)";
+                return false;
             }
-            return CARNET_SUFFIX + "1" + newLetter;
+            disk = disks.emplace(path, DiskState{nextLetter++, 1}).first;
         }
+        correlativo = disk->second.next++;
+
+        auto entry = std::make_shared<MountedPartition>();
+        entry->id    = CARNET_SUFFIX + std::to_string(correlativo) + disk->second.letter;
+        entry->path  = path;
+        entry->name  = name;
+        entry->start = start;
+        entry->size  = size;
+        entry->order = nextOrder++;
+
+        byId[entry->id] = entry;
+        byPathName[key] = entry->id;
+        out = *entry;
+        return true;
     }
 
-    static MountedPartition* findById(const std::string& id) {
-        for(auto& mp : mounted) {
-            if(mp.id == id) return &mp;
-        }
-        return nullptr;
+    // Quita la partición del registro; en 'out' queda la entrada quitada
+    static bool unmount(const std::string& id, MountedPartition& out) {
+        std::unique_lock<std::shared_mutex> lock(mtx);
+        auto it = byId.find(id);
+        if(it == byId.end()) return false;
+        out = *it->second;
+        byPathName.erase(pathNameKey(out.path, out.name));
+        byId.erase(it);
+        return true;
+    }
+
+    // Referencia estable a la entrada (nullptr si no está montada)
+    static std::shared_ptr<const MountedPartition> get(const std::string& id) {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        auto it = byId.find(id);
+        return (it == byId.end()) ? nullptr : it->second;
+    }
+
+    static bool findById(const std::string& id, MountedPartition& out) {
+        std::shared_ptr<const MountedPartition> mp = get(id);
+        if(!mp) return false;
+        out = *mp;
+        return true;
+    }
+
+    static bool findByPathAndName(const std::string& path,
+                                  const std::string& name,
+                                  MountedPartition& out) {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        auto it = byPathName.find(pathNameKey(path, name));
+        if(it == byPathName.end()) return false;
+        out = *byId.at(it->second);
+        return true;
     }
 
-    static MountedPartition* findByPathAndName(const std::string& path,
-                                                const std::string& name) {
-        for(auto& mp : mounted) {
-            if(mp.path == path && mp.name == name) return &mp;
+    // Copia de lo montado, en el orden en que se montó
+    static std::vector<MountedPartition> snapshot() {
+        std::vector<MountedPartition> result;
+        {
+            std::shared_lock<std::shared_mutex> lock(mtx);
+            result.reserve(byId.size());
+            for(const auto& entry : byId) result.push_back(*entry.second);
         }
-        return nullptr;
+        std::sort(result.begin(), result.end(),
+                  [](const MountedPartition& a, const MountedPartition& b) { return a.order < b.order; });
+        return result;
+    }
+
+    static size_t count() {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        return byId.size();
+    }
+
+private:
+    struct DiskState {
+        char letter;
+        int  next;   // siguiente correlativo
+    };
+
+    static std::unordered_map<std::string, std::shared_ptr<const MountedPartition>> byId;
+    static std::unordered_map<std::string, std::string> byPathName;
+    static std::unordered_map<std::string, DiskState>   disks;
+    static char      nextLetter;
+    static long long nextOrder;
+
+    static std::string pathNameKey(const std::string& path, const std::string& name) {
+        std::string key;
+        key.reserve(path.size() + name.size() + 1);
+        key.append(path).push_back('\0');
+        key.append(name);
+        return key;
     }
 };
 
 // Definiciones estáticas
-std::vector<MountedPartition> MountedPartitions::mounted;
+std::shared_mutex MountedPartitions::mtx;
 const std::string MountedPartitions::CARNET_SUFFIX = "11";
+std::unordered_map<std::string, std::shared_ptr<const MountedPartition>> MountedPartitions::byId;
+std::unordered_map<std::string, std::string> MountedPartitions::byPathName;
+std::unordered_map<std::string, MountedPartitions::DiskState> MountedPartitions::disks;
+char      MountedPartitions::nextLetter = 'A';
+long long MountedPartitions::nextOrder  = 0;
 
-#endif // MOUNTEDPARTITIONS_H
\ No newline at end of file
+#endif // MOUNTEDPARTITIONS_H
@@ -0,0 +1,217 @@
+#ifndef PATHRESOLVER_H
+#define PATHRESOLVER_H
+
+#include <string>
+#include <string_view>
+#include <list>
+#include <mutex>
+#include <cstring>
+#include <unordered_map>
+#include "../structs/Structs.h"
+#include "DiskView.h"
+#include "InodeBlocks.h"
+#include "DirIndex.h"
+
+// Entradas (padre, nombre) -> inodo que se recuerdan en total
+#define DENTRY_CACHE_SIZE 8192
+
+struct DentryStats {
+    size_t    entries = 0;
+    long long hits    = 0;
+    long long misses  = 0;
+};
+
+// =============================================
+// DENTRY CACHE
+// Caché acotado (LRU) de búsquedas en carpetas:
+// (partición, inodo padre, nombre) -> inodo hijo.
+// También guarda resultados negativos (-1 = "no existe"), así buscar
+// varias veces algo ausente no vuelve a recorrer la carpeta.
+// Quien cree, borre o renombre una entrada debe actualizarlo con
+// put()/erase() antes de soltar el candado exclusivo del disco;
+// mkfs, mkdisk y rmdisk descartan el disco completo con invalidate().
+// =============================================
+class DentryCache {
+public:
+    // true si hay entrada; 'child' queda en -1 si es negativa
+    static bool find(const std::string& part, int parent, std::string_view name, int& child) {
+        std::string k = key(part, parent, name);
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = index.find(k);
+        if(it == index.end()) { misses++; return false; }
+        hits++;
+        lru.splice(lru.begin(), lru, it->second);
+        child = it->second->child;
+        return true;
+    }
+
+    static void put(const std::string& part, int parent, std::string_view name, int child) {
+        std::string k = key(part, parent, name);
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = index.find(k);
+        if(it != index.end()) {
+            it->second->child = child;
+            lru.splice(lru.begin(), lru, it->second);
+            return;
+        }
+        if(lru.size() >= DENTRY_CACHE_SIZE) {
+            index.erase(lru.back().key);
+            lru.pop_back();
+        }
+        lru.push_front({k, child});
+        index.emplace(std::move(k), lru.begin());
+    }
+
+    static void erase(const std::string& part, int parent, std::string_view name) {
+        std::string k = key(part, parent, name);
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = index.find(k);
+        if(it == index.end()) return;
+        lru.erase(it->second);
+        index.erase(it);
+    }
+
+    // Olvida todas las particiones de un disco
+    static void invalidate(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::string prefix = path + "@";
+        for(auto it = lru.begin(); it != lru.end(); ) {
+            if(it->key.compare(0, prefix.size(), prefix) == 0) {
+                index.erase(it->key);
+                it = lru.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    static DentryStats stats() {
+        std::lock_guard<std::mutex> lock(mtx);
+        DentryStats st;
+        st.entries = lru.size();
+        st.hits    = hits;
+        st.misses  = misses;
+        return st;
+    }
+
+    // Identificador de partición (mismo formato que BitmapCache)
+    static std::string partition(const std::string& path, long long start) {
+        return path + "@" + std::to_string(start);
+    }
+
+private:
+    struct Entry {
+        std::string key;
+        int         child;
+    };
+
+    static std::mutex       mtx;
+    static std::list<Entry> lru; // frente = más reciente
+    static std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    static long long        hits;
+    static long long        misses;
+
+    static std::string key(const std::string& part, int parent, std::string_view name) {
+        std::string k;
+        k.reserve(part.size() + name.size() + 12);
+        k.append(part).push_back('#');
+        k.append(std::to_string(parent)).push_back('/');
+        k.append(name);
+        return k;
+    }
+};
+
+// Definiciones estáticas
+std::mutex                    DentryCache::mtx;
+std::list<DentryCache::Entry> DentryCache::lru;
+std::unordered_map<std::string, std::list<DentryCache::Entry>::iterator> DentryCache::index;
+long long                     DentryCache::hits   = 0;
+long long                     DentryCache::misses = 0;
+
+// =============================================
+// PATH RESOLVER
+// Resuelve rutas absolutas ("/a/b/c") a números de inodo sobre una
+// PartitionView. Cada componente se busca primero en el DentryCache y
+// solo si falta se busca en la carpeta: con su DirIndex si lo tiene, si
+// no recorriendo los bloques (directos e indirectos). El inodo 0 es la
+// raíz; "." y ".." se resuelven con las entradas que mkfs escribe en
+// cada carpeta.
+// Requiere el candado del disco (compartido para leer).
+// =============================================
+class PathResolver {
+public:
+    static const int ROOT_INODE = 0;
+
+    PathResolver(PartitionView& fs, const std::string& diskPath, long long start)
+        : fs(fs), part(DentryCache::partition(diskPath, start)) {}
+
+    // Inodo de 'path', o -1 si algún componente no existe
+    // (o un componente intermedio no es carpeta)
+    int resolve(std::string_view path) {
+        int current = ROOT_INODE;
+        size_t pos = 0;
+        std::string_view name;
+        while(nextComponent(path, pos, name)) {
+            current = lookup(current, name);
+            if(current < 0) return -1;
+        }
+        return current;
+    }
+
+    // Inodo de la carpeta que contiene 'path' y nombre del último
+    // componente ("/a/b/c" -> inodo de "/a/b", "c"). -1 si no existe
+    // la carpeta o la ruta es la raíz.
+    int resolveParent(std::string_view path, std::string_view& name) {
+        int current = ROOT_INODE;
+        size_t pos = 0;
+        std::string_view comp;
+        if(!nextComponent(path, pos, comp)) return -1;
+        while(true) {
+            std::string_view next;
+            if(!nextComponent(path, pos, next)) { name = comp; return current; }
+            current = lookup(current, comp);
+            if(current < 0) return -1;
+            comp = next;
+        }
+    }
+
+    // Busca 'name' dentro de la carpeta 'dir'; -1 si no existe
+    int lookup(int dir, std::string_view name) {
+        if(name.empty() || name.size() > MAX_NAME_LEN) return -1;
+
+        int child;
+        if(DentryCache::find(part, dir, name, child)) return child;
+
+        child = scan(dir, name);
+        DentryCache::put(part, dir, name, child);
+        return child;
+    }
+
+    // Avisos tras modificar una carpeta (con el candado exclusivo)
+    void added(int dir, std::string_view name, int child) { DentryCache::put(part, dir, name, child); }
+    void removed(int dir, std::string_view name)          { DentryCache::put(part, dir, name, -1); }
+
+private:
+    PartitionView& fs;
+    std::string    part;
+
+    // Busca en los bloques de 'dir': por su índice de hash si lo tiene,
+    // si no recorriéndolos todos
+    int scan(int dir, std::string_view name) {
+        return DirIndex::find(fs, dir, name);
+    }
+
+    // Siguiente componente no vacío de la ruta ("." se ignora)
+    static bool nextComponent(std::string_view path, size_t& pos, std::string_view& out) {
+        while(pos < path.size()) {
+            while(pos < path.size() && path[pos] == '/') pos++;
+            size_t start = pos;
+            while(pos < path.size() && path[pos] != '/') pos++;
+            out = path.substr(start, pos - start);
+            if(!out.empty() && out != ".") return true;
+        }
+        return false;
+    }
+};
+
+#endif // PATHRESOLVER_H
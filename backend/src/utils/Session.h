@@ -2,25 +2,119 @@
 #define SESSION_H
 
 #include <string>
+#include <mutex>
+#include <ctime>
+#include <cstdio>
+#include <unordered_map>
+#include <sys/random.h>
 
-// Sesión activa global
+// Segundos sin uso tras los que una sesión se descarta
+#define DEFAULT_SESSION_IDLE 1800
+
+// Sesión de un usuario (una por cliente, identificada por su token)
 struct Session {
-    bool        active   = false;
     std::string username = "";
     std::string id       = "";   // ID de partición montada
     int         uid      = -1;
     int         gid      = -1;
+    time_t      lastUsed = 0;
+};
+
+// Sesión con la que se ejecuta un request: el token que mandó el
+// cliente (encabezado X-Session-Token o cookie "session") y, si login o
+// logout lo cambian, el nuevo valor que hay que devolverle
+struct SessionContext {
+    std::string token;
+    bool        changed = false;
+};
+
+// =============================================
+// SESSION TABLE
+// Sesiones activas indexadas por token (128 bits aleatorios en hex).
+// Buscar, crear y cerrar son O(1) bajo un mutex; una sesión que pasa
+// más de 'idleTimeout' segundos sin usarse se descarta al buscarla o en
+// el barrido que se hace como mucho una vez por minuto.
+// =============================================
+class SessionTable {
+public:
+    static time_t idleTimeout;
+
+    // Registra la sesión y retorna su token ("" si no hay aleatoriedad)
+    static std::string create(Session session) {
+        std::string token = newToken();
+        if(token.empty()) return "";
+        time_t now = time(nullptr);
+        session.lastUsed = now;
+
+        std::lock_guard<std::mutex> lock(mtx);
+        sweep(now);
+        sessions[token] = std::move(session);
+        return token;
+    }
+
+    // Copia la sesión de 'token' y renueva su tiempo de uso
+    static bool find(const std::string& token, Session& out) {
+        if(token.empty()) return false;
+        time_t now = time(nullptr);
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = sessions.find(token);
+        if(it == sessions.end()) return false;
+        if(now - it->second.lastUsed >= idleTimeout) {
+            sessions.erase(it);
+            return false;
+        }
+        it->second.lastUsed = now;
+        out = it->second;
+        return true;
+    }
+
+    static bool remove(const std::string& token) {
+        std::lock_guard<std::mutex> lock(mtx);
+        return sessions.erase(token) > 0;
+    }
+
+    // Sesiones registradas. Usa el mismo barrido de una vez por minuto
+    // que create(), así que puede contar sesiones vencidas en el último
+    // minuto que todavía nadie buscó.
+    static size_t count() {
+        std::lock_guard<std::mutex> lock(mtx);
+        sweep(time(nullptr));
+        return sessions.size();
+    }
+
+private:
+    static std::mutex mtx;
+    static std::unordered_map<std::string, Session> sessions;
+    static time_t lastSweep;
+
+    // Requiere 'mtx'
+    static void sweep(time_t now) {
+        if(now - lastSweep < 60) return;
+        lastSweep = now;
+        for(auto it = sessions.begin(); it != sessions.end(); ) {
+            if(now - it->second.lastUsed >= idleTimeout) it = sessions.erase(it);
+            else ++it;
+        }
+    }
 
-    void clear() {
-        active   = false;
-        username = "";
-        id       = "";
-        uid      = -1;
-        gid      = -1;
+    static std::string newToken() {
+        unsigned char raw[16];
+        size_t got = 0;
+        while(got < sizeof(raw)) {
+            ssize_t n = getrandom(raw + got, sizeof(raw) - got, 0);
+            if(n <= 0) return "";
+            got += n;
+        }
+        char hex[sizeof(raw) * 2 + 1];
+        for(size_t i = 0; i < sizeof(raw); i++) snprintf(hex + i * 2, 3, "%02x", raw[i]);
+        return std::string(hex, sizeof(raw) * 2);
     }
 };
 
-// Instancia global
-static Session currentSession;
+// Definiciones estáticas
+std::mutex                               SessionTable::mtx;
+std::unordered_map<std::string, Session> SessionTable::sessions;
+time_t                                   SessionTable::lastSweep   = 0;
+time_t                                   SessionTable::idleTimeout = DEFAULT_SESSION_IDLE;
 
-#endif // SESSION_H
\ No newline at end of file
+#endif // SESSION_H
@@ -0,0 +1,116 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <algorithm>
+
+// Pool fijo de hilos trabajadores con cola acotada.
+// trySubmit() no bloquea: si la cola está llena retorna false
+// y el llamador decide qué hacer (el servidor responde 503).
+class ThreadPool {
+public:
+    ThreadPool(size_t numWorkers, size_t maxQueue)
+        : maxQueue(maxQueue) {
+        if(numWorkers == 0) numWorkers = 1;
+        for(size_t i = 0; i < numWorkers; i++) {
+            workers.emplace_back([this] { workerLoop(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        cv.notify_all();
+        for(auto& t : workers) t.join();
+    }
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    bool trySubmit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if(stopping || tasks.size() >= maxQueue) return false;
+            tasks.push_back(std::move(task));
+        }
+        cv.notify_one();
+        return true;
+    }
+
+    size_t size() const { return workers.size(); }
+
+    size_t pending() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return tasks.size();
+    }
+
+private:
+    std::vector<std::thread>          workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex                        mtx;
+    std::condition_variable           cv;
+    size_t                            maxQueue;
+    bool                              stopping = false;
+
+    void workerLoop() {
+        while(true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if(stopping && tasks.empty()) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+// -----------------------------------------------
+// Trabajo en paralelo de un solo comando (fsck, reportes)
+// -----------------------------------------------
+
+// Hilos a usar para recorrer una partición: los núcleos, hasta 8
+inline size_t scanThreads() {
+    size_t n = std::thread::hardware_concurrency();
+    return std::max<size_t>(1, std::min<size_t>(n, 8));
+}
+
+// Reparte [0, count) en tramos contiguos (múltiplos de 'align') y llama
+// fn(tramo, inicio, fin) en hilos propios; con menos de 'minPerThread'
+// elementos por hilo usa menos hilos, y con uno solo corre aquí mismo.
+// Una excepción de un tramo se relanza al terminar todos.
+// Retorna cuántos tramos se usaron.
+template<typename Fn>
+size_t parallelFor(size_t count, size_t minPerThread, Fn&& fn, size_t align = 1) {
+    if(count == 0) return 0;
+    size_t parts = std::min(scanThreads(), std::max<size_t>(1, count / std::max<size_t>(1, minPerThread)));
+    size_t step  = (count + parts - 1) / parts;
+    step  = (step + align - 1) / align * align;
+    parts = (count + step - 1) / step;
+    if(parts == 1) { fn((size_t)0, (size_t)0, count); return 1; }
+
+    std::vector<std::thread>        threads;
+    std::vector<std::exception_ptr> errors(parts);
+    for(size_t t = 0; t < parts; t++) {
+        size_t from = t * step, to = std::min(count, from + step);
+        threads.emplace_back([&, t, from, to] {
+            try { fn(t, from, to); }
+            catch(...) { errors[t] = std::current_exception(); }
+        });
+    }
+    for(auto& th : threads) th.join();
+    for(auto& e : errors) if(e) std::rethrow_exception(e);
+    return parts;
+}
+
+#endif // THREADPOOL_H
@@ -0,0 +1,137 @@
+#ifndef USERSTABLE_H
+#define USERSTABLE_H
+
+#include <string>
+#include <string_view>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <unordered_map>
+#include "CommandParser.h"
+
+// Usuario activo de users.txt
+struct UserRecord {
+    int         uid = -1;
+    int         gid = -1;    // -1 si su grupo no existe
+    std::string group;
+    std::string pass;
+};
+
+// =============================================
+// USERS TABLE
+// users.txt ya interpretado, indexado por nombre de usuario y de grupo.
+// Formato de cada línea:
+//   GID,G,grupo
+//   UID,U,grupo,usuario,contraseña
+// Las líneas con id 0 (eliminadas) se ignoran; si un nombre se repite
+// gana la primera línea activa, igual que la búsqueda secuencial.
+// =============================================
+struct UsersTable {
+    std::unordered_map<std::string, UserRecord> users;
+    std::unordered_map<std::string, int>        groups;
+
+    // Una sola pasada sobre el contenido, con vistas (sin getline/CSV)
+    static std::shared_ptr<UsersTable> parse(std::string_view content) {
+        auto table = std::make_shared<UsersTable>();
+        size_t pos = 0;
+        while(pos < content.size()) {
+            size_t eol = content.find('\n', pos);
+            if(eol == std::string_view::npos) eol = content.size();
+            std::string_view line = content.substr(pos, eol - pos);
+            pos = eol + 1;
+
+            std::string_view f[5];
+            size_t n = split(line, f, 5);
+            if(n < 3) continue;
+            int id;
+            if(!parseInt(f[0], id) || id == 0) continue;
+
+            if(f[1] == "G") {
+                table->groups.emplace(std::string(f[2]), id);
+            } else if(f[1] == "U" && n >= 5) {
+                UserRecord rec;
+                rec.uid   = id;
+                rec.group = std::string(f[2]);
+                rec.pass  = std::string(f[4]);
+                table->users.emplace(std::string(f[3]), std::move(rec));
+            }
+        }
+
+        // Los grupos pueden aparecer después de sus usuarios
+        for(auto& entry : table->users) {
+            auto it = table->groups.find(entry.second.group);
+            entry.second.gid = (it == table->groups.end()) ? -1 : it->second;
+        }
+        return table;
+    }
+
+private:
+    // Separa por comas (recortando espacios) hasta 'max' campos
+    static size_t split(std::string_view line, std::string_view* out, size_t max) {
+        size_t n = 0, pos = 0;
+        while(n < max) {
+            size_t comma = line.find(',', pos);
+            out[n++] = trimView(line.substr(pos, comma - pos));
+            if(comma == std::string_view::npos) break;
+            pos = comma + 1;
+        }
+        return n;
+    }
+};
+
+// =============================================
+// USERS CACHE
+// UsersTable por partición montada (ruta + inicio), para que login no
+// vuelva a leer ni a interpretar users.txt. Cada cambio a users.txt (o
+// mkfs/mkdisk/rmdisk sobre el disco) llama invalidate(), que además
+// sube el número de generación: una tabla leída antes de ese cambio ya
+// no se guarda aunque su lectura termine después.
+// =============================================
+class UsersCache {
+public:
+    static uint64_t generation() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return currentGeneration;
+    }
+
+    static std::shared_ptr<const UsersTable> find(const std::string& path, long long start) {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = entries.find(key(path, start));
+        return (it == entries.end()) ? nullptr : it->second;
+    }
+
+    // Guarda la tabla solo si nada cambió desde 'gen' (tomada antes de leer)
+    static void put(const std::string& path, long long start,
+                    std::shared_ptr<const UsersTable> table, uint64_t gen) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if(gen != currentGeneration) return;
+        entries[key(path, start)] = std::move(table);
+    }
+
+    // Olvida todas las particiones de un disco
+    static void invalidate(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mtx);
+        currentGeneration++;
+        std::string prefix = path + "@";
+        for(auto it = entries.begin(); it != entries.end(); ) {
+            if(it->first.compare(0, prefix.size(), prefix) == 0) it = entries.erase(it);
+            else ++it;
+        }
+    }
+
+private:
+    static std::mutex mtx;
+    static uint64_t   currentGeneration;
+    static std::unordered_map<std::string, std::shared_ptr<const UsersTable>> entries;
+
+    static std::string key(const std::string& path, long long start) {
+        return path + "@" + std::to_string(start);
+    }
+};
+
+// Definiciones estáticas
+std::mutex UsersCache::mtx;
+uint64_t   UsersCache::currentGeneration = 0;
+std::unordered_map<std::string, std::shared_ptr<const UsersTable>> UsersCache::entries;
+
+#endif // USERSTABLE_H
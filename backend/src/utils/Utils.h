@@ -9,6 +9,9 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <unistd.h>
 
 // Convierte string a minúsculas
 inline std::string toLower(std::string s) {
@@ -65,51 +68,37 @@ inline std::string getFileName(const std::string& path) {
     return path.substr(pos + 1);
 }
 
-// Parsea los parámetros de un comando
-// Ejemplo: mkdisk -size=10 -unit=M -path=/home/disco.mia
-// Retorna map de {param -> valor}
-inline std::vector<std::pair<std::string,std::string>> parseParams(const std::string& line) {
-    std::vector<std::pair<std::string,std::string>> params;
-    std::string current = line;
-    
-    size_t i = 0;
-    while(i < current.size()) {
-        // Saltar espacios
-        while(i < current.size() && current[i] == ' ') i++;
-        if(i >= current.size()) break;
-        
-        if(current[i] == '-') {
-            // Encontrar el parámetro
-            size_t start = i;
-            i++;
-            std::string key, val;
-            
-            // Leer hasta '=' o espacio
-            while(i < current.size() && current[i] != '=' && current[i] != ' ') {
-                key += current[i++];
-            }
-            
-            if(i < current.size() && current[i] == '=') {
-                i++; // saltar '='
-                // Leer valor (con soporte de comillas)
-                if(i < current.size() && current[i] == '"') {
-                    i++; // saltar comilla inicial
-                    while(i < current.size() && current[i] != '"') {
-                        val += current[i++];
-                    }
-                    if(i < current.size()) i++; // saltar comilla final
-                } else {
-                    while(i < current.size() && current[i] != ' ') {
-                        val += current[i++];
-                    }
-                }
-            }
-            params.push_back({toLower(key), val});
-        } else {
-            i++;
-        }
+// Ruta canónica de un disco: absoluta, sin ".", ".." ni "//" y con los
+// enlaces resueltos. Los candados, los discos abiertos y los cachés se
+// indexan por ella, así "/a/b.mia", "/a/./b.mia" y "/a//b.mia" son el
+// mismo disco. Si el archivo aún no existe (mkdisk) se resuelve su
+// carpeta y se agrega el nombre; si tampoco existe, se normaliza el texto.
+inline std::string canonicalPath(const std::string& path) {
+    if(path.empty()) return path;
+    char buf[PATH_MAX];
+    if(realpath(path.c_str(), buf)) return buf;
+
+    size_t      slash  = path.find_last_of('/');
+    std::string parent = (slash == std::string::npos) ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+    std::string name   = (slash == std::string::npos) ? path : path.substr(slash + 1);
+    if(!name.empty() && name != "." && name != ".." && realpath(parent.c_str(), buf)) {
+        std::string dir = buf;
+        return (dir == "/") ? "/" + name : dir + "/" + name;
+    }
+
+    std::string full = path;
+    if(full[0] != '/' && getcwd(buf, sizeof(buf))) full = std::string(buf) + "/" + full;
+    std::vector<std::string> parts;
+    std::stringstream ss(full);
+    std::string token;
+    while(std::getline(ss, token, '/')) {
+        if(token.empty() || token == ".") continue;
+        if(token == "..") { if(!parts.empty()) parts.pop_back(); continue; }
+        parts.push_back(token);
     }
-    return params;
+    std::string out;
+    for(const auto& part : parts) out += "/" + part;
+    return out.empty() ? "/" : out;
 }
 
 // Formatea tiempo a string legible
@@ -0,0 +1,40 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <string>
+#include <cstdio>
+#include "Bench.h"
+
+// =============================================
+// TEST
+// Comprobaciones de las pruebas de backend/tests. Usan las mismas
+// utilidades que los benchmarks (Bench.h); cada CHECK fallido se
+// informa con su línea y testResult() termina con código 1.
+// =============================================
+#define CHECK(cond, what) testCheck((cond), #cond, (what), __FILE__, __LINE__)
+
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline bool testCheck(bool ok, const char* expr, const std::string& what,
+                      const char* file, int line) {
+    if(!ok) {
+        std::fprintf(stderr, "%s:%d: falló %s (%s)\n", file, line, expr, what.c_str());
+        testFailures()++;
+    }
+    return ok;
+}
+
+// Código de salida de la prueba
+inline int testResult(const char* name) {
+    if(testFailures() == 0) {
+        std::printf("OK: %s\n", name);
+        return 0;
+    }
+    std::printf("Error: %s, %d comprobaciones fallidas\n", name, testFailures());
+    return 1;
+}
+
+#endif // TEST_H
@@ -0,0 +1,223 @@
+// Prueba de FileIO con bloques de 64 y 4096 bytes: escribe y vuelve a
+// leer archivos que cruzan los límites 12 / 12+P / 12+P+P² (los que
+// caben en i_s), los achica, los vacía y pide más de lo que cabe o hay libre.
+// Después de cada paso el superbloque debe contar lo que pidió el
+// BitmapAllocator, y al final fsck debe ver bitmaps y contadores
+// consistentes con el árbol de cada inodo. Aparte, varias escrituras
+// del mismo archivo dentro de una sola vista.
+//   fileio_test
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Test.h"
+
+// Contenido reconocible por archivo (cada byte depende de su posición)
+static std::string pattern(long long bytes, int seed) {
+    std::string data((size_t)bytes, '\0');
+    for(size_t i = 0; i < data.size(); i++) data[i] = (char)((i * 31 + seed * 7 + i / 4096) % 251);
+    return data;
+}
+
+// Bloques de apuntadores del árbol que cuelga de 'ptr'
+static long long pointerBlocks(PartitionView& fs, int ptr, int level) {
+    long long total = 1;
+    if(level == 1) return total;
+    const int32_t* words = fs.words(ptr);
+    std::vector<int> children(words, words + fs.blockWords());
+    for(int child : children)
+        if(child != -1) total += pointerBlocks(fs, child, level - 1);
+    return total;
+}
+
+// El árbol del inodo cubre los bloques lógicos 0..n-1 sin huecos, usa
+// solo los niveles indirectos que hacen falta y tiene los bloques de
+// apuntadores que calcula pointersNeeded
+static void checkTree(PartitionView& fs, int ino, long long bytes, const std::string& what) {
+    Inode     inode  = fs.inode(ino);
+    long long blocks = (bytes + fs.blockSize() - 1) / fs.blockSize();
+    long long next   = 0;
+    bool      inOrder = true;
+    InodeBlocks::forEach(fs, inode, [&](long long logical, int) {
+        if(logical != next) inOrder = false;
+        next++;
+        return true;
+    });
+    CHECK(inode.i_s == bytes, what + ": i_s");
+    CHECK(inOrder && next == blocks, what + ": bloques lógicos");
+
+    long long limit = DIRECT_BLOCKS, pointers = 0;
+    for(int level = 1; level <= 3; level++) {
+        int ptr = inode.i_block[DIRECT_BLOCKS + level - 1];
+        CHECK((ptr != -1) == (blocks > limit), what + ": nivel " + std::to_string(level));
+        if(ptr != -1) pointers += pointerBlocks(fs, ptr, level);
+        limit += InodeBlocks::span(fs, level);
+    }
+    CHECK(pointers == FileIO::pointersNeeded(fs, blocks), what + ": bloques de apuntadores");
+}
+
+// Reemplaza el contenido de 'ino' y comprueba árbol y contadores: el
+// superbloque (tras el commit de rangos sucios) debe bajar exactamente
+// en los bloques de datos y apuntadores del archivo nuevo
+static bool rewrite(const MountedPartition& mp, Disk& disk, int ino,
+                    const std::string& data, const std::string& what) {
+    auto lock = DiskLocks::exclusive(mp.path);
+    PartitionView fs(disk, mp.start, mp.size);
+    fs.load();
+    BitmapAllocator alloc(fs, mp.path, mp.start);
+
+    long long bs     = fs.blockSize();
+    long long before = fs.sb().s_free_blocks_count;
+    long long old    = (fs.inode(ino).i_s + bs - 1) / bs;
+    old += FileIO::pointersNeeded(fs, old);
+
+    std::string error;
+    bool ok = FileIO::write(fs, alloc, ino, data, error);
+    alloc.commit();
+    if(!ok) {
+        // Si excede el máximo no se toca nada; si falta espacio lo
+        // anterior ya se liberó y no debe quedar nada reservado
+        bool tooLarge = (long long)data.size() > FileIO::maxSize(fs);
+        CHECK(fs.sb().s_free_blocks_count == before + (tooLarge ? 0 : old), what + ": " + error);
+        CHECK(tooLarge || fs.inode(ino).i_s == 0, what + ": tamaño tras el error");
+        return false;
+    }
+
+    long long blocks = ((long long)data.size() + bs - 1) / bs;
+    long long used   = blocks + FileIO::pointersNeeded(fs, blocks);
+    CHECK(fs.sb().s_free_blocks_count == before + old - used, what + ": s_free_blocks_count");
+    CHECK(fs.sb().s_free_blocks_count == (long long)alloc.blocks().freeCount(), what + ": bitmap en RAM");
+    checkTree(fs, ino, (long long)data.size(), what);
+    return true;
+}
+
+static void readBack(const MountedPartition& mp, Disk& disk, int ino,
+                     const std::string& data, const std::string& what) {
+    auto lock = DiskLocks::shared(mp.path);
+    PartitionView fs(disk, mp.start, mp.size);
+    fs.load();
+    std::string out;
+    CHECK(FileIO::read(fs, fs.inode(ino), out), what + ": lectura");
+    CHECK(out == data, what + ": contenido");
+}
+
+static void expectConsistent(const std::string& id, const std::string& what) {
+    std::string out = runCommand("fsck -id=" + id);
+    CHECK(out.rfind("OK: Sistema de archivos consistente", 0) == 0, what + ": " + out);
+}
+
+static void testBlockSize(int bs, int partMb) {
+    std::string path = benchDir() + "/fileio_" + std::to_string(bs) + ".mia";
+    std::remove(path.c_str());
+    std::string id = makePartition(path, partMb + 1, partMb, "-bs=" + std::to_string(bs));
+    MountedPartition mp = mountedPartition(id);
+    std::shared_ptr<Disk> disk = DiskManager::get(mp.path);
+
+    // Tamaños: justo en cada límite y un byte después, más el máximo
+    std::vector<long long> sizes = {1, bs - 1LL};
+    long long maxSize, limit = DIRECT_BLOCKS;
+    {
+        auto lock = DiskLocks::shared(mp.path);
+        PartitionView fs(*disk, mp.start, mp.size);
+        fs.load();
+        maxSize = FileIO::maxSize(fs);
+        for(int level = 0; level <= 2; level++) {
+            if(level > 0) limit += InodeBlocks::span(fs, level);
+            if(limit * bs + 1 > maxSize) continue;
+            sizes.push_back(limit * bs);
+            sizes.push_back(limit * bs + 1);
+        }
+        if(InodeBlocks::maxBlocks(fs) * bs == maxSize) sizes.push_back(maxSize);
+    }
+
+    // Cada archivo queda enlazado en la raíz para que fsck lo recorra
+    std::vector<int>         inodes;
+    std::vector<std::string> contents;
+    for(size_t i = 0; i < sizes.size(); i++) {
+        std::string what = "bs=" + std::to_string(bs) + " " + std::to_string(sizes[i]) + " bytes";
+        int ino;
+        {
+            auto lock = DiskLocks::exclusive(mp.path);
+            PartitionView fs(*disk, mp.start, mp.size);
+            fs.load();
+            BitmapAllocator alloc(fs, mp.path, mp.start);
+            std::string error;
+            ino = newFileInode(fs, alloc);
+            CHECK(ino >= 0 && DirIndex::add(fs, alloc, 0, "f" + std::to_string(i), ino, error), what + ": " + error);
+        }
+        contents.push_back(pattern(sizes[i], (int)i));
+        inodes.push_back(ino);
+        CHECK(rewrite(mp, *disk, ino, contents.back(), what), what + ": escritura");
+        readBack(mp, *disk, ino, contents.back(), what);
+    }
+    disk->sync();
+    expectConsistent(id, "bs=" + std::to_string(bs) + " tras escribir");
+
+    // Achicar (los árboles indirectos se liberan), vaciar y un archivo
+    // que excede el máximo o el espacio libre
+    for(size_t i = 0; i < inodes.size(); i++) {
+        std::string what = "bs=" + std::to_string(bs) + " f" + std::to_string(i);
+        if(i % 2 == 0) contents[i] = pattern(std::min<long long>(sizes[i], DIRECT_BLOCKS * bs), (int)i + 1);
+        else           contents[i].clear();
+        CHECK(rewrite(mp, *disk, inodes[i], contents[i], what + " achicado"), what + ": achicar");
+        readBack(mp, *disk, inodes[i], contents[i], what + " achicado");
+    }
+    long long partBytes = (long long)partMb << 20;
+    if(maxSize < partBytes)
+        CHECK(!rewrite(mp, *disk, inodes.back(), pattern(maxSize + 1, 9), "excede el máximo"), "debía exceder el máximo");
+    else {
+        CHECK(!rewrite(mp, *disk, inodes.back(), pattern(partBytes, 9), "sin espacio"), "debía faltar espacio");
+        contents.back().clear();
+    }
+    disk->sync();
+    expectConsistent(id, "bs=" + std::to_string(bs) + " tras achicar");
+
+    for(size_t i = 0; i < inodes.size(); i++)
+        readBack(mp, *disk, inodes[i], contents[i], "bs=" + std::to_string(bs) + " f" + std::to_string(i) + " final");
+    runCommand("unmount -id=" + id);
+    DiskManager::drop(mp.path, false);
+}
+
+// Varias escrituras del mismo archivo en una sola vista (backend
+// stream): los bloques de apuntadores que libera una escritura quedan
+// con copia en la vista y la siguiente los puede volver a pedir como
+// datos; ni la lectura en la vista ni el commit deben ver apuntadores
+static void testSameView() {
+    std::string path = benchDir() + "/fileio_vista.mia";
+    std::remove(path.c_str());
+    std::string id = makePartition(path, 2, 1, "-bs=64");
+    MountedPartition mp = mountedPartition(id);
+    std::shared_ptr<Disk> disk = DiskManager::get(mp.path);
+
+    std::string last;
+    int ino;
+    {
+        auto lock = DiskLocks::exclusive(mp.path);
+        PartitionView fs(*disk, mp.start, mp.size);
+        fs.load();
+        BitmapAllocator alloc(fs, mp.path, mp.start);
+        std::string error, out;
+        ino = newFileInode(fs, alloc);
+        CHECK(ino >= 0 && DirIndex::add(fs, alloc, 0, "f", ino, error), "misma vista: " + error);
+        for(int blocks : {20, 21, 30, 13, 29}) {
+            std::string what = "misma vista, " + std::to_string(blocks) + " bloques";
+            last = pattern(blocks * 64LL, blocks);
+            CHECK(FileIO::write(fs, alloc, ino, last, error), what + ": " + error);
+            CHECK(FileIO::read(fs, fs.inode(ino), out) && out == last, what + ": contenido en la vista");
+            checkTree(fs, ino, (long long)last.size(), what);
+        }
+    }
+    readBack(mp, *disk, ino, last, "misma vista, tras el commit");
+    disk->sync();
+    expectConsistent(id, "misma vista");
+    runCommand("unmount -id=" + id);
+    DiskManager::drop(mp.path, false);
+}
+
+int main() {
+    testSameView();
+    // 64: P = 16, llega hasta el triple indirecto y al máximo (4380 bloques)
+    testBlockSize(64, 4);
+    // 4096: P = 1024, el triple indirecto no cabe en i_s (32 bits)
+    testBlockSize(4096, 16);
+    return testResult("fileio");
+}
@@ -0,0 +1,199 @@
+// Corpus de imágenes dañadas para fsck. Cada caso arma el mismo árbol
+// chico (bloques de 64 bytes), le aplica un daño, guarda una copia de
+// la imagen dañada (<caso>.roto.mia en BENCH_DIR/fsck) y compara la
+// salida de fsck, fsck -repair y un fsck final con tests/fsck/<caso>.txt
+// (sin la línea de hilos y tiempos, y con el ID como "ID").
+//   fsck_test [caso...]          -> compara
+//   fsck_test -update [caso...]  -> reescribe los .txt esperados
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <functional>
+#include "Test.h"
+
+#define FSCK_EXPECTED_DIR "fsck"
+
+// Inodos y bloques del árbol de cada caso:
+//   /users.txt  /docs/  /docs/a.txt (20 bloques: usa el indirecto)  /b.txt (3 bloques)
+struct Tree {
+    int docs, docsBlock, a, b;
+};
+
+struct Case {
+    const char* name;
+    std::function<void(PartitionView&, const Tree&)> damage;
+};
+
+// -----------------------------------------------
+// Árbol
+// -----------------------------------------------
+static int makeFolder(PartitionView& fs, BitmapAllocator& alloc, int parent,
+                      const std::string& name, int& block) {
+    int ino = alloc.allocInode();
+    block = alloc.allocBlock();
+    Inode inode;
+    inode.i_uid      = 1;
+    inode.i_gid      = 1;
+    inode.i_block[0] = block;
+    fs.inodeMut(ino) = inode;
+    fs.clearFolder(block);
+    Content* c = fs.folderMut(block);
+    std::strncpy(c[0].b_name, ".", 11);
+    c[0].b_inodo = ino;
+    std::strncpy(c[1].b_name, "..", 11);
+    c[1].b_inodo = parent;
+    std::string error;
+    DirIndex::add(fs, alloc, parent, name, ino, error);
+    return ino;
+}
+
+static int makeFile(PartitionView& fs, BitmapAllocator& alloc, int parent,
+                    const std::string& name, size_t bytes) {
+    int ino = newFileInode(fs, alloc);
+    std::string error;
+    FileIO::write(fs, alloc, ino, std::string(bytes, (char)('a' + ino)), error);
+    DirIndex::add(fs, alloc, parent, name, ino, error);
+    return ino;
+}
+
+// -----------------------------------------------
+// Daños
+// -----------------------------------------------
+static const Case CASES[] = {
+    // b.txt apunta al primer bloque de a.txt (su bloque propio queda sin dueño)
+    {"bloque_duplicado", [](PartitionView& fs, const Tree& t) {
+        fs.inodeMut(t.b).i_block[0] = fs.inode(t.a).i_block[0];
+    }},
+    // Un directo de b.txt y una casilla del indirecto de a.txt fuera de la partición
+    {"fuera_de_rango", [](PartitionView& fs, const Tree& t) {
+        fs.inodeMut(t.b).i_block[1] = fs.sb().s_blocks_count + 100;
+        fs.wordsMut(fs.inode(t.a).i_block[DIRECT_BLOCKS])[3] = -7;
+    }},
+    // "." de /docs apunta a la raíz y ".." a sí misma
+    {"punto_y_punto_punto", [](PartitionView& fs, const Tree& t) {
+        Content* c = fs.folderMut(t.docsBlock);
+        c[0].b_inodo = 0;
+        c[1].b_inodo = t.docs;
+    }},
+    // Un inodo y un bloque libres marcados como usados
+    {"bitmap_sobrante", [](PartitionView& fs, const Tree&) {
+        fs.inodeBitmapMut()[40] = '1';
+        fs.blockBitmapMut()[300] = '1';
+    }},
+    // b.txt y el último bloque de a.txt en uso pero libres en el bitmap
+    {"bitmap_faltante", [](PartitionView& fs, const Tree& t) {
+        fs.inodeBitmapMut()[t.b] = '0';
+        fs.blockBitmapMut()[fs.words(fs.inode(t.a).i_block[DIRECT_BLOCKS])[7]] = '0';
+    }},
+    // Contadores y primer libre del superbloque
+    {"superbloque", [](PartitionView& fs, const Tree&) {
+        SuperBloque& sb = fs.sbMut();
+        sb.s_free_blocks_count -= 7;
+        sb.s_free_inodes_count += 2;
+        sb.s_firts_ino = sb.s_inode_start;
+    }},
+    // b.txt con tipo inválido y a.txt con tamaño negativo
+    {"inodo_invalido", [](PartitionView& fs, const Tree& t) {
+        fs.inodeMut(t.b).i_type = 'x';
+        fs.inodeMut(t.a).i_s    = -3;
+    }},
+};
+
+// -----------------------------------------------
+// Ejecución
+// -----------------------------------------------
+static void copyFile(const std::string& from, const std::string& to) {
+    std::ifstream in(from, std::ios::binary);
+    std::ofstream out(to, std::ios::binary | std::ios::trunc);
+    out << in.rdbuf();
+}
+
+// Salida de fsck sin lo que cambia entre corridas
+static std::string normalize(const std::string& out, const std::string& id) {
+    std::istringstream lines(out);
+    std::string line, result;
+    while(std::getline(lines, line)) {
+        if(line.rfind("  Hilos:", 0) == 0) continue;
+        for(size_t pos; (pos = line.find(id)) != std::string::npos; ) line.replace(pos, id.size(), "ID");
+        result += line + "\n";
+    }
+    return result;
+}
+
+static std::string runCase(const Case& c, const std::string& dir) {
+    std::string path = dir + "/" + c.name + ".mia";
+    std::remove(path.c_str());
+    std::string id = makePartition(path, 2, 1, "-bs=64");
+    MountedPartition mp = mountedPartition(id);
+    std::shared_ptr<Disk> disk = DiskManager::get(mp.path);
+
+    Tree tree;
+    {
+        auto lock = DiskLocks::exclusive(mp.path);
+        PartitionView fs(*disk, mp.start, mp.size);
+        fs.load();
+        BitmapAllocator alloc(fs, mp.path, mp.start);
+        tree.docs = makeFolder(fs, alloc, 0, "docs", tree.docsBlock);
+        tree.a    = makeFile(fs, alloc, tree.docs, "a.txt", 20 * 64);
+        tree.b    = makeFile(fs, alloc, 0, "b.txt", 3 * 64);
+    }
+    // El daño va en otra vista: los bitmaps completos se leen ya con
+    // lo que escribió el commit del asignador
+    {
+        auto lock = DiskLocks::exclusive(mp.path);
+        PartitionView fs(*disk, mp.start, mp.size);
+        fs.load();
+        c.damage(fs, tree);
+    }
+    // fsck lee los bitmaps del disco; lo que había en RAM ya no vale
+    BitmapCache::invalidate(mp.path);
+    DentryCache::invalidate(mp.path);
+    disk->sync();
+    copyFile(path, dir + "/" + c.name + ".roto.mia");
+
+    std::string out;
+    out += "$ fsck\n"         + normalize(runCommand("fsck -id=" + id), id);
+    out += "$ fsck -repair\n" + normalize(runCommand("fsck -id=" + id + " -repair"), id);
+    out += "$ fsck\n"         + normalize(runCommand("fsck -id=" + id), id);
+
+    runCommand("unmount -id=" + id);
+    DiskManager::drop(mp.path, false);
+    return out;
+}
+
+int main(int argc, char** argv) {
+    bool update = false;
+    std::vector<std::string> only;
+    for(int i = 1; i < argc; i++) {
+        if(std::strcmp(argv[i], "-update") == 0) update = true;
+        else only.push_back(argv[i]);
+    }
+
+    std::string dir = benchDir() + "/fsck";
+    mkdirRecursive(dir);
+    for(const Case& c : CASES) {
+        if(!only.empty() && std::find(only.begin(), only.end(), c.name) == only.end()) continue;
+        std::string out = runCase(c, dir);
+        std::string file = std::string(FSCK_EXPECTED_DIR) + "/" + c.name + ".txt";
+
+        if(update) {
+            std::ofstream(file, std::ios::trunc) << out;
+            std::printf("actualizado %s\n", file.c_str());
+            continue;
+        }
+        std::ifstream in(file);
+        std::stringstream expected;
+        expected << in.rdbuf();
+        if(!CHECK(in && expected.str() == out, std::string(c.name) + ", ver " + file))
+            std::fprintf(stderr, "--- esperado\n%s--- obtenido\n%s", expected.str().c_str(), out.c_str());
+
+        // Después de reparar todo debe quedar consistente
+        CHECK(out.find("$ fsck\nOK: Sistema de archivos consistente", out.rfind("$ fsck -repair")) != std::string::npos,
+              std::string(c.name) + ": fsck después de -repair");
+    }
+    return testResult("fsck");
+}
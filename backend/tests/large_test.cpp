@@ -0,0 +1,301 @@
+// Imágenes grandes y conversión de formatos anteriores.
+//  1. Disco de 6 GB con -mode=sparse: primarias, extendida y lógicas
+//     que empiezan pasados los 2 y los 4 GB, mkfs, un archivo escrito y
+//     leído de vuelta, fsck y reportes (mbr, sb, bm_block, file) que
+//     deben mostrar las posiciones de 64 bits. El archivo debe seguir
+//     siendo disperso.
+//  2. Un disco v1 y uno v2 (una primaria y una lógica, cada una con su
+//     EXT2 de bloques de 64) escritos acá con los structs de Convert.h:
+//     convert los pasa al formato actual y después se montan, fsck los
+//     ve consistentes, login lee users.txt y el contenido de los
+//     archivos no cambia.
+//   large_test
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include "Test.h"
+
+#define GB (1024LL * 1024 * 1024)
+
+static std::string readText(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+static std::string pattern(size_t bytes, int seed) {
+    std::string data(bytes, '\0');
+    for(size_t i = 0; i < bytes; i++) data[i] = (char)('a' + (i * 7 + seed) % 26);
+    return data;
+}
+
+// Lee 'name' de la raíz de la partición montada
+static bool readRootFile(const MountedPartition& mp, const std::string& name, std::string& out) {
+    auto lock = DiskLocks::shared(mp.path);
+    std::shared_ptr<Disk> disk = DiskManager::get(mp.path);
+    PartitionView fs(*disk, mp.start, mp.size);
+    if(!fs.load()) return false;
+    int ino = DirIndex::find(fs, 0, name);
+    return ino >= 0 && FileIO::read(fs, fs.inode(ino), out);
+}
+
+static void expectOk(const std::string& line, const std::string& what) {
+    std::string out = runCommand(line);
+    CHECK(out.rfind("OK", 0) == 0, what + ": " + out);
+}
+
+static void expectConsistent(const std::string& id, const std::string& what) {
+    std::string out = runCommand("fsck -id=" + id);
+    CHECK(out.rfind("OK: Sistema de archivos consistente", 0) == 0, what + ": " + out);
+}
+
+// -----------------------------------------------
+// 1. Disco de 6 GB
+// -----------------------------------------------
+static void testLargeDisk(const std::string& dir) {
+    std::string path = dir + "/grande.mia";
+    std::remove(path.c_str());
+    run("mkdisk -size=6144 -unit=M -mode=sparse -path=" + path);
+    run("fdisk -size=1024 -unit=M -name=P1 -path=" + path);
+    run("fdisk -size=4096 -unit=M -type=E -name=E1 -path=" + path);
+    run("fdisk -size=1024 -unit=M -type=L -name=L1 -path=" + path);
+    run("fdisk -size=2048 -unit=M -type=L -name=L2 -path=" + path);
+    run("fdisk -size=1000 -unit=M -name=P2 -path=" + path);
+
+    // L2 empieza pasados los 2 GB y P2 pasados los 4 GB
+    std::string l2 = mountedId(run("mount -name=L2 -path=" + path));
+    std::string p2 = mountedId(run("mount -name=P2 -path=" + path));
+    MountedPartition mpL2 = mountedPartition(l2);
+    MountedPartition mpP2 = mountedPartition(p2);
+    CHECK(mpL2.start > 2 * GB, "inicio de L2: " + std::to_string(mpL2.start));
+    CHECK(mpP2.start > 4 * GB, "inicio de P2: " + std::to_string(mpP2.start));
+    CHECK(mpL2.size == 2 * GB, "tamaño de L2: " + std::to_string(mpL2.size));
+    run("mkfs -type=fast -bs=4096 -id=" + l2);
+    run("mkfs -type=fast -bs=4096 -id=" + p2);
+
+    // Un archivo de 8 MB en P2: sus bloques quedan pasados los 5 GB
+    std::string data = pattern(8 << 20, 3);
+    {
+        auto lock = DiskLocks::exclusive(mpP2.path);
+        std::shared_ptr<Disk> disk = DiskManager::get(mpP2.path);
+        PartitionView fs(*disk, mpP2.start, mpP2.size);
+        fs.load();
+        BitmapAllocator alloc(fs, mpP2.path, mpP2.start);
+        std::string error;
+        int ino = newFileInode(fs, alloc);
+        CHECK(ino >= 0 && FileIO::write(fs, alloc, ino, data, error) &&
+              DirIndex::add(fs, alloc, 0, "grande.bin", ino, error), "grande.bin: " + error);
+    }
+    run("sync -path=" + path);
+    std::string back;
+    CHECK(readRootFile(mpP2, "grande.bin", back) && back == data, "grande.bin leído de vuelta");
+    expectConsistent(l2, "fsck de L2");
+    expectConsistent(p2, "fsck de P2");
+
+    // Reportes con posiciones de 64 bits
+    std::string rep = dir + "/rep";
+    expectOk("rep -name=mbr -id=" + p2 + " -path=" + rep + "/mbr.dot", "rep mbr");
+    CHECK(readText(rep + "/mbr.dot").find(std::to_string(mpP2.start)) != std::string::npos,
+          "el reporte mbr tiene el inicio de P2");
+    expectOk("rep -name=sb -id=" + p2 + " -path=" + rep + "/sb.dot", "rep sb");
+    CHECK(readText(rep + "/sb.dot").find(std::to_string(mpP2.start + (long long)sizeof(SuperBloque))) != std::string::npos,
+          "el reporte sb tiene s_bm_inode_start de P2");
+    expectOk("rep -name=bm_block -id=" + l2 + " -path=" + rep + "/bm_block.txt", "rep bm_block");
+    expectOk("rep -name=file -id=" + p2 + " -path=" + rep + "/users.txt -path_file_ls=/users.txt", "rep file");
+    CHECK(readText(rep + "/users.txt").find("1,U,root,root,123") != std::string::npos, "rep file de users.txt");
+
+    CHECK(allocatedBytes(path) < 256LL << 20, "el disco sigue disperso: " + std::to_string(allocatedBytes(path)));
+    runCommand("unmount -id=" + l2);
+    runCommand("unmount -id=" + p2);
+    DiskManager::drop(mpP2.path, false);
+    std::remove(path.c_str());
+}
+
+// -----------------------------------------------
+// 2. Discos v1 y v2
+// -----------------------------------------------
+template<typename T>
+static void writeStruct(int fd, long long pos, const T& value) {
+    char buf[sizeof(T)];
+    diskEncode(value, buf);
+    CHECK(pwrite(fd, buf, sizeof(T), pos) == (ssize_t)sizeof(T), "escritura del disco anterior");
+}
+
+// EXT2 del formato anterior (bloques de 64) en [start, start + size):
+// raíz con users.txt y hola.txt (20 bloques, usa el indirecto simple)
+template<typename F>
+static void writeLegacyFs(int fd, long long start, long long size, const std::string& hola) {
+    using SB    = typename F::SB;
+    using Inode = typename F::Inode;
+    const int bs = 64;
+    int n = (int)((size - (long long)sizeof(SB)) / (4 + (long long)sizeof(Inode) + 3 * bs));
+
+    SB sb{};
+    sb.s_filesystem_type = 2;
+    sb.s_inodes_count    = n;
+    sb.s_blocks_count    = 3 * n;
+    sb.s_mtime           = time(nullptr);
+    sb.s_umtime          = 0;
+    sb.s_mnt_count       = 1;
+    sb.s_magic           = 0xEF53;
+    sb.s_inode_s         = sizeof(Inode);
+    sb.s_block_s         = bs;
+    sb.s_bm_inode_start  = (int)(start + (long long)sizeof(SB));
+    sb.s_bm_block_start  = sb.s_bm_inode_start + n;
+    sb.s_inode_start     = sb.s_bm_block_start + 3 * n;
+    sb.s_block_start     = sb.s_inode_start + n * (int)sizeof(Inode);
+    if constexpr(F::version == 2) sb.s_version = 2;
+
+    auto blockPos = [&](int b) { return sb.s_block_start + (long long)b * bs; };
+    auto newInode = [&](char type, int bytes) {
+        Inode in{};
+        in.i_uid = 1;
+        in.i_gid = 1;
+        in.i_s   = bytes;
+        in.i_atime = in.i_ctime = in.i_mtime = time(nullptr);
+        for(int i = 0; i < 15; i++) in.i_block[i] = -1;
+        in.i_type = type;
+        std::memcpy(in.i_perm, "664", 3);
+        return in;
+    };
+
+    // Raíz (bloque 0) y users.txt (bloque 1)
+    Content root[4];
+    const char* names[4] = {".", "..", "users.txt", "hola.txt"};
+    int         inodes[4] = {0, 0, 1, 2};
+    for(int k = 0; k < 4; k++) {
+        std::strncpy(root[k].b_name, names[k], 11);
+        root[k].b_inodo = inodes[k];
+        writeStruct(fd, blockPos(0) + k * (long long)sizeof(Content), root[k]);
+    }
+    Inode rootInode = newInode('0', 0);
+    rootInode.i_block[0] = 0;
+    writeStruct(fd, sb.s_inode_start, rootInode);
+
+    std::string users = "1,G,root\n1,U,root,root,123\n";
+    pwrite(fd, users.data(), users.size(), blockPos(1));
+    Inode usersInode = newInode('1', (int)users.size());
+    usersInode.i_block[0] = 1;
+    writeStruct(fd, sb.s_inode_start + sb.s_inode_s, usersInode);
+
+    // hola.txt: 12 directos (2..13), el indirecto en 14 y el resto en 15..
+    int blocks = (int)((hola.size() + bs - 1) / bs);
+    Inode holaInode = newInode('1', (int)hola.size());
+    std::vector<int32_t> pointers(bs / 4, -1);
+    for(int i = 0; i < blocks; i++) {
+        int b = (i < 12) ? 2 + i : 15 + (i - 12);
+        if(i < 12) holaInode.i_block[i] = b;
+        else       pointers[i - 12] = b;
+        pwrite(fd, hola.data() + (size_t)i * bs, std::min<size_t>(bs, hola.size() - (size_t)i * bs), blockPos(b));
+    }
+    holaInode.i_block[12] = 14;
+    for(size_t i = 0; i < pointers.size(); i++) writeStruct(fd, blockPos(14) + (long long)i * 4, pointers[i]);
+    writeStruct(fd, sb.s_inode_start + 2LL * sb.s_inode_s, holaInode);
+
+    // Bitmaps y contadores
+    int usedBlocks = 15 + (blocks - 12);
+    std::string bmInodes(n, '0'), bmBlocks(3 * n, '0');
+    bmInodes.replace(0, 3, "111");
+    bmBlocks.replace(0, usedBlocks, std::string(usedBlocks, '1'));
+    pwrite(fd, bmInodes.data(), bmInodes.size(), sb.s_bm_inode_start);
+    pwrite(fd, bmBlocks.data(), bmBlocks.size(), sb.s_bm_block_start);
+    sb.s_free_inodes_count = n - 3;
+    sb.s_free_blocks_count = 3 * n - usedBlocks;
+    sb.s_firts_ino         = sb.s_inode_start + 3 * sb.s_inode_s;
+    sb.s_first_blo         = (int)blockPos(usedBlocks);
+    writeStruct(fd, start, sb);
+}
+
+// Disco de 4 MB: P1 (1 MB) y una extendida con la lógica L1 (1 MB)
+template<typename F>
+static void writeLegacyDisk(const std::string& path, const std::string& hola) {
+    using MBR = typename F::MBR;
+    using EBR = typename F::EBR;
+    const long long size = 4 << 20, part = 1 << 20;
+
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    CHECK(fd >= 0 && ftruncate(fd, size) == 0, "crear " + path);
+
+    MBR mbr{};
+    if constexpr(F::version == 2) {
+        std::memcpy(mbr.mbr_magic, MBR_MAGIC, 3);
+        mbr.mbr_version = 2;
+    }
+    mbr.mbr_tamano         = (int32_t)size;
+    mbr.mbr_fecha_creacion = time(nullptr);
+    mbr.mbr_dsk_signature  = 1234;
+    mbr.dsk_fit            = 'F';
+    for(auto& p : mbr.mbr_partitions) {
+        p.part_status = '0';
+        p.part_start  = -1;
+        p.part_s      = 0;
+        p.part_correlative = -1;
+    }
+    auto setPart = [&](int i, char type, long long start, long long s, const char* name) {
+        auto& p = mbr.mbr_partitions[i];
+        p.part_type  = type;
+        p.part_fit   = 'W';
+        p.part_start = (int32_t)start;
+        p.part_s     = (int32_t)s;
+        std::strncpy(p.part_name, name, 15);
+    };
+    long long p1 = sizeof(MBR), ext = p1 + part;
+    setPart(0, 'P', p1, part, "P1");
+    setPart(1, 'E', ext, 2 * part, "E1");
+    writeStruct(fd, 0, mbr);
+
+    EBR ebr{};
+    ebr.part_mount = '0';
+    ebr.part_fit   = 'W';
+    ebr.part_start = (int32_t)(ext + (long long)sizeof(EBR));
+    ebr.part_s     = (int32_t)part;
+    ebr.part_next  = -1;
+    std::strncpy(ebr.part_name, "L1", 15);
+    writeStruct(fd, ext, ebr);
+
+    writeLegacyFs<F>(fd, p1, part, hola);
+    writeLegacyFs<F>(fd, ebr.part_start, part, hola);
+    close(fd);
+}
+
+template<typename F>
+static void testConvert(const std::string& dir) {
+    std::string v    = "v" + std::to_string(F::version);
+    std::string path = dir + "/formato_" + v + ".mia";
+    std::string hola = pattern(20 * 64 - 5, F::version);
+    writeLegacyDisk<F>(path, hola);
+
+    std::string out = runCommand("convert -path=" + path);
+    CHECK(out.rfind("OK: Disco convertido del formato " + v + " al v" + std::to_string(DISK_FORMAT_VERSION), 0) == 0,
+          "convert " + v + ": " + out);
+    CHECK(out.find("Lógicas: 1 | Sistemas EXT2: 2") != std::string::npos, "convert " + v + ": " + out);
+
+    for(const char* name : {"P1", "L1"}) {
+        std::string what = v + " " + name;
+        std::string id   = mountedId(runCommand("mount -name=" + std::string(name) + " -path=" + path));
+        CHECK(!id.empty(), what + ": mount");
+        if(id.empty()) continue;
+        expectConsistent(id, what);
+        expectOk("login -user=root -pass=123 -id=" + id, what + ": login");
+        expectOk("logout", what + ": logout");
+        std::string back;
+        CHECK(readRootFile(mountedPartition(id), "hola.txt", back) && back == hola, what + ": hola.txt");
+        runCommand("unmount -id=" + id);
+    }
+    DiskManager::drop(canonicalPath(path), false);
+}
+
+int main() {
+    std::string dir = benchDir() + "/large";
+    mkdirRecursive(dir);
+    testLargeDisk(dir);
+    testConvert<FormatV1>(dir);
+    testConvert<FormatV2>(dir);
+    return testResult("large");
+}
@@ -0,0 +1,18 @@
+#!/bin/sh
+# Compila y corre las pruebas de backend/tests.
+#   ./run.sh              -> todas
+#   ./run.sh fileio fsck  -> solo esas (nombre sin "_test.cpp")
+# Las imágenes van en BENCH_DIR (por defecto /tmp/extreamfs-bench).
+set -e
+cd "$(dirname "$0")"
+BIN="${BENCH_DIR:-/tmp/extreamfs-bench}/bin"
+mkdir -p "$BIN"
+NAMES="$*"
+[ -z "$NAMES" ] && NAMES=$(ls *_test.cpp | sed 's/_test\.cpp$//')
+FAILED=0
+for name in $NAMES; do
+    echo "== $name"
+    g++ -std=c++17 -O2 -Wall -Wextra -pthread -I../src -I../bench -o "$BIN/${name}_test" "${name}_test.cpp"
+    "$BIN/${name}_test" || FAILED=1
+done
+exit $FAILED
@@ -1,5 +1,4 @@
 import { useState, useRef } from "react"
-import axios from "axios"
 import "./App.css"
 
 const API = "http://localhost:3001"
@@ -8,15 +7,54 @@ export default function App() {
   const [input,   setInput]   = useState("")
   const [output,  setOutput]  = useState("# Los resultados aparecerán aquí...\n")
   const [loading, setLoading] = useState(false)
+  // Token de sesión que retorna login; se envía en cada ejecución
+  const session = useRef(localStorage.getItem("session") || "")
   const fileRef = useRef(null)
 
-  // Ejecutar comandos
+  // Ejecutar comandos: la salida de cada comando llega por
+  // /execute/stream (eventos SSE) en cuanto termina de ejecutarse
   const handleExecute = async () => {
     if(!input.trim()) return
     setLoading(true)
     try {
-      const res = await axios.post(`${API}/execute`, { commands: input })
-      setOutput(prev => prev + res.data.output)
+      const res = await fetch(`${API}/execute/stream`, {
+        method:  "POST",
+        headers: {
+          "Content-Type":    "application/json",
+          "X-Session-Token": session.current
+        },
+        body:    JSON.stringify({ commands: input })
+      })
+      if(!res.ok || !res.body) {
+        const data = await res.json().catch(() => ({}))
+        setOutput(prev => prev + (data.error || "Error del servidor") + "\n")
+      } else {
+        const reader  = res.body.getReader()
+        const decoder = new TextDecoder()
+        let   pending = ""
+        while(true) {
+          const { value, done } = await reader.read()
+          if(done) break
+          pending += decoder.decode(value, { stream: true })
+
+          // Cada evento termina con una línea en blanco
+          const events = pending.split("\n\n")
+          pending = events.pop()
+          let text = ""
+          for(const ev of events) {
+            const line = ev.split("\n").find(l => l.startsWith("data: "))
+            if(!line) continue
+            const data = JSON.parse(line.slice(6))
+            if(ev.startsWith("event: end")) {
+              session.current = data.session
+              localStorage.setItem("session", data.session)
+              continue
+            }
+            text += data.output + "\n"
+          }
+          if(text) setOutput(prev => prev + text)
+        }
+      }
     } catch(e) {
       setOutput(prev => prev + "Error de conexión con el servidor\n")
     }